@@ -0,0 +1,196 @@
+#include "cache_counters.hpp"
+#include "generator.hpp"
+
+#include "sim/block_order.hpp"
+#include "sim/grid.hpp"
+
+#include <benchmark/benchmark.h>
+#include <cstdio>
+#include <filesystem>
+#include <iostream>
+#include <map>
+#include <sstream>
+#include <string>
+#include <utility>
+
+// Microbenchmarks de cada etapa de fluidapp sobre conjuntos sinteticos (generator.hpp). Cada
+// benchmark recibe {particulas, porcentaje del recinto ocupado}; con --benchmark_out=F.json
+// --benchmark_out_format=json los resultados se guardan en JSON.
+
+using namespace fluids;
+
+namespace {
+  // El mismo conjunto para todos los benchmarks que usan los mismos argumentos
+  sim::File<double> const & syntheticFile(benchmark::State const & state) {
+    static std::map<std::pair<int64_t, int64_t>, sim::File<double>> files;
+    std::pair<int64_t, int64_t> const key(state.range(0), state.range(1));
+    auto found = files.find(key);
+    if (found == files.end()) {
+      bench::GeneratorOptions options;
+      options.particles = static_cast<size_t>(key.first);
+      // NOLINTNEXTLINE(cppcoreguidelines-avoid-magic-numbers,readability-magic-numbers)
+      double const fill           = static_cast<double>(key.second) / 100;
+      options.particles_per_meter = bench::particlesPerMeterForFill(options.particles, fill);
+      found                       = files.emplace(key, bench::generateFile(options)).first;
+    }
+    return found->second;
+  }
+
+  // Grid escribe sus parametros en std::cout al construirse, lo que mezclaria su salida con
+  // la tabla de resultados
+  sim::Grid<double> quietGrid(sim::File<double> & file, sim::SimulationOptions const & options) {
+    std::ostringstream discarded;
+    std::streambuf * const previous = std::cout.rdbuf(discarded.rdbuf());
+    sim::Grid<double> grid(file, options);
+    std::cout.rdbuf(previous);
+    return grid;
+  }
+
+  std::string temporaryFile(std::string const & name) {
+    return (std::filesystem::temp_directory_path() / name).string();
+  }
+
+  void setParticles(benchmark::State & state) {
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+    state.counters["particles"] = static_cast<double>(state.range(0));
+  }
+
+  void BM_ReadFile(benchmark::State & state) {
+    std::string filename = temporaryFile("fluidbench_read.fld");
+    std::vector<char> const image = bench::fldImage(syntheticFile(state));
+    if (!sim::writeBytes(filename, image, sim::WriteMode::buffered)) {
+      state.SkipWithError("cannot write the input file");
+      return;
+    }
+    for (auto _ : state) { benchmark::DoNotOptimize(sim::readFile<double>(filename)); }
+    std::remove(filename.c_str());
+    state.SetBytesProcessed(state.iterations() * static_cast<int64_t>(image.size()));
+    setParticles(state);
+  }
+
+  void BM_GridConstruction(benchmark::State & state) {
+    sim::File<double> file = syntheticFile(state);
+    for (auto _ : state) { benchmark::DoNotOptimize(quietGrid(file, {}).blocks.data()); }
+    setParticles(state);
+  }
+
+  // Un paso completo por iteracion, continuando la simulacion del paso anterior. El tercer
+  // argumento elige el paso con reinicios fusionados (1) o en pasadas propias (0).
+  void BM_MakeSimulation(benchmark::State & state) {
+    sim::File<double> file = syntheticFile(state);
+    sim::Grid<double> grid = quietGrid(file, {.fused = state.range(2) != 0});
+    for (auto _ : state) { grid.makeSimulation(); }
+    state.SetLabel(grid.fused ? "fused" : "unfused");
+    setParticles(state);
+  }
+
+  // Las dos pasadas de pares sobre todos los bloques, recorridos en el orden del tercer
+  // argumento (sim::BlockOrder), con los fallos de L2 y del ultimo nivel de cache por
+  // iteracion cuando el sistema deja leer los contadores. Como en BM_PairKernel, las
+  // particulas no se mueven, asi que todas las iteraciones hacen el mismo trabajo.
+  void BM_BlockOrder(benchmark::State & state) {
+    sim::File<double> file = syntheticFile(state);
+    auto const order       = static_cast<sim::BlockOrder>(state.range(2));
+    sim::Grid<double> grid = quietGrid(file, {.block_order = order});
+    grid.resetParticles();
+    grid.sortParticles();
+    bench::CacheCounters counters;
+    counters.start();
+    for (auto _ : state) {
+      for (size_t const block_i : grid.active_blocks) { grid.evalDensities(block_i); }
+      for (size_t const block_i : grid.active_blocks) { grid.evalAccelerations(block_i); }
+      benchmark::ClobberMemory();
+    }
+    counters.stop();
+    if (counters.available()) {
+      state.counters["L2_misses"] = benchmark::Counter(static_cast<double>(counters.l2Misses()),
+                                                       benchmark::Counter::kAvgIterations);
+      state.counters["LLC_misses"] = benchmark::Counter(
+          static_cast<double>(counters.llcMisses()), benchmark::Counter::kAvgIterations);
+      state.SetLabel(sim::blockOrderName(order));
+    } else {
+      state.SetLabel(sim::blockOrderName(order) + " (sin contadores de cache)");
+    }
+    setParticles(state);
+  }
+
+  // Las funciones de pares solas, sin ordenar ni mover particulas. Las densidades y
+  // aceleraciones se acumulan entre iteraciones, lo que no cambia el trabajo de cada una.
+  template <bool accelerations>
+  void BM_PairKernel(benchmark::State & state) {
+    sim::File<double> file = syntheticFile(state);
+    auto const kernel      = static_cast<sim::KernelType>(state.range(2));
+    sim::Grid<double> grid = quietGrid(file, {.kernel = kernel});
+    grid.resetParticles();
+    grid.sortParticles();
+    if constexpr (accelerations) {
+      for (size_t const block_i : grid.active_blocks) {
+        grid.evalDensities(block_i);
+        grid.transformDensities(grid.blocks[block_i]);
+      }
+    }
+    for (auto _ : state) {
+      for (size_t const block_i : grid.active_blocks) {
+        if constexpr (accelerations) {
+          grid.evalAccelerations(block_i);
+        } else {
+          grid.evalDensities(block_i);
+        }
+      }
+      benchmark::ClobberMemory();
+    }
+    state.SetLabel(sim::kernelName(grid.kernel));
+    setParticles(state);
+  }
+
+  void BM_WriteSimulation(benchmark::State & state) {
+    sim::File<double> file = syntheticFile(state);
+    sim::Grid<double> grid = quietGrid(file, {});
+    std::string filename   = temporaryFile("fluidbench_write.fld");
+    for (auto _ : state) { grid.writeSimulation(filename); }
+    std::remove(filename.c_str());
+    state.SetBytesProcessed(state.iterations() * static_cast<int64_t>(grid.output_buffer.size()));
+    setParticles(state);
+  }
+
+  // Tamaños de 4k a 256k particulas ocupando el 10 % o el 40 % del recinto
+  void sizes(benchmark::internal::Benchmark * benchmark) {
+    // NOLINTNEXTLINE(cppcoreguidelines-avoid-magic-numbers,readability-magic-numbers)
+    benchmark->ArgsProduct({{4096, 32768, 262144}, {10, 40}})->Unit(benchmark::kMillisecond);
+  }
+
+  void pipelines(benchmark::internal::Benchmark * benchmark) {
+    // NOLINTNEXTLINE(cppcoreguidelines-avoid-magic-numbers,readability-magic-numbers)
+    benchmark->ArgsProduct({{4096, 32768, 262144}, {10, 40}, {0, 1}})
+        ->Unit(benchmark::kMillisecond);
+  }
+
+  void orders(benchmark::internal::Benchmark * benchmark) {
+    // NOLINTNEXTLINE(cppcoreguidelines-avoid-magic-numbers,readability-magic-numbers)
+    benchmark->ArgsProduct({{32768, 262144, 1048576},
+                            {10},
+                            {static_cast<int64_t>(sim::BlockOrder::linear),
+                             static_cast<int64_t>(sim::BlockOrder::morton),
+                             static_cast<int64_t>(sim::BlockOrder::hilbert)}})
+        ->Unit(benchmark::kMillisecond);
+  }
+
+  void kernels(benchmark::internal::Benchmark * benchmark) {
+    // NOLINTNEXTLINE(cppcoreguidelines-avoid-magic-numbers,readability-magic-numbers)
+    benchmark->ArgsProduct({{4096, 32768, 262144},
+                            {10, 40},
+                            {static_cast<int64_t>(sim::KernelType::scalar),
+                             static_cast<int64_t>(sim::KernelType::automatic)}})
+        ->Unit(benchmark::kMillisecond);
+  }
+}  // namespace
+
+BENCHMARK(BM_ReadFile)->Apply(sizes);
+BENCHMARK(BM_GridConstruction)->Apply(sizes);
+BENCHMARK(BM_MakeSimulation)->Apply(pipelines);
+BENCHMARK(BM_BlockOrder)->Apply(orders);
+BENCHMARK(BM_PairKernel<false>)->Name("BM_EvalDensities")->Apply(kernels);
+BENCHMARK(BM_PairKernel<true>)->Name("BM_EvalAccelerations")->Apply(kernels);
+BENCHMARK(BM_WriteSimulation)->Apply(sizes);
+
+BENCHMARK_MAIN();
@@ -0,0 +1,66 @@
+#include "cache_counters.hpp"
+
+#include <cstddef>
+
+#ifdef __linux__
+  #include <linux/perf_event.h>
+  #include <sys/ioctl.h>
+  #include <sys/syscall.h>
+  #include <unistd.h>
+#endif
+
+namespace fluids::bench {
+#ifdef __linux__
+  namespace {
+    int openCounter(uint64_t config, int group) {
+      perf_event_attr attributes{};
+      attributes.type           = PERF_TYPE_HARDWARE;
+      attributes.size           = sizeof(attributes);
+      attributes.config         = config;
+      attributes.disabled       = group < 0 ? 1 : 0;
+      attributes.exclude_kernel = 1;
+      attributes.exclude_hv     = 1;
+      return static_cast<int>(syscall(SYS_perf_event_open, &attributes, 0, -1, group, 0));
+    }
+  }  // namespace
+
+  // Los dos contadores van en un grupo para que se activen y se paren a la vez
+  CacheCounters::CacheCounters() {
+    descriptors[0] = openCounter(PERF_COUNT_HW_CACHE_REFERENCES, -1);
+    if (descriptors[0] < 0) { return; }
+    descriptors[1] = openCounter(PERF_COUNT_HW_CACHE_MISSES, descriptors[0]);
+    if (descriptors[1] < 0) {
+      close(descriptors[0]);
+      descriptors[0] = -1;
+    }
+  }
+
+  CacheCounters::~CacheCounters() {
+    for (int const descriptor : descriptors) {
+      if (descriptor >= 0) { close(descriptor); }
+    }
+  }
+
+  void CacheCounters::start() {
+    if (!available()) { return; }
+    ioctl(descriptors[0], PERF_EVENT_IOC_RESET, PERF_IOC_FLAG_GROUP);
+    ioctl(descriptors[0], PERF_EVENT_IOC_ENABLE, PERF_IOC_FLAG_GROUP);
+  }
+
+  void CacheCounters::stop() {
+    if (!available()) { return; }
+    ioctl(descriptors[0], PERF_EVENT_IOC_DISABLE, PERF_IOC_FLAG_GROUP);
+    for (size_t i = 0; i < descriptors.size(); i++) {
+      uint64_t value = 0;
+      if (read(descriptors[i], &value, sizeof(value)) == sizeof(value)) { counts[i] = value; }
+    }
+  }
+#else
+  CacheCounters::CacheCounters()  = default;
+  CacheCounters::~CacheCounters() = default;
+
+  void CacheCounters::start() { }
+
+  void CacheCounters::stop() { }
+#endif
+}  // namespace fluids::bench
@@ -0,0 +1,34 @@
+#ifndef CACHE_COUNTERS_HPP
+#define CACHE_COUNTERS_HPP
+
+#include <array>
+#include <cstdint>
+
+namespace fluids::bench {
+  // Fallos de cache del propio proceso (solo espacio de usuario) con perf_event_open. Se usan
+  // los eventos genericos: cache-references, que en Intel cuenta los accesos al ultimo nivel
+  // (los fallos de L2), y cache-misses, los fallos del ultimo nivel. Fuera de Linux, o si el
+  // sistema no deja abrir los contadores (perf_event_paranoid, maquinas virtuales sin PMU),
+  // available() es falso y las lecturas dan 0.
+  class CacheCounters {
+    public:
+      CacheCounters();
+      ~CacheCounters();
+      CacheCounters(CacheCounters const &)             = delete;
+      CacheCounters & operator=(CacheCounters const &) = delete;
+      CacheCounters(CacheCounters &&)                  = delete;
+      CacheCounters & operator=(CacheCounters &&)      = delete;
+
+      [[nodiscard]] bool available() const { return descriptors[0] >= 0; }
+      void start();
+      void stop();
+      [[nodiscard]] uint64_t l2Misses() const { return counts[0]; }
+      [[nodiscard]] uint64_t llcMisses() const { return counts[1]; }
+
+    private:
+      std::array<int, 2> descriptors{-1, -1};
+      std::array<uint64_t, 2> counts{0, 0};
+  };
+}  // namespace fluids::bench
+
+#endif  // CACHE_COUNTERS_HPP
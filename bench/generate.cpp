@@ -0,0 +1,72 @@
+#include "generator.hpp"
+
+#include "sim/utils.hpp"
+#include "sim/writer.hpp"
+
+#include <iostream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+using namespace fluids;
+
+namespace {
+  // Valor numerico de una opcion; termina el programa si no lo es
+  double optionValue(std::string const & option, std::string const & value) {
+    try {
+      size_t parsed       = 0;
+      double const number = std::stod(value, &parsed);
+      if (parsed == value.size()) { return number; }
+    } catch (std::exception const &) { }
+    std::cerr << "Error: Invalid value for " << option << ": " << value << ".\n";
+    exit(ERROR_INVALID_OPTION);
+  }
+}  // namespace
+
+// Escribe un .fld sintetico: fluidgen <particulas> <salida.fld> [--fill F | --ppm P]
+// [--jitter J] [--speed V] [--seed S]. Por defecto ocupa el 30 % del recinto.
+int main(int argc, char * argv[]) {
+  std::vector<std::string> const args(argv, argv + argc);
+  if (args.size() < 3 || args.size() % 2 == 0) {
+    std::cerr << "Error: Invalid number of arguments: " << args.size() - 1 << ".\n";
+    return ERROR_INVALID_NUMBER_ARGUMENTS;
+  }
+  double const particles = optionValue("particles", args[1]);
+  if (particles < 1 || particles != static_cast<double>(static_cast<size_t>(particles))) {
+    std::cerr << "Error: Invalid number of particles: " << args[1] << ".\n";
+    return ERROR_INVALID_PARTICLE_NUMBER;
+  }
+  bench::GeneratorOptions options;
+  options.particles = static_cast<size_t>(particles);
+  // NOLINTNEXTLINE(cppcoreguidelines-avoid-magic-numbers,readability-magic-numbers)
+  double fill = 0.3;
+  double ppm  = 0;
+  for (size_t i = 3; i < args.size(); i += 2) {
+    double const value = optionValue(args[i], args[i + 1]);
+    if (args[i] == "--fill" && value > 0 && value <= 1) {
+      fill = value;
+    } else if (args[i] == "--ppm" && value > 0) {
+      ppm = value;
+    } else if (args[i] == "--jitter" && value >= 0 && value < 0.5) {
+      options.jitter = value;
+    } else if (args[i] == "--speed" && value >= 0) {
+      options.speed = value;
+    } else if (args[i] == "--seed" && value >= 0) {
+      options.seed = static_cast<uint64_t>(value);
+    } else {
+      std::cerr << "Error: Invalid option: " << args[i] << " " << args[i + 1] << ".\n";
+      return ERROR_INVALID_OPTION;
+    }
+  }
+  options.particles_per_meter =
+      ppm > 0 ? ppm : bench::particlesPerMeterForFill(options.particles, fill);
+
+  std::vector<char> const image = bench::fldImage(bench::generateFile(options));
+  if (!sim::writeBytes(args[2], image, sim::WriteMode::buffered)) {
+    std::cerr << "Error: Cannot open " << args[2] << " for writing.\n";
+    return ERROR_CANNOT_OPEN_OUTPUT_FILE;
+  }
+  std::cout << "Particles: " << options.particles << "\n";
+  std::cout << "Particles per meter: " << options.particles_per_meter << "\n";
+  return 0;
+}
@@ -0,0 +1,104 @@
+#include "generator.hpp"
+
+#include "sim/utils.hpp"
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstring>
+#include <iostream>
+
+namespace fluids::bench {
+  namespace {
+    // splitmix64: generador pequeño y con el mismo resultado en cualquier plataforma, a
+    // diferencia de las distribuciones de <random>
+    class Random {
+      public:
+        explicit Random(uint64_t seed) : state(seed) { }
+
+        // Uniforme en [-1, 1)
+        double symmetric() {
+          state      += 0x9E3779B97F4A7C15ULL;
+          uint64_t z  = state;
+          z           = (z ^ (z >> 30U)) * 0xBF58476D1CE4E5B9ULL;
+          z           = (z ^ (z >> 27U)) * 0x94D049BB133111EBULL;
+          z           = z ^ (z >> 31U);
+          // NOLINTNEXTLINE(cppcoreguidelines-avoid-magic-numbers,readability-magic-numbers)
+          return 2 * std::ldexp(static_cast<double>(z >> 11U), -53) - 1;
+        }
+
+      private:
+        uint64_t state;
+    };
+  }  // namespace
+
+  double particlesPerMeterForFill(size_t particles, double fill) {
+    sim::Vector3D<double> const box = sim::bmax - sim::bmin;
+    return std::cbrt(static_cast<double>(particles) / (fill * box.x * box.y * box.z));
+  }
+
+  sim::File<double> generateFile(GeneratorOptions const & options) {
+    double const spacing            = 1 / options.particles_per_meter;
+    sim::Vector3D<double> const box = sim::bmax - sim::bmin;
+    auto const fit                  = [&](double length) {
+      return static_cast<size_t>(std::floor(length / spacing));
+    };
+    // Base cuadrada lo mas parecida a un cubo que quepa en el recinto
+    auto const side     = static_cast<size_t>(std::ceil(std::cbrt(options.particles)));
+    size_t const size_x = std::max<size_t>(1, std::min(side, fit(box.x)));
+    size_t const size_z = std::max<size_t>(1, std::min(side, fit(box.z)));
+    size_t const size_y = (options.particles + size_x * size_z - 1) / (size_x * size_z);
+    if (options.particles == 0 || size_y > fit(box.y)) {
+      std::cerr << "Error: " << options.particles << " particles do not fit in the box at "
+                << options.particles_per_meter << " particles per meter.\n";
+      exit(ERROR_INVALID_PARTICLE_NUMBER);
+    }
+
+    sim::File<double> file;
+    file.particles_per_meter = options.particles_per_meter;
+    file.particles.resize(options.particles);
+    Random random(options.seed);
+    // Centrada en x y z, desde el fondo en y
+    sim::Vector3D<double> const origin(-spacing * static_cast<double>(size_x - 1) / 2,
+                                       sim::bmin.y + spacing / 2,
+                                       -spacing * static_cast<double>(size_z - 1) / 2);
+    double const jitter = options.jitter * spacing;
+    for (size_t i = 0; i < options.particles; i++) {
+      sim::Vector3D<double> const cell(static_cast<double>(i % size_x),
+                                       static_cast<double>(i / (size_x * size_z)),
+                                       static_cast<double>((i / size_x) % size_z));
+      sim::Vector3D<double> const offset(random.symmetric(), random.symmetric(),
+                                         random.symmetric());
+      sim::Vector3D<double> const speed(random.symmetric(), random.symmetric(),
+                                        random.symmetric());
+      file.particles.position.set(i, origin + cell * spacing + offset * jitter);
+      file.particles.speed.set(i, speed * options.speed);
+      file.particles.hv_vector.set(i, speed * options.speed);
+    }
+    return file;
+  }
+
+  std::vector<char> fldImage(sim::File<double> const & file) {
+    constexpr size_t record_floats = 9;
+    sim::Particles<double> const & particles = file.particles;
+    auto const particles_per_meter           = static_cast<float>(file.particles_per_meter);
+    auto const number_particles              = static_cast<int>(particles.size());
+    std::vector<char> bytes(sizeof(particles_per_meter) + sizeof(number_particles) +
+                            particles.size() * record_floats * sizeof(float));
+    char * output = bytes.data();
+    auto const put = [&](auto value) {
+      std::memcpy(output, &value, sizeof(value));
+      output += sizeof(value);
+    };
+    put(particles_per_meter);
+    put(number_particles);
+    for (size_t i = 0; i < particles.size(); i++) {
+      std::array<double, record_floats> const record = {
+        particles.position.x[i],  particles.position.y[i],  particles.position.z[i],
+        particles.hv_vector.x[i], particles.hv_vector.y[i], particles.hv_vector.z[i],
+        particles.speed.x[i],     particles.speed.y[i],     particles.speed.z[i]};
+      for (double const value : record) { put(static_cast<float>(value)); }
+    }
+    return bytes;
+  }
+}  // namespace fluids::bench
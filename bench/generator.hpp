@@ -0,0 +1,34 @@
+#ifndef GENERATOR_HPP
+#define GENERATOR_HPP
+
+#include "sim/grid.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace fluids::bench {
+  // Conjunto sintetico de particulas: una columna de fluido en reposo apoyada en el fondo del
+  // recinto, en una rejilla de separacion 1 / particles_per_meter (como los .fld de inputs/)
+  // con un desplazamiento aleatorio de cada particula.
+  struct GeneratorOptions {
+      size_t particles           = 0;
+      double particles_per_meter = 204;
+      double jitter              = 0.1;  // Desplazamiento maximo, en fracciones de la separacion
+      double speed               = 0;    // Velocidad maxima de cada componente (m/s)
+      uint64_t seed              = 1;    // Misma semilla, mismas particulas en cualquier maquina
+  };
+
+  // Particulas por metro con las que particles particulas ocupan la fraccion fill del recinto
+  double particlesPerMeterForFill(size_t particles, double fill);
+
+  // Termina el programa con ERROR_INVALID_PARTICLE_NUMBER si las particulas no caben en el
+  // recinto con esa separacion
+  sim::File<double> generateFile(GeneratorOptions const & options);
+
+  // Imagen .fld de file (cabecera y registros en float), para escribirla o leerla con readFile
+  std::vector<char> fldImage(sim::File<double> const & file);
+}  // namespace fluids::bench
+
+#endif  // GENERATOR_HPP
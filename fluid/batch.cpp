@@ -0,0 +1,180 @@
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <fstream>
+#include <iostream>
+#include <mutex>
+#include <optional>
+#include <set>
+#include <sstream>
+#include <stdexcept>
+#include <thread>
+#include "sim/checkpoint.hpp"
+#include "sim/grid.hpp"
+#include "sim/progargs.hpp"
+#include "sim/utils.hpp"
+
+using namespace fluids::sim;
+
+// Un trabajo del manifiesto: los argumentos de fluidapp de una linea
+struct Job {
+    int line;
+    Configuration config;
+};
+
+struct JobResult {
+    size_t particles = 0;
+    int64_t steps    = 0;      // nts, o menos con --time
+    double seconds   = 0;      // Lectura, construccion (o load), pasos y escritura
+    bool reused      = false;  // Con la rejilla del trabajo anterior del mismo hilo
+};
+
+// Opciones de fluidapp que escriben ficheros aparte o en std::cout durante la simulacion
+constexpr std::array<char const *, 7> unsupported_options = {
+    "--snapshot-every", "--snapshot-file", "--checkpoint-every", "--checkpoint-file",
+    "--checkpoint-compression", "--profile", "--profile-trace"};
+
+// Cada linea no vacia del manifiesto (lo que sigue a '#' es un comentario) tiene los
+// argumentos de una ejecucion de fluidapp: <pasos> <entrada.fld> <salida.fld> [opciones].
+// Todos los trabajos se comprueban con correctArguments antes de empezar el primero.
+std::vector<Job> readManifest(std::string const & filename) {
+    std::ifstream manifest(filename);
+    if (!manifest.good()) {
+        std::cerr << "Error: Cannot open " << filename << " for reading.\n";
+        exit(ERROR_CANNOT_OPEN_INPUT_FILE);
+    }
+    std::vector<Job> jobs;
+    std::set<std::string> outputs;
+    std::string line;
+    for (int line_number = 1; std::getline(manifest, line); line_number++) {
+        std::istringstream words(line.substr(0, line.find('#')));
+        std::vector<std::string> args = {"fluidbatch"};
+        for (std::string word; words >> word;) { args.push_back(word); }
+        if (args.size() == 1) { continue; }
+        for (char const * option : unsupported_options) {
+            if (std::find(args.begin(), args.end(), option) != args.end()) {
+                std::cerr << "Error: " << filename << ":" << line_number << ": " << option
+                          << " is not supported in batch mode.\n";
+                exit(ERROR_INVALID_OPTION);
+            }
+        }
+        ProgramArguments progargs(static_cast<int>(args.size()), args);
+        progargs.correctArguments();
+        Configuration config = progargs.parseArguments();
+        if (isCheckpoint(config.inputFile)) {
+            std::cerr << "Error: " << filename << ":" << line_number
+                      << ": Checkpoints are not supported in batch mode.\n";
+            exit(ERROR_INVALID_OPTION);
+        }
+        if (!outputs.insert(config.outputFile).second) {
+            std::cerr << "Error: " << filename << ":" << line_number << ": Cannot open "
+                      << config.outputFile << " for writing (already written by another job).\n";
+            exit(ERROR_CANNOT_OPEN_OUTPUT_FILE);
+        }
+        config.options.verbose = false;
+        jobs.push_back({line_number, config});
+    }
+    return jobs;
+}
+
+// Simula un trabajo en grid si la rejilla se puede reutilizar (Grid::reusable) o en una nueva
+JobResult runJob(Job const & job, std::optional<Grid<double>> & grid) {
+    auto const start   = std::chrono::steady_clock::now();
+    std::string input  = job.config.inputFile;
+    File<double> file  = readFile<double>(input);
+    JobResult result   = {.particles = file.particles.size()};
+    result.reused      = grid && grid->reusable(file, job.config.options, job.config.scenario);
+    if (result.reused) {
+        grid->load(file, job.config.scenario);
+    } else {
+        grid.emplace(file, job.config.options, job.config.scenario);
+    }
+    double const target_time = job.config.targetTime;
+    for (; result.steps < job.config.nts; result.steps++) {
+        if (target_time > 0) {
+            if (grid->reachedTime(target_time)) { break; }
+            grid->limitTimeStep(target_time);
+        }
+        grid->makeSimulation();
+    }
+    std::string output = job.config.outputFile;
+    grid->writeSimulation(output);
+    std::chrono::duration<double> const elapsed = std::chrono::steady_clock::now() - start;
+    result.seconds = elapsed.count();
+    return result;
+}
+
+unsigned int parseWorkers(std::vector<std::string> const & args) {
+    if (args.size() == 2) { return std::max(1U, std::thread::hardware_concurrency()); }
+    if (args[2] != "--jobs") {
+        std::cerr << "Error: Unknown option " << args[2] << ".\n";
+        exit(ERROR_INVALID_OPTION);
+    }
+    int workers = 0;
+    try {
+        workers = std::stoi(args[3]);
+    } catch (std::logic_error const & error) {
+        workers = 0;
+    }
+    // Cada trabajo en curso usa un hilo, con el mismo limite que --threads
+    if (workers <= 0 || workers > static_cast<int>(max_threads)) {
+        std::cerr << "Error: Invalid number of jobs.\n";
+        exit(ERROR_INVALID_OPTION);
+    }
+    return static_cast<unsigned int>(workers);
+}
+
+// Ejecuta en un solo proceso los trabajos de un manifiesto, repartidos entre varios hilos
+// (uno por nucleo si no se indica --jobs): fluidbatch <manifiesto> [--jobs N]
+int main(int argc, char* argv[]) {
+    std::vector<std::string> args(argv, argv + argc);
+    if (args.size() != 2 && args.size() != 4) {
+        std::cerr << "Error: Invalid number of arguments: " << args.size() - 1 << ".\n";
+        return ERROR_INVALID_NUMBER_ARGUMENTS;
+    }
+    unsigned int const requested = parseWorkers(args);
+    std::vector<Job> const jobs  = readManifest(args[1]);
+    size_t const workers         = std::max<size_t>(1, std::min<size_t>(requested, jobs.size()));
+
+    // Cada hilo toma el siguiente trabajo libre y conserva su ultima rejilla
+    std::vector<JobResult> results(jobs.size());
+    std::atomic<size_t> next = 0;
+    std::mutex report;
+    auto const start = std::chrono::steady_clock::now();
+    auto work        = [&] {
+        std::optional<Grid<double>> grid;
+        for (size_t i = next++; i < jobs.size(); i = next++) {
+            results[i] = runJob(jobs[i], grid);
+            Configuration const & config = jobs[i].config;
+            double const particle_steps = static_cast<double>(results[i].particles) *
+                                          static_cast<double>(results[i].steps) /
+                                          results[i].seconds;
+            std::lock_guard const lock(report);
+            std::cout << "Job " << i + 1 << " (line " << jobs[i].line << "): " << config.inputFile
+                      << " -> " << config.outputFile << ", " << results[i].steps << " steps, "
+                      << results[i].particles << " particles, " << results[i].seconds << " s, "
+                      << particle_steps << " particle-steps/s"
+                      << (results[i].reused ? " (reused grid)" : "") << "\n";
+        }
+    };
+    std::vector<std::thread> threads;
+    for (size_t w = 0; w < workers; w++) { threads.emplace_back(work); }
+    for (std::thread & thread : threads) { thread.join(); }
+    std::chrono::duration<double> const elapsed = std::chrono::steady_clock::now() - start;
+
+    double particle_steps = 0;
+    size_t reused         = 0;
+    for (size_t i = 0; i < jobs.size(); i++) {
+        particle_steps += static_cast<double>(results[i].particles) *
+                          static_cast<double>(results[i].steps);
+        reused         += results[i].reused ? 1 : 0;
+    }
+    std::cout << "Jobs: " << jobs.size() << " on " << workers << " threads\n";
+    std::cout << "Total time: " << elapsed.count() << " s\n";
+    std::cout << "Throughput: " << static_cast<double>(jobs.size()) / elapsed.count()
+              << " jobs/s, " << particle_steps / elapsed.count() << " particle-steps/s\n";
+    std::cout << "Reused grids: " << reused << " of " << jobs.size() << "\n";
+    return 0;
+}
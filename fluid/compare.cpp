@@ -0,0 +1,112 @@
+#include <algorithm>
+#include <cctype>
+#include <cstdint>
+#include <iostream>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+#include "sim/compare.hpp"
+#include "sim/options.hpp"
+#include "sim/utils.hpp"
+
+using namespace fluids::sim;
+
+double parseValue(std::string const & value, std::string const & option) {
+    double number = -1;
+    try {
+        size_t used = 0;
+        number      = std::stod(value, &used);
+        if (used != value.size()) { number = -1; }
+    } catch (std::logic_error const & error) {
+        number = -1;
+    }
+    if (!(number >= 0)) {
+        std::cerr << "Error: Invalid value for " << option << ": " << value << ".\n";
+        exit(ERROR_INVALID_OPTION);
+    }
+    return number;
+}
+
+// Entero sin signo escrito entero: rechaza signos, decimales y valores que no caben
+uint64_t parseCount(std::string const & value, std::string const & option) {
+    uint64_t number = 0;
+    bool valid      = !value.empty() && std::isdigit(static_cast<unsigned char>(value[0])) != 0;
+    try {
+        size_t used = 0;
+        if (valid) { number = std::stoull(value, &used); }
+        valid = valid && used == value.size();
+    } catch (std::logic_error const & error) {
+        valid = false;
+    }
+    if (!valid) {
+        std::cerr << "Error: Invalid value for " << option << ": " << value << ".\n";
+        exit(ERROR_INVALID_OPTION);
+    }
+    return number;
+}
+
+CompareOptions parseOptions(std::vector<std::string> const & args) {
+    CompareOptions options;
+    options.threads = std::max(1U, std::thread::hardware_concurrency());
+    for (size_t i = 3; i < args.size(); i++) {
+        std::string const & option = args[i];
+        if (option != "--abs" && option != "--rel" && option != "--ulp" &&
+            option != "--threads" && option != "--worst") {
+            std::cerr << "Error: Invalid option: " << option << ".\n";
+            exit(ERROR_INVALID_OPTION);
+        }
+        if (i + 1 == args.size()) {
+            std::cerr << "Error: Missing value for " << option << ".\n";
+            exit(ERROR_INVALID_OPTION);
+        }
+        std::string const & value = args[++i];
+        if (option == "--abs") {
+            options.tolerance.absolute = parseValue(value, option);
+        } else if (option == "--rel") {
+            options.tolerance.relative = parseValue(value, option);
+        } else if (option == "--ulp") {
+            options.tolerance.ulps = parseCount(value, option);
+        } else if (option == "--threads") {
+            uint64_t const threads = parseCount(value, option);
+            if (threads == 0) {
+                std::cerr << "Error: Invalid value for " << option << ": " << value << ".\n";
+                exit(ERROR_INVALID_OPTION);
+            }
+            if (threads > max_threads) {
+                std::cerr << "Error: Too many threads (at most " << max_threads << ").\n";
+                exit(ERROR_INVALID_OPTION);
+            }
+            options.threads = static_cast<unsigned int>(threads);
+        } else {
+            options.worst = parseCount(value, option);
+        }
+    }
+    return options;
+}
+
+// Compara dos .fld (registro a registro) o dos .trz (por id) proyectados en memoria:
+// fluidcompare <primero> <segundo> [--abs A] [--rel R] [--ulp U] [--threads N] [--worst K]
+// Cada valor coincide si es igual o cumple alguna de las tolerancias dadas. Devuelve 0 si
+// coinciden todos y 1 si no.
+int main(int argc, char* argv[]) {
+    std::vector<std::string> const args(argv, argv + argc);
+    if (args.size() < 3) {
+        std::cerr << "Error: Invalid number of arguments: " << args.size() - 1 << ".\n";
+        exit(ERROR_INVALID_NUMBER_ARGUMENTS);
+    }
+    CompareOptions const options = parseOptions(args);
+    Comparison const comparison  = compareFiles(args[1], args[2], options);
+    if (!comparison.error.empty()) {
+        std::cerr << "Error: Cannot compare " << args[1] << " and " << args[2] << ": "
+                  << comparison.error << ".\n";
+        exit(ERROR_INVALID_PARTICLE_NUMBER);
+    }
+    printComparison(std::cout, comparison);
+    if (comparison.matches()) {
+        std::cout << "Result: match\n";
+        return 0;
+    }
+    std::cout << "Result: " << comparison.mismatches() << " values out of tolerance\n";
+    return 1;
+}
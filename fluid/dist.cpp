@@ -0,0 +1,179 @@
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cstdint>
+#include <iostream>
+#include <sstream>
+#include <stdexcept>
+#include <sys/wait.h>
+#include <thread>
+#include <unistd.h>
+#include "sim/checkpoint.hpp"
+#include "sim/distributed.hpp"
+#include "sim/progargs.hpp"
+#include "sim/transport.hpp"
+#include "sim/utils.hpp"
+
+using namespace fluids::sim;
+
+enum class TransportType { tcp, memory };
+
+// Opciones propias de fluiddist; el resto se pasan a ProgramArguments como en fluidapp
+struct DistOptions {
+    int ranks               = 2;
+    TransportType transport = TransportType::tcp;
+    uint16_t port           = 47000;  // NOLINT(cppcoreguidelines-avoid-magic-numbers)
+};
+
+// Opciones de fluidapp que no se pueden repartir entre rangos
+constexpr std::array<char const *, 9> unsupported_options = {
+    "--snapshot-every", "--snapshot-file",  "--checkpoint-every", "--checkpoint-file",
+    "--checkpoint-compression", "--profile", "--profile-trace", "--verlet-skin", "--adaptive"};
+
+int parseNumber(std::string const & value, std::string const & option, int min, int max) {
+    int number = min - 1;
+    try {
+        size_t used = 0;
+        number      = std::stoi(value, &used);
+        if (used != value.size()) { number = min - 1; }
+    } catch (std::logic_error const & error) {
+        number = min - 1;
+    }
+    if (number < min || number > max) {
+        std::cerr << "Error: Invalid value for " << option << ": " << value << ".\n";
+        exit(ERROR_INVALID_OPTION);
+    }
+    return number;
+}
+
+// Quita de args las opciones de fluiddist y comprueba que no haya ninguna que no se pueda
+// repartir
+DistOptions extractDistOptions(std::vector<std::string> & args) {
+    DistOptions dist;
+    std::vector<std::string> rest;
+    for (size_t i = 0; i < args.size(); i++) {
+        std::string const & arg = args[i];
+        if (std::find(unsupported_options.begin(), unsupported_options.end(), arg) !=
+            unsupported_options.end()) {
+            std::cerr << "Error: " << arg << " is not supported in distributed mode.\n";
+            exit(ERROR_INVALID_OPTION);
+        }
+        if (arg != "--ranks" && arg != "--transport" && arg != "--port") {
+            rest.push_back(arg);
+            continue;
+        }
+        if (i + 1 == args.size()) {
+            std::cerr << "Error: Missing value for " << arg << ".\n";
+            exit(ERROR_INVALID_OPTION);
+        }
+        std::string const & value = args[++i];
+        if (arg == "--ranks") {
+            dist.ranks = parseNumber(value, arg, 1, UINT16_MAX);
+        } else if (arg == "--port") {
+            dist.port = static_cast<uint16_t>(parseNumber(value, arg, 1, UINT16_MAX));
+        } else if (value == "tcp" || value == "memory") {
+            dist.transport = value == "tcp" ? TransportType::tcp : TransportType::memory;
+        } else {
+            std::cerr << "Error: Invalid transport: " << value << ".\n";
+            exit(ERROR_INVALID_OPTION);
+        }
+    }
+    if (dist.port + dist.ranks - 1 > UINT16_MAX) {
+        std::cerr << "Error: Invalid value for --port: " << dist.port << ".\n";
+        exit(ERROR_INVALID_OPTION);
+    }
+    args = rest;
+    return dist;
+}
+
+// Un rango completo: lee la entrada, simula su lamina y reune el resultado en el rango 0,
+// que escribe la salida
+void runRank(Configuration config, Transport & transport) {
+    bool const first       = transport.rank() == 0;
+    config.options.verbose = first;
+    File<double> file      = readFile<double>(config.inputFile);
+    DistributedGrid<double> dist(file, transport, config.options, config.scenario);
+    bool const timed = config.targetTime > 0;
+    int64_t steps    = 0;
+    auto const start = std::chrono::steady_clock::now();
+    for (; steps < config.nts; steps++) {
+        if (timed) {
+            if (dist.grid.reachedTime(config.targetTime)) { break; }
+            dist.grid.limitTimeStep(config.targetTime);
+        }
+        dist.makeSimulation();
+    }
+    std::chrono::duration<double> const elapsed = std::chrono::steady_clock::now() - start;
+    // Una sola escritura por rango para que las lineas de los procesos no se mezclen
+    std::ostringstream report;
+    report << "Rank " << transport.rank() << ": layers " << dist.z_begin << " to "
+           << dist.z_end - 1 << ", " << dist.grid.file.particles.size() << " particles, "
+           << dist.bytes_sent << " bytes sent, " << dist.exchange_seconds << " s of "
+           << elapsed.count() << " s exchanging\n";
+    std::cout << report.str() << std::flush;
+    dist.gather();
+    if (!first) { return; }
+    dist.grid.writeSimulation(config.outputFile);
+    if (timed) {
+        std::cout << "Simulated time: " << dist.grid.time << " s in " << steps << " steps\n";
+    }
+    std::cout << "Simulation time: " << elapsed.count() << " s\n";
+}
+
+// Simulacion repartida en laminas de bloques a lo largo de z, una por rango:
+// fluiddist <pasos> <entrada.fld> <salida.fld> [--ranks N] [--transport tcp|memory]
+//           [--port P] [opciones de fluidapp]
+// Con tcp cada rango es un proceso (los N - 1 ultimos, hijos del primero) y se comunican por
+// 127.0.0.1 en los puertos P a P + N - 1; con memory, hilos de este proceso.
+int main(int argc, char* argv[]) {
+    std::vector<std::string> args(argv, argv + argc);
+    DistOptions const dist    = extractDistOptions(args);
+    ProgramArguments progargs = ProgramArguments(static_cast<int>(args.size()), args);
+    progargs.correctArguments();
+    Configuration const config = progargs.parseArguments();
+    if (isCheckpoint(config.inputFile)) {
+        std::cerr << "Error: Checkpoints are not supported in distributed mode.\n";
+        exit(ERROR_INVALID_OPTION);
+    }
+    std::cout << "Ranks: " << dist.ranks << " ("
+              << (dist.transport == TransportType::tcp ? "tcp" : "memory") << ")\n";
+
+    if (dist.transport == TransportType::memory) {
+        MemoryExchange hub(dist.ranks);
+        std::vector<std::thread> ranks;
+        for (int rank = 0; rank < dist.ranks; rank++) {
+            ranks.emplace_back([&, rank] {
+                MemoryTransport transport(hub, rank);
+                runRank(config, transport);
+            });
+        }
+        for (std::thread & rank : ranks) { rank.join(); }
+        return 0;
+    }
+    std::cout << std::flush;
+    std::vector<pid_t> children;
+    for (int rank = 1; rank < dist.ranks; rank++) {
+        pid_t const child = fork();
+        if (child < 0) {
+            std::cerr << "Error: Cannot start rank " << rank << ".\n";
+            exit(ERROR_TRANSPORT);
+        }
+        if (child == 0) {
+            TcpTransport transport(rank, dist.ranks, dist.port);
+            runRank(config, transport);
+            return 0;
+        }
+        children.push_back(child);
+    }
+    {
+        TcpTransport transport(0, dist.ranks, dist.port);
+        runRank(config, transport);
+    }
+    int result = 0;
+    for (pid_t const child : children) {
+        int status = 0;
+        waitpid(child, &status, 0);
+        if (!WIFEXITED(status) || WEXITSTATUS(status) != 0) { result = ERROR_TRANSPORT; }
+    }
+    return result;
+}
@@ -1,21 +1,110 @@
+#include <algorithm>
+#include <chrono>
 #include <iostream>
+#include <optional>
+#include <utility>
+#include "sim/checkpoint.hpp"
 #include "sim/progargs.hpp"
 #include "sim/grid.hpp"
+#include "sim/trajectory.hpp"
 #include "sim/utils.hpp"
 
 using namespace fluids::sim;
 
+// fluidapp_f32 se compila con FLUIDS_SINGLE_PRECISION y simula en float
+#ifdef FLUIDS_SINGLE_PRECISION
+using Real = float;
+#else
+using Real = double;
+#endif
+
 int main(int argc, char* argv[]) {
     std::vector<std::string> args(argv, argv + argc);
     ProgramArguments progargs = ProgramArguments(argc, args);
     progargs.correctArguments();
     struct Configuration config = progargs.parseArguments();
-    struct File file = readFile(config.inputFile);
-    Grid grid(file);
-    for (uint16_t time_step = 0; time_step < config.nts; time_step++) {
+    // La entrada puede ser un punto de control: la simulacion sigue desde su paso hasta nts
+    std::optional<Checkpoint<Real>> checkpoint;
+    int64_t first_step = 0;
+    if (isCheckpoint(config.inputFile)) {
+        checkpoint = readCheckpoint<Real>(config.inputFile);
+        first_step = checkpoint->step;
+    }
+    // Grid se queda con los arrays de la entrada; copiarlos duplicaria la memoria al empezar
+    File<Real> file = checkpoint ? std::move(checkpoint->file) : readFile<Real>(config.inputFile);
+    Grid<Real> grid(std::move(file), config.options, config.scenario);
+    if (checkpoint) {
+        checkRestart(*checkpoint, grid);
+        restoreTime(*checkpoint, grid);
+        checkpoint.reset();
+    }
+    // Con --snapshot-every K se añade un fotograma a la trayectoria cada K pasos. Se escribe en
+    // otro hilo mientras se calculan los pasos siguientes.
+    std::optional<TrajectoryWriter> trajectory;
+    std::vector<char> frame;
+    if (config.snapshotEvery > 0) {
+        trajectory.emplace(config.snapshotFile);
+        if (!trajectory->good()) {
+            std::cerr << "Error: Cannot open " << config.snapshotFile << " for writing.\n";
+            exit(ERROR_CANNOT_OPEN_OUTPUT_FILE);
+        }
+    }
+    // Con --time T se simula hasta el tiempo T recortando el ultimo paso; nts es entonces el
+    // numero maximo de pasos
+    bool const timed = config.targetTime > 0;
+    double min_step  = grid.time_step;
+    double max_step  = grid.time_step;
+    int64_t steps    = 0;
+    auto const start = std::chrono::steady_clock::now();
+    for (int64_t time_step = first_step + 1; time_step <= config.nts; time_step++) {
+        if (timed) {
+            if (grid.reachedTime(config.targetTime)) { break; }
+            grid.limitTimeStep(config.targetTime);
+        }
+        min_step = std::min(min_step, grid.time_step);
+        max_step = std::max(max_step, grid.time_step);
         grid.makeSimulation();
+        steps++;
+        if (trajectory && time_step % config.snapshotEvery == 0) {
+            grid.packSimulation(frame);
+            if (!trajectory->append(time_step, frame)) {
+                std::cerr << "Error: Cannot write trajectory " << config.snapshotFile << ".\n";
+                exit(ERROR_CANNOT_OPEN_OUTPUT_FILE);
+            }
+        }
+        if (config.checkpointEvery > 0 && time_step % config.checkpointEvery == 0 &&
+            !writeCheckpoint(config.checkpointFile, grid, time_step, config.checkpointCompression)) {
+            std::cerr << "Error: Cannot write checkpoint " << config.checkpointFile << ".\n";
+            exit(ERROR_CANNOT_OPEN_OUTPUT_FILE);
+        }
     }
+    std::chrono::duration<double> const elapsed = std::chrono::steady_clock::now() - start;
     grid.writeSimulation(config.outputFile);
+    if (timed || config.scenario.courant > 0) {
+        std::cout << "Simulated time: " << grid.time << " s in " << steps << " steps\n";
+        std::cout << "Time step: " << min_step << " to " << max_step << " s\n";
+        std::cout << "Simulated time per wall time: " << grid.time / elapsed.count() << "\n";
+        if (timed && !grid.reachedTime(config.targetTime)) {
+            std::cerr << "Warning: " << config.nts << " steps reached before simulated time "
+                      << config.targetTime << " s.\n";
+        }
+    }
+    if (grid.use_pair_cache) {
+        // NOLINTNEXTLINE(cppcoreguidelines-avoid-magic-numbers,readability-magic-numbers)
+        double const mebibytes = static_cast<double>(grid.pairCacheBytes()) / (1024.0 * 1024.0);
+        std::cout << "Pair cache memory: " << mebibytes << " MiB\n";
+    }
+    if (grid.profiler) {
+        grid.profiler->printSummary(std::cout);
+        if (!config.profileTrace.empty() && !grid.profiler->writeTrace(config.profileTrace)) {
+            std::cerr << "Error: Cannot open " << config.profileTrace << " for writing.\n";
+            exit(ERROR_CANNOT_OPEN_OUTPUT_FILE);
+        }
+    }
+    if (trajectory && !trajectory->close()) {
+        std::cerr << "Error: Cannot write trajectory " << config.snapshotFile << ".\n";
+        exit(ERROR_CANNOT_OPEN_OUTPUT_FILE);
+    }
     return 0;
 }
 
@@ -0,0 +1,71 @@
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <iostream>
+#include <stdexcept>
+#include <utility>
+#include "sim/grid.hpp"
+#include "sim/utils.hpp"
+
+using namespace fluids::sim;
+
+// Menor tiempo (en ms) de varias lecturas del mismo fichero con el lector dado
+template <typename Reader>
+double bestTime(int repetitions, Reader reader) {
+    double best = 0;
+    for (int i = 0; i < repetitions; i++) {
+        auto const start = std::chrono::steady_clock::now();
+        reader();
+        std::chrono::duration<double, std::milli> const elapsed =
+            std::chrono::steady_clock::now() - start;
+        best = i == 0 ? elapsed.count() : std::min(best, elapsed.count());
+    }
+    return best;
+}
+
+// Compara el tiempo de carga de readFile (mmap) y readFileStream (std::ifstream) y el de
+// escritura de writeSimulation y writeSimulationStream: fluidload <entrada.fld> [repeticiones]
+int main(int argc, char* argv[]) {
+    std::vector<std::string> args(argv, argv + argc);
+    if (args.size() < 2 || args.size() > 3) {
+        std::cerr << "Error: Invalid number of arguments: " << args.size() - 1 << ".\n";
+        return ERROR_INVALID_NUMBER_ARGUMENTS;
+    }
+    int repetitions = 5;
+    try {
+        if (args.size() == 3) { repetitions = std::stoi(args[2]); }
+    } catch (std::invalid_argument const & ia) {
+        repetitions = 0;
+    }
+    if (repetitions <= 0) {
+        std::cerr << "Error: Invalid number of repetitions.\n";
+        return ERROR_INVALID_OPTION;
+    }
+    std::string input = args[1];
+    size_t const particles = readFile<double>(input).particles.size();
+
+    double const stream_ms = bestTime(repetitions, [&] { readFileStream<double>(input); });
+    double const mapped_ms = bestTime(repetitions, [&] { readFile<double>(input); });
+    double const single_ms = bestTime(repetitions, [&] { readFile<float>(input); });
+    std::cout << "Particles: " << particles << "\n";
+    std::cout << "readFileStream<double>: " << stream_ms << " ms\n";
+    std::cout << "readFile<double>: " << mapped_ms << " ms (x" << stream_ms / mapped_ms << ")\n";
+    std::cout << "readFile<float>: " << single_ms << " ms\n";
+
+    // Las escrituras van a un fichero temporal junto a la entrada
+    File<double> file = readFile<double>(input);
+    Grid<double> grid(std::move(file));
+    std::string output = input + ".fluidload";
+    double const ofstream_ms = bestTime(repetitions, [&] { grid.writeSimulationStream(output); });
+    grid.write_mode          = WriteMode::buffered;
+    double const buffered_ms = bestTime(repetitions, [&] { grid.writeSimulation(output); });
+    grid.write_mode        = WriteMode::direct;
+    double const direct_ms = bestTime(repetitions, [&] { grid.writeSimulation(output); });
+    if (std::remove(output.c_str()) != 0) { perror("Error deleting file"); }
+    std::cout << "writeSimulationStream: " << ofstream_ms << " ms\n";
+    std::cout << "writeSimulation (buffered): " << buffered_ms << " ms (x"
+              << ofstream_ms / buffered_ms << ")\n";
+    std::cout << "writeSimulation (direct): " << direct_ms << " ms (x"
+              << ofstream_ms / direct_ms << ")\n";
+    return 0;
+}
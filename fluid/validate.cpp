@@ -0,0 +1,60 @@
+#include <algorithm>
+#include <fstream>
+#include <iostream>
+#include "sim/progargs.hpp"
+#include "sim/grid.hpp"
+#include "sim/utils.hpp"
+
+using namespace fluids::sim;
+
+// Maxima distancia entre la magnitud de cada particula en las dos simulaciones. Cada Grid
+// reordena sus particulas por su cuenta, asi que se emparejan por indice original.
+template <typename Field>
+double maxDivergence(Particles<double> const & reference, Particles<float> const & single,
+                     Field field) {
+    std::vector<size_t> const reference_slots = reference.slots();
+    std::vector<size_t> const single_slots    = single.slots();
+    double divergence = 0;
+    for (size_t k = 0; k < reference_slots.size(); k++) {
+        Vector3D<double> const expected = field(reference)[reference_slots[k]];
+        Vector3D<double> const obtained(field(single)[single_slots[k]]);
+        divergence = std::max(divergence, (obtained - expected).norm());
+    }
+    return divergence;
+}
+
+// Ejecuta la misma entrada en double y en float y escribe, para cada paso, la maxima
+// divergencia de posicion y velocidad: fluidvalidate nts input.fld report.csv [opciones]
+int main(int argc, char* argv[]) {
+    std::vector<std::string> args(argv, argv + argc);
+    ProgramArguments progargs = ProgramArguments(argc, args);
+    progargs.correctArguments();
+    struct Configuration config = progargs.parseArguments();
+    File<double> reference_file = readFile<double>(config.inputFile);
+    File<float> single_file     = readFile<float>(config.inputFile);
+    Grid<double> reference(reference_file, config.options, config.scenario);
+    Grid<float> single(single_file, config.options, config.scenario);
+
+    std::ofstream report(config.outputFile);
+    report << "step,position,velocity\n";
+    double max_position = 0;
+    double max_velocity = 0;
+    for (int64_t time_step = 1; time_step <= config.nts; time_step++) {
+        reference.makeSimulation();
+        single.makeSimulation();
+        double const position = maxDivergence(reference.file.particles, single.file.particles,
+                                              [](auto const & particles) -> auto const & {
+                                                  return particles.position;
+                                              });
+        double const velocity = maxDivergence(reference.file.particles, single.file.particles,
+                                              [](auto const & particles) -> auto const & {
+                                                  return particles.speed;
+                                              });
+        report << time_step << ',' << position << ',' << velocity << '\n';
+        max_position = std::max(max_position, position);
+        max_velocity = std::max(max_velocity, velocity);
+    }
+    std::cout << "Max position divergence: " << max_position << " m\n";
+    std::cout << "Max velocity divergence: " << max_velocity << " m/s\n";
+    return 0;
+}
@@ -19,7 +19,11 @@ OUTPUTS_DIR="$ROOT_DIR/../outputs"
 EXPECTED_OUTPUTS_DIR="$ROOT_DIR/../expected_outputs"
 
 FLUIDAPP="$ROOT_DIR/../build/fluidapp"
-READFILE="$ROOT_DIR/../read_particles"
+FLUIDBATCH="$ROOT_DIR/../build/fluidbatch"
+FLUIDDIST="$ROOT_DIR/../build/fluiddist"
+FLUIDCOMPARE="$ROOT_DIR/../build/fluidcompare"
+# Same margin as the previous text comparison with read_particles (6 significant digits)
+TOLERANCE="--rel 1e-5"
 
 if [ -d "$OUTPUTS_DIR" ]; then
     rm -rf "$OUTPUTS_DIR"
@@ -174,9 +178,7 @@ for i in {1..5}; do
     echo -n "fluidapp $i small.fld -> "
     $FLUIDAPP $i "$INPUTS_DIR/small.fld" "$OUTPUTS_DIR/small-$i.fld" &> /dev/null
     if [ $? -eq 0 ]; then
-        $READFILE $EXPECTED_OUTPUTS_DIR/small-$i.fld > /tmp/expected_small-$i.txt
-        $READFILE $OUTPUTS_DIR/small-$i.fld > /tmp/small-$i.txt
-        diff /tmp/expected_small-$i.txt /tmp/small-$i.txt &> /dev/null
+        $FLUIDCOMPARE $EXPECTED_OUTPUTS_DIR/small-$i.fld $OUTPUTS_DIR/small-$i.fld $TOLERANCE &> /dev/null
         if [ $? -eq 0 ]; then
             echo -e "OK"
         else
@@ -194,9 +196,7 @@ for i in {1..5}; do
     echo -n "fluidapp $i large.fld -> "
     $FLUIDAPP $i "$INPUTS_DIR/large.fld" "$OUTPUTS_DIR/large-$i.fld" &> /dev/null
     if [ $? -eq 0 ]; then
-        $READFILE $EXPECTED_OUTPUTS_DIR/large-$i.fld > /tmp/expected_large-$i.txt
-        $READFILE $OUTPUTS_DIR/large-$i.fld > /tmp/large-$i.txt
-        diff /tmp/expected_large-$i.txt /tmp/large-$i.txt &> /dev/null
+        $FLUIDCOMPARE $EXPECTED_OUTPUTS_DIR/large-$i.fld $OUTPUTS_DIR/large-$i.fld $TOLERANCE &> /dev/null
         if [ $? -eq 0 ]; then
             echo -e "OK"
         else
@@ -207,7 +207,68 @@ for i in {1..5}; do
     fi
 done
 
-echo -e "\nTest 16: Performance test on large dataset with 1000 iterations"
+echo -e "\nTest 16: Batch mode with 1 to 5 time steps"
 echo -e "-----------------------------------------------------------------"
-perf stat $FLUIDAPP 1000 "$INPUTS_DIR/large.fld" "$OUTPUTS_DIR/large-1000.fld" > /dev/null 2> /tmp/test16.txt
-cat /tmp/test16.txt | grep -v "Performance counter stats" | tail -n 18 | head -n 16
+
+rm -f /tmp/test16_manifest.txt
+for i in {1..5}; do
+    echo "$i $INPUTS_DIR/small.fld $OUTPUTS_DIR/batch-small-$i.fld" >> /tmp/test16_manifest.txt
+    echo "$i $INPUTS_DIR/large.fld $OUTPUTS_DIR/batch-large-$i.fld" >> /tmp/test16_manifest.txt
+done
+echo -n "fluidbatch manifest -> "
+$FLUIDBATCH /tmp/test16_manifest.txt &> /dev/null
+if [ $? -eq 0 ]; then
+    result="OK"
+    for size in small large; do
+        for i in {1..5}; do
+            $FLUIDCOMPARE $EXPECTED_OUTPUTS_DIR/$size-$i.fld $OUTPUTS_DIR/batch-$size-$i.fld $TOLERANCE &> /dev/null
+            if [ $? -ne 0 ]; then
+                result="Error: output file batch-$size-$i.fld is not correct"
+            fi
+        done
+    done
+    echo -e "$result"
+else
+    echo -e "Error: Invalid return code"
+fi
+
+echo -e "\nTest 17: Fixed time step up to a simulated time of 5 time steps"
+echo -e "-----------------------------------------------------------------"
+
+echo -n "fluidapp 100 small.fld --time 0.005 -> "
+$FLUIDAPP 100 "$INPUTS_DIR/small.fld" "$OUTPUTS_DIR/small-time.fld" --time 0.005 &> /dev/null
+if [ $? -eq 0 ]; then
+    $FLUIDCOMPARE $EXPECTED_OUTPUTS_DIR/small-5.fld $OUTPUTS_DIR/small-time.fld $TOLERANCE &> /dev/null
+    if [ $? -eq 0 ]; then
+        echo -e "OK"
+    else
+        echo -e "Error: output file is not correct"
+    fi
+else
+    echo -e "Error: Invalid return code"
+fi
+
+echo -e "\nTest 18: Distributed run over 3 ranks with 1 to 5 time steps"
+echo -e "-----------------------------------------------------------------"
+
+for size in small large; do
+    for i in {1..5}; do
+        echo -n "fluiddist $i $size.fld --ranks 3 -> "
+        $FLUIDDIST $i "$INPUTS_DIR/$size.fld" "$OUTPUTS_DIR/dist-$size-$i.fld" --ranks 3 &> /dev/null
+        if [ $? -eq 0 ]; then
+            $FLUIDCOMPARE $EXPECTED_OUTPUTS_DIR/$size-$i.fld $OUTPUTS_DIR/dist-$size-$i.fld $TOLERANCE &> /dev/null
+            if [ $? -eq 0 ]; then
+                echo -e "OK"
+            else
+                echo -e "Error: output file is not correct"
+            fi
+        else
+            echo -e "Error: Invalid return code"
+        fi
+    done
+done
+
+echo -e "\nTest 19: Performance test on large dataset with 1000 iterations"
+echo -e "-----------------------------------------------------------------"
+perf stat $FLUIDAPP 1000 "$INPUTS_DIR/large.fld" "$OUTPUTS_DIR/large-1000.fld" > /dev/null 2> /tmp/test19.txt
+cat /tmp/test19.txt | grep -v "Performance counter stats" | tail -n 18 | head -n 16
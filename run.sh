@@ -4,6 +4,10 @@ if [ ! -d ./outputs ]; then
     mkdir outputs
 fi
 
-perf stat ./build/fluidapp 1000 ./inputs/large.fld ./outputs/large.fld
+# Comparativa de las funciones de pares: escalar frente a SIMD (avx2, avx512)
+for kernel in scalar avx2 avx512; do
+    echo "Kernel: $kernel"
+    rm -f "./outputs/large-$kernel.fld"
+    perf stat ./build/fluidapp 1000 ./inputs/large.fld "./outputs/large-$kernel.fld" --kernel "$kernel"
+done
 echo "Finished execution"
-
@@ -1,15 +1,34 @@
 #ifndef BLOCK_HPP
 #define BLOCK_HPP
 
-#include <vector>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
 
 namespace fluids::sim {
+  // Las particulas se ordenan por bloque, por lo que cada bloque es el rango [begin, end)
   class Block {
     public:
+      // Valor de neighbours para los bloques que todavia no han tenido particulas
+      static constexpr uint32_t none = std::numeric_limits<uint32_t>::max();
+      // Bits de walls: pared del recinto en bmin o en bmax de cada eje
+      static constexpr uint8_t wall_x_min = 1U << 0U;
+      static constexpr uint8_t wall_x_max = 1U << 1U;
+      static constexpr uint8_t wall_y_min = 1U << 2U;
+      static constexpr uint8_t wall_y_max = 1U << 3U;
+      static constexpr uint8_t wall_z_min = 1U << 4U;
+      static constexpr uint8_t wall_z_max = 1U << 5U;
+
       int x, y, z;
-      std::vector<size_t> particles = std::vector<size_t>();
+      uint32_t neighbours = none;  // Posicion de sus vecinos en las tablas de Grid
+      size_t begin        = 0;
+      size_t end          = 0;
+      bool active         = false;  // Esta en Grid::active_blocks
+      uint8_t walls       = 0;      // Paredes con las que chocan sus particulas (0 si es interior)
       Block(int x_coord, int y_coord, int z_coord) : x(x_coord), y(y_coord), z(z_coord){};
+
+      [[nodiscard]] size_t size() const { return end - begin; }
   };
 }  // namespace fluids::sim
 
-#endif  // BLOCK_HPP
\ No newline at end of file
+#endif  // BLOCK_HPP
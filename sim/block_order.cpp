@@ -0,0 +1,89 @@
+#include "block_order.hpp"
+
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <numeric>
+
+namespace fluids::sim {
+  namespace {
+    // Separa los 21 bits bajos de value dejando dos ceros entre cada uno
+    uint64_t spreadBits(uint32_t value) {
+      uint64_t spread = value & 0x1FFFFFU;
+      spread          = (spread | spread << 32U) & 0x1F00000000FFFFULL;
+      spread          = (spread | spread << 16U) & 0x1F0000FF0000FFULL;
+      spread          = (spread | spread << 8U) & 0x100F00F00F00F00FULL;
+      spread          = (spread | spread << 4U) & 0x10C30C30C30C30C3ULL;
+      spread          = (spread | spread << 2U) & 0x1249249249249249ULL;
+      return spread;
+    }
+  }  // namespace
+
+  // x en el bit mas bajo: en una rejilla de 2 x 2 x 2 coincide con el orden lineal
+  uint64_t mortonKey(uint32_t x, uint32_t y, uint32_t z) {
+    return spreadBits(x) | spreadBits(y) << 1U | spreadBits(z) << 2U;
+  }
+
+  // Algoritmo de Skilling ("Programming the Hilbert curve", 2004): pasa las coordenadas a la
+  // forma traspuesta del indice y entrelaza sus bits, empezando por el mas significativo
+  uint64_t hilbertKey(uint32_t x, uint32_t y, uint32_t z, unsigned bits) {
+    std::array<uint32_t, 3> axes = {x, y, z};
+    if (bits == 0) { return 0; }
+    uint32_t const top = 1U << (bits - 1);
+    for (uint32_t q = top; q > 1; q >>= 1U) {
+      uint32_t const p = q - 1;
+      for (uint32_t & axis : axes) {
+        if ((axis & q) != 0) {
+          axes[0] ^= p;
+        } else {
+          uint32_t const swap = (axes[0] ^ axis) & p;
+          axes[0]            ^= swap;
+          axis               ^= swap;
+        }
+      }
+    }
+    axes[1] ^= axes[0];
+    axes[2] ^= axes[1];
+    uint32_t gray = 0;
+    for (uint32_t q = top; q > 1; q >>= 1U) {
+      if ((axes[2] & q) != 0) { gray ^= q - 1; }
+    }
+    uint64_t key = 0;
+    for (uint32_t & axis : axes) { axis ^= gray; }
+    for (unsigned bit = bits; bit-- > 0;) {
+      for (uint32_t const axis : axes) { key = key << 1U | ((axis >> bit) & 1U); }
+    }
+    return key;
+  }
+
+  std::vector<size_t> blockTraversal(BlockOrder order, int n_x, int n_y, int n_z) {
+    auto const count = static_cast<size_t>(n_x) * static_cast<size_t>(n_y) *
+                       static_cast<size_t>(n_z);
+    std::vector<size_t> traversal(count);
+    std::iota(traversal.begin(), traversal.end(), 0);
+    if (order == BlockOrder::linear) { return traversal; }
+    auto const side = static_cast<uint32_t>(std::max({n_x, n_y, n_z}));
+    auto const bits = static_cast<unsigned>(std::bit_width(side - 1));
+    auto const size_x = static_cast<size_t>(n_x);
+    auto const size_y = static_cast<size_t>(n_y);
+    std::vector<uint64_t> keys(count);
+    for (size_t i = 0; i < count; i++) {
+      auto const x = static_cast<uint32_t>(i % size_x);
+      auto const y = static_cast<uint32_t>(i / size_x % size_y);
+      auto const z = static_cast<uint32_t>(i / (size_x * size_y));
+      keys[i]      = order == BlockOrder::morton ? mortonKey(x, y, z) : hilbertKey(x, y, z, bits);
+    }
+    std::sort(traversal.begin(), traversal.end(),
+              [&keys](size_t a, size_t b) { return keys[a] < keys[b]; });
+    return traversal;
+  }
+
+  std::string blockOrderName(BlockOrder order) {
+    switch (order) {
+      case BlockOrder::linear:  return "linear";
+      case BlockOrder::morton:  return "morton";
+      case BlockOrder::hilbert: return "hilbert";
+    }
+    return "linear";
+  }
+}  // namespace fluids::sim
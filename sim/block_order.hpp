@@ -0,0 +1,24 @@
+#ifndef BLOCK_ORDER_HPP
+#define BLOCK_ORDER_HPP
+
+#include "options.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace fluids::sim {
+  // Claves de las curvas que recorren una rejilla de 2^bits celdas por lado. Celdas con claves
+  // consecutivas son vecinas (Hilbert) o casi siempre estan cerca (Morton).
+  uint64_t mortonKey(uint32_t x, uint32_t y, uint32_t z);
+  uint64_t hilbertKey(uint32_t x, uint32_t y, uint32_t z, unsigned bits);
+
+  // Indices lineales (x + (y + z * n_y) * n_x) de los bloques en el orden de recorrido. Con
+  // linear es la identidad; con las curvas, las celdas de la curva que caen fuera de la
+  // rejilla se saltan.
+  std::vector<size_t> blockTraversal(BlockOrder order, int n_x, int n_y, int n_z);
+  std::string blockOrderName(BlockOrder order);
+}  // namespace fluids::sim
+
+#endif  // BLOCK_ORDER_HPP
@@ -0,0 +1,414 @@
+#include "checkpoint.hpp"
+
+#include "kernels.hpp"
+#include "mapped_file.hpp"
+#include "scenario.hpp"
+#include "utils.hpp"
+#include "writer.hpp"
+
+#include <algorithm>
+#include <array>
+#include <cstdio>
+#include <cstring>
+#include <fcntl.h>
+#include <iostream>
+#include <limits>
+#include <span>
+#include <unistd.h>
+#include <vector>
+
+#ifdef FLUIDS_HAVE_ZLIB
+  #include <zlib.h>
+#endif
+
+namespace fluids::sim {
+  namespace {
+    constexpr std::array<char, 8> magic = {'F', 'L', 'U', 'I', 'D', 'C', 'H', 'K'};
+    constexpr int64_t version           = 3;
+    constexpr size_t header_integers    = 11;  // Valores int64 de la cabecera tras magic
+    // Campos de Scenario en el orden de la cabecera
+    constexpr std::array scenario_scalars = {
+        &Scenario::radius_multiplicator, &Scenario::fluid_density, &Scenario::pressure_rigidity,
+        &Scenario::rigidity_collisions,  &Scenario::dumping,       &Scenario::viscosity,
+        &Scenario::particle_size,        &Scenario::time_increase, &Scenario::courant};
+    constexpr std::array scenario_vectors = {&Scenario::external_acceleration, &Scenario::bmax,
+                                             &Scenario::bmin};
+    // particles_per_meter, time, time_step y el escenario
+    constexpr size_t header_doubles = 3 + scenario_scalars.size() + 3 * scenario_vectors.size();
+    constexpr size_t header_size =
+        magic.size() + header_integers * sizeof(int64_t) + header_doubles * sizeof(double);
+
+    static_assert(sizeof(size_t) == sizeof(uint64_t), "id se guarda como uint64");
+
+    // Bytes de cada particula en los arrays: id y 13 valores T
+    template <std::floating_point T>
+    constexpr size_t particle_bytes = sizeof(uint64_t) + 13 * sizeof(T);
+
+    // Bytes de cada array de Particles en el orden del fichero
+    template <std::floating_point T>
+    std::vector<std::span<char const>> arrays(Particles<T> const & particles) {
+      auto const bytes = [](auto const & values) {
+        // NOLINTNEXTLINE(cppcoreguidelines-pro-type-reinterpret-cast)
+        return std::span<char const>(reinterpret_cast<char const *>(values.data()),
+                                     values.size() * sizeof(values[0]));
+      };
+      return {bytes(particles.id),             bytes(particles.position.x),
+              bytes(particles.position.y),     bytes(particles.position.z),
+              bytes(particles.hv_vector.x),    bytes(particles.hv_vector.y),
+              bytes(particles.hv_vector.z),    bytes(particles.speed.x),
+              bytes(particles.speed.y),        bytes(particles.speed.z),
+              bytes(particles.acceleration.x), bytes(particles.acceleration.y),
+              bytes(particles.acceleration.z), bytes(particles.density)};
+    }
+
+    // Los mismos arrays para escribir en ellos al leer
+    template <std::floating_point T>
+    std::vector<std::span<char>> writableArrays(Particles<T> & particles) {
+      auto const bytes = [](auto & values) {
+        // NOLINTNEXTLINE(cppcoreguidelines-pro-type-reinterpret-cast)
+        return std::span<char>(reinterpret_cast<char *>(values.data()),
+                               values.size() * sizeof(values[0]));
+      };
+      return {bytes(particles.id),             bytes(particles.position.x),
+              bytes(particles.position.y),     bytes(particles.position.z),
+              bytes(particles.hv_vector.x),    bytes(particles.hv_vector.y),
+              bytes(particles.hv_vector.z),    bytes(particles.speed.x),
+              bytes(particles.speed.y),        bytes(particles.speed.z),
+              bytes(particles.acceleration.x), bytes(particles.acceleration.y),
+              bytes(particles.acceleration.z), bytes(particles.density)};
+    }
+
+    void appendValue(std::vector<char> & bytes, auto value) {
+      std::array<char, sizeof(value)> raw{};
+      std::memcpy(raw.data(), &value, sizeof(value));
+      bytes.insert(bytes.end(), raw.begin(), raw.end());
+    }
+
+    template <typename Value>
+    Value readValue(char const * bytes) {
+      Value value{};
+      std::memcpy(&value, bytes, sizeof(value));
+      return value;
+    }
+
+#ifdef FLUIDS_HAVE_ZLIB
+    constexpr size_t chunk_size = size_t{4} << 20U;  // Bytes sin comprimir por bloque
+
+    // Tamaño de cada valor de los arrays: id es uint64 y el resto T
+    template <std::floating_point T>
+    size_t valueSize(size_t array) {
+      return array == 0 ? sizeof(uint64_t) : sizeof(T);
+    }
+
+    // Agrupa los bytes de los valores de tamaño value_size por posicion dentro del valor. Los
+    // bytes altos de coordenadas cercanas se repiten y zlib los comprime mucho mejor.
+    void shuffle(std::span<char const> input, size_t value_size, std::vector<char> & output) {
+      size_t const count = input.size() / value_size;
+      output.resize(input.size());
+      for (size_t i = 0; i < count; i++) {
+        for (size_t b = 0; b < value_size; b++) { output[b * count + i] = input[i * value_size + b]; }
+      }
+    }
+
+    void unshuffle(std::span<char const> input, size_t value_size, std::span<char> output) {
+      size_t const count = input.size() / value_size;
+      for (size_t i = 0; i < count; i++) {
+        for (size_t b = 0; b < value_size; b++) { output[i * value_size + b] = input[b * count + i]; }
+      }
+    }
+
+    // Bytes sin comprimir de los bloques completos a partir de offset, hasta llegar a limit.
+    // Solo recorre las cabeceras de los bloques: no descomprime nada.
+    size_t inflatedSize(MappedFile const & input, size_t offset, size_t limit) {
+      size_t inflated = 0;
+      while (inflated < limit && input.size() - offset >= 2 * sizeof(int64_t)) {
+        auto const raw_size    = readValue<int64_t>(input.data() + offset);
+        auto const stored_size = readValue<int64_t>(input.data() + offset + sizeof(int64_t));
+        offset                += 2 * sizeof(int64_t);
+        if (raw_size <= 0 || raw_size > static_cast<int64_t>(chunk_size) || stored_size < 0 ||
+            input.size() - offset < static_cast<size_t>(stored_size)) {
+          break;
+        }
+        inflated += static_cast<size_t>(raw_size);
+        offset   += static_cast<size_t>(stored_size);
+      }
+      return inflated;
+    }
+#endif
+
+    [[noreturn]] void invalidCheckpoint(std::string const & filename, std::string const & reason) {
+      std::cerr << "Error: Invalid checkpoint " << filename << ": " << reason << ".\n";
+      exit(ERROR_INVALID_CHECKPOINT);
+    }
+
+    // Escribe los arrays a partir de offset y lo deja al final de lo escrito; con compresion,
+    // por bloques de chunk_size
+    template <std::floating_point T>
+    bool writeArrays(int descriptor, Particles<T> const & particles, off_t & offset,
+                     Compression compression) {
+      std::vector<std::span<char const>> const data = arrays(particles);
+      if (compression == Compression::none) {
+        for (std::span<char const> const array : data) {
+          if (!writeAt(descriptor, array, offset)) { return false; }
+          offset += static_cast<off_t>(array.size());
+        }
+        return true;
+      }
+#ifdef FLUIDS_HAVE_ZLIB
+      std::vector<char> shuffled;
+      std::vector<char> compressed;
+      for (size_t array = 0; array < data.size(); array++) {
+        size_t const value_size = valueSize<T>(array);
+        for (size_t first = 0; first < data[array].size(); first += chunk_size) {
+          std::span<char const> const chunk =
+              data[array].subspan(first, std::min(chunk_size, data[array].size() - first));
+          shuffle(chunk, value_size, shuffled);
+          uLongf compressed_size = compressBound(static_cast<uLong>(chunk.size()));
+          compressed.resize(2 * sizeof(int64_t) + compressed_size);
+          char * const target = compressed.data() + 2 * sizeof(int64_t);
+          // NOLINTNEXTLINE(cppcoreguidelines-pro-type-reinterpret-cast)
+          if (compress2(reinterpret_cast<Bytef *>(target), &compressed_size,
+                        // NOLINTNEXTLINE(cppcoreguidelines-pro-type-reinterpret-cast)
+                        reinterpret_cast<Bytef const *>(shuffled.data()),
+                        static_cast<uLong>(shuffled.size()), Z_BEST_SPEED) != Z_OK) {
+            return false;
+          }
+          auto const raw_size    = static_cast<int64_t>(chunk.size());
+          auto const stored_size = static_cast<int64_t>(compressed_size);
+          std::memcpy(compressed.data(), &raw_size, sizeof(raw_size));
+          std::memcpy(compressed.data() + sizeof(raw_size), &stored_size, sizeof(stored_size));
+          compressed.resize(2 * sizeof(int64_t) + compressed_size);
+          if (!writeAt(descriptor, compressed, offset)) { return false; }
+          offset += static_cast<off_t>(compressed.size());
+        }
+      }
+      return true;
+#else
+      return false;
+#endif
+    }
+  }  // namespace
+
+  template <std::floating_point T>
+  bool writeCheckpoint(std::string const & filename, Grid<T> const & grid, int64_t step,
+                       Compression compression) {
+    std::vector<char> header(magic.begin(), magic.end());
+    appendValue(header, version);
+    appendValue(header, static_cast<int64_t>(sizeof(T)));
+    appendValue(header, step);
+    appendValue(header, static_cast<int64_t>(grid.file.particles.size()));
+    appendValue(header, static_cast<int64_t>(grid.n_blocks_x));
+    appendValue(header, static_cast<int64_t>(grid.n_blocks_y));
+    appendValue(header, static_cast<int64_t>(grid.n_blocks_z));
+    appendValue(header, static_cast<int64_t>(grid.kernel));
+    appendValue(header, static_cast<int64_t>(grid.pool->size()));
+    appendValue(header, static_cast<int64_t>(compression));
+    appendValue(header, static_cast<int64_t>(grid.block_maxima.size()));
+    appendValue(header, static_cast<double>(grid.file.particles_per_meter));
+    appendValue(header, grid.time);
+    appendValue(header, grid.time_step);
+    for (auto const field : scenario_scalars) { appendValue(header, grid.scenario.*field); }
+    for (auto const field : scenario_vectors) {
+      Vector3D<double> const & value = grid.scenario.*field;
+      appendValue(header, value.x);
+      appendValue(header, value.y);
+      appendValue(header, value.z);
+    }
+
+    std::string const temporary = filename + ".tmp";
+    int const descriptor =
+        open(temporary.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+    if (descriptor < 0) { return false; }
+    std::vector<char> maxima;
+    for (auto const & [speed_2, acceleration_2] : grid.block_maxima) {
+      appendValue(maxima, speed_2);
+      appendValue(maxima, acceleration_2);
+    }
+
+    auto offset = static_cast<off_t>(header.size());
+    bool const written =
+        writeAt(descriptor, header, 0) &&
+        writeArrays(descriptor, grid.file.particles, offset, compression) &&
+        writeAt(descriptor, maxima, offset) && fsync(descriptor) == 0;
+    if (close(descriptor) != 0 || !written) {
+      std::remove(temporary.c_str());
+      return false;
+    }
+    return std::rename(temporary.c_str(), filename.c_str()) == 0;
+  }
+
+  bool isCheckpoint(std::string const & filename) {
+    MappedFile const input(filename);
+    return input.good() && input.size() >= magic.size() &&
+           std::memcmp(input.data(), magic.data(), magic.size()) == 0;
+  }
+
+  template <std::floating_point T>
+  Checkpoint<T> readCheckpoint(std::string const & filename) {
+    MappedFile const input(filename);
+    if (!input.good()) {
+      std::cerr << "Error: Cannot open " << filename << " for reading.\n";
+      exit(ERROR_CANNOT_OPEN_INPUT_FILE);
+    }
+    if (input.size() < header_size || std::memcmp(input.data(), magic.data(), magic.size()) != 0) {
+      invalidCheckpoint(filename, "missing header");
+    }
+    std::array<int64_t, header_integers> values{};
+    for (size_t i = 0; i < values.size(); i++) {
+      values[i] = readValue<int64_t>(input.data() + magic.size() + i * sizeof(int64_t));
+    }
+    auto const [file_version, scalar_size, step, particles, blocks_x, blocks_y, blocks_z, kernel,
+                threads, compression, maxima] = values;
+    if (file_version != version) { invalidCheckpoint(filename, "unsupported version"); }
+    if (scalar_size != static_cast<int64_t>(sizeof(T))) {
+      invalidCheckpoint(filename, "stores " + std::to_string(scalar_size) +
+                                      "-byte values, this program uses " +
+                                      std::to_string(sizeof(T)));
+    }
+    if (particles <= 0 || step < 0 || threads <= 0 || maxima < 0 ||
+        (maxima != 0 && maxima != blocks_x * blocks_y * blocks_z)) {
+      invalidCheckpoint(filename, "bad header");
+    }
+    if (compression != static_cast<int64_t>(Compression::none) &&
+        compression != static_cast<int64_t>(Compression::zlib)) {
+      invalidCheckpoint(filename, "unknown compression");
+    }
+#ifndef FLUIDS_HAVE_ZLIB
+    if (compression == static_cast<int64_t>(Compression::zlib)) {
+      invalidCheckpoint(filename, "zlib compression is not available in this build");
+    }
+#endif
+    // Antes de reservar los arrays: una cabecera corrupta no debe pedir mas memoria de la que
+    // el fichero puede llenar
+    if (static_cast<uint64_t>(particles) > std::numeric_limits<size_t>::max() / particle_bytes<T>) {
+      invalidCheckpoint(filename, "bad header");
+    }
+    size_t const required = static_cast<size_t>(particles) * particle_bytes<T>;
+    size_t available      = input.size() - header_size;
+#ifdef FLUIDS_HAVE_ZLIB
+    if (compression == static_cast<int64_t>(Compression::zlib)) {
+      available = inflatedSize(input, header_size, required);
+    }
+#endif
+    if (available < required) { invalidCheckpoint(filename, "truncated"); }
+
+    Checkpoint<T> checkpoint;
+    checkpoint.step       = step;
+    checkpoint.n_blocks_x = blocks_x;
+    checkpoint.n_blocks_y = blocks_y;
+    checkpoint.n_blocks_z = blocks_z;
+    checkpoint.kernel     = static_cast<KernelType>(kernel);
+    checkpoint.threads    = static_cast<unsigned int>(threads);
+    size_t position = magic.size() + header_integers * sizeof(int64_t);
+    auto const next = [&input, &position]() {
+      auto const value  = readValue<double>(input.data() + position);
+      position         += sizeof(double);
+      return value;
+    };
+    checkpoint.file.particles_per_meter = static_cast<T>(next());
+    checkpoint.time                     = next();
+    checkpoint.time_step                = next();
+    for (auto const field : scenario_scalars) { checkpoint.scenario.*field = next(); }
+    for (auto const field : scenario_vectors) {
+      double const x             = next();
+      double const y             = next();
+      double const z             = next();
+      checkpoint.scenario.*field = Vector3D<double>(x, y, z);
+    }
+    checkpoint.file.particles.resize(static_cast<size_t>(particles));
+
+    std::vector<std::span<char>> const data = writableArrays(checkpoint.file.particles);
+    size_t offset = header_size;
+    if (compression == static_cast<int64_t>(Compression::none)) {
+      for (std::span<char> const array : data) {
+        if (input.size() - offset < array.size()) { invalidCheckpoint(filename, "truncated"); }
+        std::memcpy(array.data(), input.data() + offset, array.size());
+        offset += array.size();
+      }
+    }
+#ifdef FLUIDS_HAVE_ZLIB
+    if (compression == static_cast<int64_t>(Compression::zlib)) {
+      std::vector<char> shuffled;
+      for (size_t array = 0; array < data.size(); array++) {
+        for (size_t first = 0; first < data[array].size(); first += chunk_size) {
+          size_t const expected = std::min(chunk_size, data[array].size() - first);
+          if (input.size() - offset < 2 * sizeof(int64_t)) {
+            invalidCheckpoint(filename, "truncated");
+          }
+          auto const raw_size    = readValue<int64_t>(input.data() + offset);
+          auto const stored_size = readValue<int64_t>(input.data() + offset + sizeof(int64_t));
+          offset                += 2 * sizeof(int64_t);
+          if (raw_size != static_cast<int64_t>(expected) || stored_size < 0 ||
+              input.size() - offset < static_cast<size_t>(stored_size)) {
+            invalidCheckpoint(filename, "truncated");
+          }
+          shuffled.resize(expected);
+          auto inflated = static_cast<uLongf>(expected);
+          // NOLINTNEXTLINE(cppcoreguidelines-pro-type-reinterpret-cast)
+          if (uncompress(reinterpret_cast<Bytef *>(shuffled.data()), &inflated,
+                         // NOLINTNEXTLINE(cppcoreguidelines-pro-type-reinterpret-cast)
+                         reinterpret_cast<Bytef const *>(input.data() + offset),
+                         static_cast<uLong>(stored_size)) != Z_OK ||
+              inflated != expected) {
+            invalidCheckpoint(filename, "corrupt compressed data");
+          }
+          unshuffle(shuffled, valueSize<T>(array), data[array].subspan(first, expected));
+          offset += static_cast<size_t>(stored_size);
+        }
+      }
+    }
+#endif
+    if (static_cast<size_t>(maxima) > (input.size() - offset) / (2 * sizeof(T))) {
+      invalidCheckpoint(filename, "truncated");
+    }
+    checkpoint.block_maxima.resize(static_cast<size_t>(maxima));
+    for (auto & [speed_2, acceleration_2] : checkpoint.block_maxima) {
+      speed_2         = readValue<T>(input.data() + offset);
+      acceleration_2  = readValue<T>(input.data() + offset + sizeof(T));
+      offset         += 2 * sizeof(T);
+    }
+    if (offset != input.size()) { invalidCheckpoint(filename, "unexpected trailing data"); }
+    return checkpoint;
+  }
+
+  template <std::floating_point T>
+  void checkRestart(Checkpoint<T> const & checkpoint, Grid<T> const & grid) {
+    std::string const difference = scenarioDifference(checkpoint.scenario, grid.scenario);
+    if (!difference.empty()) {
+      std::cerr << "Error: Checkpoint was written with a different " << difference
+                << "; restart it with the same scenario.\n";
+      exit(ERROR_INVALID_CHECKPOINT);
+    }
+    if (checkpoint.n_blocks_x != grid.n_blocks_x || checkpoint.n_blocks_y != grid.n_blocks_y ||
+        checkpoint.n_blocks_z != grid.n_blocks_z) {
+      std::cerr << "Error: Checkpoint grid " << checkpoint.n_blocks_x << " x "
+                << checkpoint.n_blocks_y << " x " << checkpoint.n_blocks_z
+                << " does not match the simulation grid.\n";
+      exit(ERROR_INVALID_CHECKPOINT);
+    }
+    if (checkpoint.kernel != grid.kernel || (checkpoint.threads > 1) != (grid.pool->size() > 1)) {
+      std::cerr << "Warning: checkpoint was written with kernel " << kernelName(checkpoint.kernel)
+                << " and " << checkpoint.threads
+                << " thread(s); the result will not be bit-identical to an uninterrupted run.\n";
+    }
+  }
+
+  template <std::floating_point T>
+  void restoreTime(Checkpoint<T> const & checkpoint, Grid<T> & grid) {
+    grid.time = checkpoint.time;
+    grid.setTimeStep(checkpoint.time_step);
+    if (!checkpoint.block_maxima.empty()) { grid.block_maxima = checkpoint.block_maxima; }
+  }
+
+  template bool writeCheckpoint<float>(std::string const & filename, Grid<float> const & grid,
+                                       int64_t step, Compression compression);
+  template bool writeCheckpoint<double>(std::string const & filename, Grid<double> const & grid,
+                                        int64_t step, Compression compression);
+  template Checkpoint<float> readCheckpoint<float>(std::string const & filename);
+  template Checkpoint<double> readCheckpoint<double>(std::string const & filename);
+  template void checkRestart<float>(Checkpoint<float> const & checkpoint, Grid<float> const & grid);
+  template void checkRestart<double>(Checkpoint<double> const & checkpoint,
+                                     Grid<double> const & grid);
+  template void restoreTime<float>(Checkpoint<float> const & checkpoint, Grid<float> & grid);
+  template void restoreTime<double>(Checkpoint<double> const & checkpoint, Grid<double> & grid);
+}  // namespace fluids::sim
@@ -0,0 +1,69 @@
+#ifndef CHECKPOINT_HPP
+#define CHECKPOINT_HPP
+
+#include "grid.hpp"
+#include "options.hpp"
+
+#include <concepts>
+#include <cstdint>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace fluids::sim {
+  // Estado completo de una simulacion para continuarla mas tarde con el mismo resultado,
+  // bit a bit, que si no se hubiera interrumpido.
+  template <std::floating_point T>
+  struct Checkpoint {
+      File<T> file;                                // Particulas en precision completa e id
+      int64_t step         = 0;                    // Pasos ya simulados
+      int64_t n_blocks_x   = 0;                    // Rejilla con la que se escribio
+      int64_t n_blocks_y   = 0;
+      int64_t n_blocks_z   = 0;
+      KernelType kernel    = KernelType::automatic;  // Funciones de pares usadas hasta ahora
+      unsigned int threads = 1;                      // Hilos usados hasta ahora
+      Scenario scenario;                             // Parametros fisicos y recinto
+      double time          = 0;                      // Tiempo simulado
+      double time_step     = 0;                      // Paso del siguiente makeSimulation
+      std::vector<std::pair<T, T>> block_maxima;     // Grid::block_maxima (vacio con paso fijo)
+  };
+
+  // Fichero de punto de control (.chk):
+  //   Cabecera (264 bytes, int64 hasta los maximos y double desde particles_per_meter):
+  //   "FLUIDCHK", version, tamaño del tipo de coma flotante, paso, numero de particulas,
+  //   bloques en x, y y z, funciones de pares, hilos, compresion, numero de maximos de bloque,
+  //   particulas por metro, tiempo simulado, paso de tiempo y los campos de Scenario en el
+  //   orden en que se declaran (los vectores como x, y, z).
+  //   Arrays en el orden de la simulacion: id (uint64), posicion, hv, velocidad y aceleracion
+  //   (x, y, z) y densidad (T). Con compresion, cada array se guarda en bloques de 4 MiB:
+  //   tamaño original, tamaño comprimido (int64) y los bytes de zlib del bloque con los bytes
+  //   de cada valor agrupados por posicion (primero todos los bytes 0, luego los 1...).
+  //   Con paso adaptativo, los maximos de cada bloque (|hv|^2 y |a|^2, T) sin comprimir.
+  // Se escribe en filename.tmp y se renombra al terminar, de modo que una interrupcion a
+  // mitad de la escritura conserva el punto de control anterior. Devuelve false si falla.
+  template <std::floating_point T>
+  bool writeCheckpoint(std::string const & filename, Grid<T> const & grid, int64_t step,
+                       Compression compression);
+
+  // true si filename empieza como un punto de control (y no como un .fld)
+  bool isCheckpoint(std::string const & filename);
+
+  // Lee un punto de control escrito con el mismo tipo T. Si no es valido, termina el
+  // programa con ERROR_INVALID_CHECKPOINT.
+  template <std::floating_point T>
+  Checkpoint<T> readCheckpoint(std::string const & filename);
+
+  // Comprueba que grid se ha construido con el mismo escenario y la misma rejilla que el punto
+  // de control (si no, termina con ERROR_INVALID_CHECKPOINT) y avisa
+  // si las funciones de pares o el recorrido (serie o paralelo) no son los mismos, porque
+  // entonces el resultado no es identico al de la ejecucion sin interrumpir
+  template <std::floating_point T>
+  void checkRestart(Checkpoint<T> const & checkpoint, Grid<T> const & grid);
+
+  // Continua en grid el tiempo simulado, el paso y los maximos por bloque del punto de control
+  // (despues de checkRestart)
+  template <std::floating_point T>
+  void restoreTime(Checkpoint<T> const & checkpoint, Grid<T> & grid);
+}  // namespace fluids::sim
+
+#endif  // CHECKPOINT_HPP
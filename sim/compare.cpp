@@ -0,0 +1,344 @@
+#include "compare.hpp"
+
+#include "mapped_file.hpp"
+#include "thread_pool.hpp"
+#include "utils.hpp"
+
+#include <algorithm>
+#include <bit>
+#include <cmath>
+#include <cstring>
+#include <iomanip>
+#include <iostream>
+#include <limits>
+#include <type_traits>
+
+namespace fluids::sim {
+  namespace {
+    constexpr size_t fld_header = sizeof(float) + sizeof(int);
+    constexpr size_t fld_values = 9;  // Posicion, hv y velocidad
+    constexpr size_t fld_record = fld_values * sizeof(float);
+    constexpr size_t trz_values = 13;  // Ademas densidad y aceleracion
+    constexpr size_t trz_record = sizeof(int64_t) + trz_values * sizeof(double);
+    // Particulas de cada tramo repartido entre los hilos
+    constexpr size_t chunk_particles = 16384;
+    constexpr size_t no_record       = std::numeric_limits<size_t>::max();
+
+    constexpr std::array<char const *, n_fields> field_names = {"position", "hv", "velocity",
+                                                                 "density", "acceleration"};
+
+    // Campo de cada valor de un registro
+    constexpr Field valueField(size_t value) {
+      if (value < fld_values) { return static_cast<Field>(value / 3); }
+      return value == fld_values ? Field::density : Field::acceleration;
+    }
+
+    // Entero con el mismo orden que los valores: la diferencia entre dos es su distancia en ULP
+    // (+0 y -0 dan el mismo)
+    template <typename T>
+    int64_t orderedBits(T value) {
+      using Bits      = std::conditional_t<sizeof(T) == sizeof(int32_t), int32_t, int64_t>;
+      Bits const bits = std::bit_cast<Bits>(value);
+      return bits < 0 ? std::numeric_limits<Bits>::min() - bits : bits;
+    }
+
+    template <typename T>
+    uint64_t ulpDistance(T first, T second) {
+      if (std::isnan(first) || std::isnan(second)) {
+        return std::numeric_limits<uint64_t>::max();
+      }
+      auto const first_bits  = static_cast<uint64_t>(orderedBits(first));
+      auto const second_bits = static_cast<uint64_t>(orderedBits(second));
+      return orderedBits(first) > orderedBits(second) ? first_bits - second_bits
+                                                      : second_bits - first_bits;
+    }
+
+    // Resultado de un tramo de particulas
+    struct Summary {
+        std::array<FieldError, n_fields> field_errors{};
+        std::array<size_t, histogram_buckets> histogram{};
+        std::vector<ParticleError> worst;
+    };
+
+    bool worse(ParticleError const & first, ParticleError const & second) {
+      if (first.ulps != second.ulps) { return first.ulps > second.ulps; }
+      if (first.absolute != second.absolute) { return first.absolute > second.absolute; }
+      return first.id < second.id;
+    }
+
+    // Deja en worst las count particulas con mas error, ordenadas
+    void keepWorst(std::vector<ParticleError> & worst, size_t count) {
+      std::ranges::sort(worst, worse);
+      if (worst.size() > count) { worst.resize(count); }
+    }
+
+    // Compara las particulas [begin, end). read(k, first, second) copia los valores de la
+    // particula k de cada fichero y devuelve su id.
+    template <typename T, size_t Values, typename Read>
+    Summary compareRange(size_t begin, size_t end, Read const & read,
+                         CompareOptions const & options) {
+      Tolerance const & tolerance = options.tolerance;
+      Summary summary;
+      std::array<T, Values> first{};
+      std::array<T, Values> second{};
+      for (size_t k = begin; k < end; k++) {
+        ParticleError particle{.id = read(k, first, second)};
+        for (size_t value = 0; value < Values; value++) {
+          auto const a    = static_cast<double>(first[value]);
+          auto const b    = static_cast<double>(second[value]);
+          double absolute = 0;
+          double relative = 0;
+          double scale    = 0;
+          uint64_t ulps   = 0;
+          if (std::memcmp(&first[value], &second[value], sizeof(T)) != 0) {
+            ulps     = ulpDistance(first[value], second[value]);
+            scale    = std::max(std::abs(a), std::abs(b));
+            absolute = std::abs(a - b);
+            if (std::isnan(absolute)) { absolute = std::numeric_limits<double>::infinity(); }
+            relative = scale > 0 ? absolute / scale : absolute;
+          }
+          bool const within = absolute <= tolerance.absolute ||
+                              absolute <= tolerance.relative * scale || ulps <= tolerance.ulps;
+          FieldError & field = summary.field_errors.at(static_cast<size_t>(valueField(value)));
+          field.values++;
+          if (!within) { field.mismatches++; }
+          field.max_absolute = std::max(field.max_absolute, absolute);
+          field.max_relative = std::max(field.max_relative, relative);
+          field.max_ulps     = std::max(field.max_ulps, ulps);
+          summary.histogram.at(static_cast<size_t>(std::bit_width(ulps)))++;
+          if (ulps > particle.ulps) {
+            particle.field    = valueField(value);
+            particle.absolute = absolute;
+            particle.ulps     = ulps;
+          }
+        }
+        if (particle.ulps > 0 && options.worst > 0) {
+          summary.worst.push_back(particle);
+          if (summary.worst.size() >= 2 * options.worst + chunk_particles / 64) {
+            keepWorst(summary.worst, options.worst);
+          }
+        }
+      }
+      keepWorst(summary.worst, options.worst);
+      return summary;
+    }
+
+    // Reparte las particulas en tramos entre los hilos y junta sus resultados en orden, de
+    // modo que no dependen del numero de hilos
+    template <typename T, size_t Values, typename Read>
+    Comparison compareParticles(size_t n_particles, Read const & read,
+                                CompareOptions const & options) {
+      size_t const n_chunks = (n_particles + chunk_particles - 1) / chunk_particles;
+      std::vector<Summary> summaries(n_chunks);
+      ThreadPool pool(std::max(options.threads, 1U));
+      pool.parallelFor(n_chunks, [&](size_t chunk) {
+        size_t const begin = chunk * chunk_particles;
+        size_t const end   = std::min(n_particles, begin + chunk_particles);
+        summaries[chunk]   = compareRange<T, Values>(begin, end, read, options);
+      });
+
+      Comparison comparison;
+      comparison.particles = n_particles;
+      comparison.fields    = static_cast<size_t>(valueField(Values - 1)) + 1;
+      for (Summary const & summary : summaries) {
+        for (size_t field = 0; field < n_fields; field++) {
+          FieldError & total       = comparison.field_errors.at(field);
+          FieldError const & chunk = summary.field_errors.at(field);
+          total.max_absolute       = std::max(total.max_absolute, chunk.max_absolute);
+          total.max_relative       = std::max(total.max_relative, chunk.max_relative);
+          total.max_ulps           = std::max(total.max_ulps, chunk.max_ulps);
+          total.values            += chunk.values;
+          total.mismatches        += chunk.mismatches;
+        }
+        for (size_t bucket = 0; bucket < histogram_buckets; bucket++) {
+          comparison.histogram.at(bucket) += summary.histogram.at(bucket);
+        }
+        comparison.worst.insert(comparison.worst.end(), summary.worst.begin(),
+                                summary.worst.end());
+      }
+      keepWorst(comparison.worst, options.worst);
+      return comparison;
+    }
+
+    // Numero de particulas de un .fld, o un error si la cabecera no coincide con el tamaño
+    std::string fldParticles(std::span<char const> bytes, char const * which, size_t & count) {
+      int number_particles = 0;
+      if (bytes.size() >= fld_header) {
+        std::memcpy(&number_particles, bytes.data() + sizeof(float), sizeof(number_particles));
+      }
+      if (number_particles <= 0) {
+        return std::string("invalid number of particles in the ") + which + " file";
+      }
+      count = static_cast<size_t>(number_particles);
+      if (bytes.size() != fld_header + count * fld_record) {
+        return std::string("the size of the ") + which + " file does not match its header";
+      }
+      return "";
+    }
+
+    // Posicion del registro de cada id de un .trz, o un error si no tiene el formato esperado
+    // o si los ids no son 0 ... n - 1 sin repetir
+    std::string trzRecords(std::span<char const> bytes, char const * which,
+                           std::vector<size_t> & records) {
+      std::string const file = std::string(" in the ") + which + " file";
+      int32_t n_blocks       = 0;
+      if (bytes.size() < sizeof(n_blocks)) { return "missing number of blocks" + file; }
+      std::memcpy(&n_blocks, bytes.data(), sizeof(n_blocks));
+      if (n_blocks < 0) { return "invalid number of blocks" + file; }
+      std::vector<std::pair<int64_t, size_t>> found;
+      size_t offset = sizeof(n_blocks);
+      for (int32_t block = 0; block < n_blocks; block++) {
+        int64_t n_particles = 0;
+        if (bytes.size() - offset < sizeof(n_particles)) { return "truncated block" + file; }
+        std::memcpy(&n_particles, bytes.data() + offset, sizeof(n_particles));
+        offset += sizeof(n_particles);
+        if (n_particles < 0 ||
+            static_cast<uint64_t>(n_particles) > (bytes.size() - offset) / trz_record) {
+          return "truncated block" + file;
+        }
+        for (int64_t particle = 0; particle < n_particles; particle++) {
+          int64_t id = 0;
+          std::memcpy(&id, bytes.data() + offset, sizeof(id));
+          found.emplace_back(id, offset);
+          offset += trz_record;
+        }
+      }
+      if (offset != bytes.size()) { return "unexpected bytes after the last block" + file; }
+      records.assign(found.size(), no_record);
+      for (auto const & [id, record] : found) {
+        if (id < 0 || static_cast<uint64_t>(id) >= records.size()) {
+          return "particle id " + std::to_string(id) + " out of range" + file;
+        }
+        if (records[static_cast<size_t>(id)] != no_record) {
+          return "repeated particle id " + std::to_string(id) + file;
+        }
+        records[static_cast<size_t>(id)] = record;
+      }
+      return "";
+    }
+
+    bool hasExtension(std::string const & filename, std::string const & extension) {
+      return filename.size() >= extension.size() &&
+             filename.compare(filename.size() - extension.size(), extension.size(), extension) ==
+                 0;
+    }
+  }  // namespace
+
+  char const * fieldName(Field field) { return field_names.at(static_cast<size_t>(field)); }
+
+  size_t Comparison::mismatches() const {
+    size_t total = 0;
+    for (FieldError const & field : field_errors) { total += field.mismatches; }
+    return total;
+  }
+
+  Comparison compareFld(std::span<char const> first, std::span<char const> second,
+                        CompareOptions const & options) {
+    Comparison comparison;
+    size_t first_count  = 0;
+    size_t second_count = 0;
+    comparison.error    = fldParticles(first, "first", first_count);
+    if (comparison.error.empty()) {
+      comparison.error = fldParticles(second, "second", second_count);
+    }
+    if (comparison.error.empty() && first_count != second_count) {
+      comparison.error = "different number of particles: " + std::to_string(first_count) +
+                         " and " + std::to_string(second_count);
+    }
+    if (comparison.error.empty() && std::memcmp(first.data(), second.data(), sizeof(float)) != 0) {
+      comparison.error = "different particles per meter";
+    }
+    if (!comparison.error.empty()) { return comparison; }
+    // En un .fld las particulas estan en el orden de entrada, que es su id
+    auto const read = [&](size_t k, std::array<float, fld_values> & first_values,
+                          std::array<float, fld_values> & second_values) {
+      size_t const offset = fld_header + k * fld_record;
+      std::memcpy(first_values.data(), first.data() + offset, fld_record);
+      std::memcpy(second_values.data(), second.data() + offset, fld_record);
+      return static_cast<uint64_t>(k);
+    };
+    return compareParticles<float, fld_values>(first_count, read, options);
+  }
+
+  Comparison compareTrz(std::span<char const> first, std::span<char const> second,
+                        CompareOptions const & options) {
+    Comparison comparison;
+    std::vector<size_t> first_records;
+    std::vector<size_t> second_records;
+    comparison.error = trzRecords(first, "first", first_records);
+    if (comparison.error.empty()) {
+      comparison.error = trzRecords(second, "second", second_records);
+    }
+    if (comparison.error.empty() && first_records.size() != second_records.size()) {
+      comparison.error = "different number of particles: " +
+                         std::to_string(first_records.size()) + " and " +
+                         std::to_string(second_records.size());
+    }
+    if (!comparison.error.empty()) { return comparison; }
+    auto const read = [&](size_t id, std::array<double, trz_values> & first_values,
+                          std::array<double, trz_values> & second_values) {
+      std::memcpy(first_values.data(), first.data() + first_records[id] + sizeof(int64_t),
+                  trz_values * sizeof(double));
+      std::memcpy(second_values.data(), second.data() + second_records[id] + sizeof(int64_t),
+                  trz_values * sizeof(double));
+      return static_cast<uint64_t>(id);
+    };
+    return compareParticles<double, trz_values>(first_records.size(), read, options);
+  }
+
+  Comparison compareFiles(std::string const & first, std::string const & second,
+                          CompareOptions const & options) {
+    auto const check = [](MappedFile const & file, std::string const & filename) {
+      if (!file.good()) {
+        std::cerr << "Error: Cannot open " << filename << " for reading.\n";
+        exit(ERROR_CANNOT_OPEN_INPUT_FILE);
+      }
+    };
+    MappedFile const first_file(first);
+    check(first_file, first);
+    MappedFile const second_file(second);
+    check(second_file, second);
+    std::span<char const> const first_bytes(first_file.data(), first_file.size());
+    std::span<char const> const second_bytes(second_file.data(), second_file.size());
+    if (hasExtension(first, ".trz") && hasExtension(second, ".trz")) {
+      return compareTrz(first_bytes, second_bytes, options);
+    }
+    return compareFld(first_bytes, second_bytes, options);
+  }
+
+  void printComparison(std::ostream & out, Comparison const & comparison) {
+    constexpr int name_width   = 14;
+    constexpr int column_width = 14;
+    out << "Particles: " << comparison.particles << "\n";
+    out << std::left << std::setw(name_width) << "Field" << std::right << std::setw(column_width)
+        << "max abs" << std::setw(column_width) << "max rel" << std::setw(column_width)
+        << "max ULP" << std::setw(column_width) << "mismatches" << "\n";
+    out << std::setprecision(6);
+    for (size_t field = 0; field < comparison.fields; field++) {
+      FieldError const & error = comparison.field_errors.at(field);
+      out << std::left << std::setw(name_width) << field_names.at(field) << std::right
+          << std::setw(column_width) << error.max_absolute << std::setw(column_width)
+          << error.max_relative << std::setw(column_width) << error.max_ulps
+          << std::setw(column_width) << error.mismatches << "\n";
+    }
+    if (!comparison.worst.empty()) {
+      out << "Worst particles:\n";
+      for (ParticleError const & particle : comparison.worst) {
+        out << "  id " << particle.id << ": " << fieldName(particle.field) << ", "
+            << particle.ulps << " ULP (abs " << particle.absolute << ")\n";
+      }
+    }
+    out << "ULP histogram:\n";
+    for (size_t bucket = 0; bucket < histogram_buckets; bucket++) {
+      size_t const values = comparison.histogram.at(bucket);
+      if (values == 0) { continue; }
+      std::string range = std::to_string(bucket);
+      if (bucket > 1) {
+        uint64_t const low = uint64_t{1} << (bucket - 1);
+        range = std::to_string(low) + "-" + std::to_string(low + (low - 1));
+      }
+      out << "  " << std::left << std::setw(name_width - 2) << range << std::right
+          << std::setw(column_width) << values << "\n";
+    }
+  }
+}  // namespace fluids::sim
@@ -0,0 +1,85 @@
+#ifndef COMPARE_HPP
+#define COMPARE_HPP
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <iosfwd>
+#include <span>
+#include <string>
+#include <vector>
+
+namespace fluids::sim {
+  // Dos valores coinciden si son iguales o si cumplen alguna de las tolerancias que no son 0.
+  // Las distancias en ULP se cuentan en la precision del fichero (float en .fld, double en
+  // .trz).
+  struct Tolerance {
+      double absolute = 0;
+      double relative = 0;  // Respecto al mayor de los dos valores absolutos
+      uint64_t ulps   = 0;
+  };
+
+  struct CompareOptions {
+      Tolerance tolerance  = {};
+      unsigned int threads = 1;
+      size_t worst         = 5;  // Particulas con mas error que se anotan
+  };
+
+  // Campos de cada particula: los tres primeros en .fld y .trz, los dos ultimos solo en .trz
+  enum class Field { position, hv, velocity, density, acceleration };
+  constexpr size_t n_fields = 5;
+
+  [[nodiscard]] char const * fieldName(Field field);
+
+  struct FieldError {
+      double max_absolute = 0;
+      double max_relative = 0;
+      uint64_t max_ulps   = 0;
+      size_t values       = 0;  // Valores comparados
+      size_t mismatches   = 0;  // Valores fuera de tolerancia
+  };
+
+  // Error de una particula: el de su valor con mas distancia en ULP
+  struct ParticleError {
+      uint64_t id     = 0;
+      Field field     = Field::position;
+      double absolute = 0;
+      uint64_t ulps   = 0;
+  };
+
+  // Cubos del histograma: 0 ULP, 1 ULP y luego [2^(k-1), 2^k) ULP para k = 2 ... 64
+  constexpr size_t histogram_buckets = 65;
+
+  struct Comparison {
+      // Vacio si los dos ficheros tienen las mismas particulas; si no, por que no se pueden
+      // comparar (y el resto de campos no vale)
+      std::string error;
+      size_t particles = 0;
+      size_t fields    = 0;  // Campos que tiene el formato (3 en .fld, 5 en .trz)
+      std::array<FieldError, n_fields> field_errors{};
+      std::vector<ParticleError> worst;  // De mayor a menor distancia en ULP
+      std::array<size_t, histogram_buckets> histogram{};
+
+      [[nodiscard]] size_t mismatches() const;
+      [[nodiscard]] bool matches() const { return error.empty() && mismatches() == 0; }
+  };
+
+  // Compara dos .fld registro a registro (el orden de entrada es el id de cada particula), o
+  // dos .trz particula a particula por id, aunque esten en otro orden o en otro bloque. La
+  // comparacion se reparte en tramos de particulas entre options.threads hilos y el resultado
+  // no depende de cuantos sean. Termina con ERROR_INVALID_PARTICLE_NUMBER si algun fichero no
+  // tiene el formato esperado (cabecera, registros incompletos o ids repetidos o fuera de rango).
+  [[nodiscard]] Comparison compareFld(std::span<char const> first, std::span<char const> second,
+                                      CompareOptions const & options);
+  [[nodiscard]] Comparison compareTrz(std::span<char const> first, std::span<char const> second,
+                                      CompareOptions const & options);
+
+  // Proyecta los dos ficheros en memoria y los compara segun su extension (.trz o .fld).
+  // Termina con ERROR_CANNOT_OPEN_INPUT_FILE si alguno no se puede abrir.
+  [[nodiscard]] Comparison compareFiles(std::string const & first, std::string const & second,
+                                        CompareOptions const & options);
+
+  void printComparison(std::ostream & out, Comparison const & comparison);
+}  // namespace fluids::sim
+
+#endif  // COMPARE_HPP
@@ -0,0 +1,252 @@
+#include "distributed.hpp"
+
+#include <array>
+#include <chrono>
+#include <cstring>
+#include <iostream>
+
+namespace fluids::sim {
+  namespace {
+    // Lo que pasa de un paso al siguiente: indice original, posicion, hv y velocidad
+    constexpr size_t state_values = 9;
+
+    template <std::floating_point T>
+    constexpr size_t particleBytes() {
+      return sizeof(uint64_t) + state_values * sizeof(T);
+    }
+
+    template <std::floating_point T>
+    void appendParticle(std::vector<char> & bytes, Particles<T> const & particles, size_t i) {
+      size_t const offset = bytes.size();
+      bytes.resize(offset + particleBytes<T>());
+      auto const id                             = static_cast<uint64_t>(particles.id[i]);
+      std::array<T, state_values> const values = {
+        particles.position.x[i],  particles.position.y[i],  particles.position.z[i],
+        particles.hv_vector.x[i], particles.hv_vector.y[i], particles.hv_vector.z[i],
+        particles.speed.x[i],     particles.speed.y[i],     particles.speed.z[i]};
+      std::memcpy(bytes.data() + offset, &id, sizeof(id));
+      std::memcpy(bytes.data() + offset + sizeof(id), values.data(), sizeof(values));
+    }
+
+    template <std::floating_point T>
+    void readParticle(char const * bytes, Particles<T> & particles, size_t i) {
+      uint64_t id = 0;
+      std::array<T, state_values> values{};
+      std::memcpy(&id, bytes, sizeof(id));
+      std::memcpy(values.data(), bytes + sizeof(id), sizeof(values));
+      particles.id[i] = static_cast<size_t>(id);
+      particles.position.set(i, {values[0], values[1], values[2]});
+      particles.hv_vector.set(i, {values[3], values[4], values[5]});
+      particles.speed.set(i, {values[6], values[7], values[8]});
+    }
+
+    // Anade al final de particles todas las particulas de los mensajes recibidos
+    template <std::floating_point T>
+    void appendReceived(std::vector<std::vector<char>> const & incoming, Particles<T> & particles) {
+      size_t received = 0;
+      for (std::vector<char> const & message : incoming) {
+        received += message.size() / particleBytes<T>();
+      }
+      size_t next = particles.size();
+      particles.resize(next + received);
+      for (std::vector<char> const & message : incoming) {
+        for (size_t offset = 0; offset < message.size(); offset += particleBytes<T>()) {
+          readParticle(message.data() + offset, particles, next++);
+        }
+      }
+    }
+  }  // namespace
+
+  template <std::floating_point T>
+  DistributedGrid<T>::DistributedGrid(File<T> & file, Transport & transport,
+                                      SimulationOptions const & options, Scenario const & scenario)
+    : grid(file, options, scenario), transport(transport) {
+    int const ranks = transport.size();
+    int const rank  = transport.rank();
+    // Todos los rangos llegan a los mismos errores; solo el primero los escribe
+    if (ranks > grid.n_blocks_z) {
+      if (rank == 0) {
+        std::cerr << "Error: Cannot split " << grid.n_blocks_z << " blocks along z among "
+                  << ranks << " ranks.\n";
+      }
+      exit(ERROR_INVALID_OPTION);
+    }
+    if (options.verlet_skin > 0 || options.profile || grid.scenario.courant > 0) {
+      if (rank == 0) {
+        std::cerr << "Error: Verlet lists, profiles and adaptive time steps are not supported "
+                     "in distributed mode.\n";
+      }
+      exit(ERROR_INVALID_OPTION);
+    }
+    // Laminas con aproximadamente el mismo numero de particulas al empezar (al menos una capa
+    // cada una): el rango r empieza en la primera capa con r * n / ranks particulas por debajo
+    Particles<T> & particles = grid.file.particles;
+    auto const layers        = static_cast<size_t>(grid.n_blocks_z);
+    std::vector<size_t> below(layers + 1, 0);
+    for (size_t i = 0; i < particles.size(); i++) {
+      below[static_cast<size_t>(blockLayer(i)) + 1]++;
+    }
+    for (size_t z = 0; z < layers; z++) { below[z + 1] += below[z]; }
+    layer_rank.resize(layers);
+    int begin = 0;
+    for (int r = 0; r < ranks; r++) {
+      int end = grid.n_blocks_z - (ranks - r - 1);
+      if (r + 1 < ranks) {
+        size_t const target = particles.size() * static_cast<size_t>(r + 1) /
+                              static_cast<size_t>(ranks);
+        int balanced        = begin + 1;
+        while (balanced < end && below[static_cast<size_t>(balanced)] < target) { balanced++; }
+        end = balanced;
+      }
+      for (int z = begin; z < end; z++) { layer_rank[static_cast<size_t>(z)] = r; }
+      if (r == rank) {
+        z_begin = begin;
+        z_end   = end;
+      }
+      begin = end;
+    }
+    outgoing.resize(static_cast<size_t>(ranks));
+    incoming.resize(static_cast<size_t>(ranks));
+    // Cada rango se queda solo con las particulas de su lamina
+    kept.clear();
+    for (size_t i = 0; i < particles.size(); i++) {
+      int const z = blockLayer(i);
+      if (z >= z_begin && z < z_end) { kept.push_back(i); }
+    }
+    particles.reorder(kept, buffer, id_buffer);
+    particles.resize(kept.size());
+  }
+
+  // Capa en z del bloque que corresponde a la posicion de la particula
+  template <std::floating_point T>
+  int DistributedGrid<T>::blockLayer(size_t particle) const {
+    return grid.blocks[grid.linearBlockIndex(grid.file.particles.position[particle])].z;
+  }
+
+  template <std::floating_point T>
+  void DistributedGrid<T>::makeSimulation() {
+    exchangeParticles();
+    grid.beginStep();
+    exchangeDensities();
+    grid.finishStep();
+    dropGhosts();
+  }
+
+  template <std::floating_point T>
+  void DistributedGrid<T>::exchange() {
+    for (std::vector<char> const & message : outgoing) { bytes_sent += message.size(); }
+    auto const start = std::chrono::steady_clock::now();
+    transport.exchange(outgoing, incoming);
+    exchange_seconds +=
+        std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    for (std::vector<char> & message : outgoing) { message.clear(); }
+  }
+
+  // Cada particula va a su rango como propia y, si esta en el borde de su lamina, a los
+  // rangos vecinos como fantasma. Las que se quedan (propias o fantasmas de este rango) se
+  // compactan al principio y las recibidas se anaden detras; sortParticles las coloca.
+  template <std::floating_point T>
+  void DistributedGrid<T>::exchangeParticles() {
+    Particles<T> & particles = grid.file.particles;
+    int const rank           = transport.rank();
+    auto const last_layer    = static_cast<int>(layer_rank.size()) - 1;
+    size_t stay              = 0;
+    for (size_t i = 0; i < particles.size(); i++) {
+      int const z      = blockLayer(i);
+      int const owner  = layer_rank[static_cast<size_t>(z)];
+      int const below  = z > 0 ? layer_rank[static_cast<size_t>(z - 1)] : owner;
+      int const above  = z < last_layer ? layer_rank[static_cast<size_t>(z + 1)] : owner;
+      auto const send  = [&](int destination) {
+        appendParticle(outgoing[static_cast<size_t>(destination)], particles, i);
+      };
+      if (owner != rank) { send(owner); }
+      if (below != owner && below != rank) { send(below); }
+      if (above != owner && above != rank) { send(above); }
+      // Las laminas son consecutivas: below y above solo coinciden si son owner
+      if (owner != rank && below != rank && above != rank) { continue; }
+      if (stay != i) {
+        particles.id[stay] = particles.id[i];
+        particles.position.set(stay, particles.position[i]);
+        particles.hv_vector.set(stay, particles.hv_vector[i]);
+        particles.speed.set(stay, particles.speed[i]);
+      }
+      stay++;
+    }
+    particles.resize(stay);
+    exchange();
+    appendReceived(incoming, particles);
+  }
+
+  // Densidades transformadas de la primera y la ultima capa propia para los fantasmas de los
+  // vecinos. Los dos rangos recorren los bloques de la capa en el orden de active_blocks y
+  // las particulas de cada bloque estan ordenadas por indice original, asi que coinciden una
+  // a una.
+  template <std::floating_point T>
+  void DistributedGrid<T>::exchangeDensities() {
+    int const rank           = transport.rank();
+    int const ranks          = transport.size();
+    std::vector<T> & density = grid.file.particles.density;
+    auto const append_layer  = [&](int layer, std::vector<char> & message) {
+      for (size_t const block_i : grid.active_blocks) {
+        Block const & block = grid.blocks[block_i];
+        if (block.z != layer || block.size() == 0) { continue; }
+        size_t const offset = message.size();
+        size_t const bytes  = block.size() * sizeof(T);
+        message.resize(offset + bytes);
+        std::memcpy(message.data() + offset, density.data() + block.begin, bytes);
+      }
+    };
+    auto const read_layer = [&](int layer, std::vector<char> const & message) {
+      size_t offset = 0;
+      bool matches  = true;
+      for (size_t const block_i : grid.active_blocks) {
+        Block const & block = grid.blocks[block_i];
+        if (block.z != layer || block.size() == 0) { continue; }
+        size_t const bytes = block.size() * sizeof(T);
+        if (offset + bytes > message.size()) {
+          matches = false;
+          break;
+        }
+        std::memcpy(density.data() + block.begin, message.data() + offset, bytes);
+        offset += bytes;
+      }
+      if (!matches || offset != message.size()) {
+        std::cerr << "Error: Transport: ghost layer " << layer << " does not match.\n";
+        exit(ERROR_TRANSPORT);
+      }
+    };
+    if (rank > 0) { append_layer(z_begin, outgoing[static_cast<size_t>(rank - 1)]); }
+    if (rank + 1 < ranks) { append_layer(z_end - 1, outgoing[static_cast<size_t>(rank + 1)]); }
+    exchange();
+    if (rank > 0) { read_layer(z_begin - 1, incoming[static_cast<size_t>(rank - 1)]); }
+    if (rank + 1 < ranks) { read_layer(z_end, incoming[static_cast<size_t>(rank + 1)]); }
+  }
+
+  template <std::floating_point T>
+  void DistributedGrid<T>::dropGhosts() {
+    kept.clear();
+    for (size_t const block_i : grid.active_blocks) {
+      Block const & block = grid.blocks[block_i];
+      if (block.z < z_begin || block.z >= z_end) { continue; }
+      for (size_t i = block.begin; i < block.end; i++) { kept.push_back(i); }
+    }
+    Particles<T> & particles = grid.file.particles;
+    if (kept.size() == particles.size()) { return; }
+    particles.reorder(kept, buffer, id_buffer);
+    particles.resize(kept.size());
+  }
+
+  template <std::floating_point T>
+  void DistributedGrid<T>::gather() {
+    Particles<T> & particles = grid.file.particles;
+    if (transport.rank() != 0) {
+      for (size_t i = 0; i < particles.size(); i++) { appendParticle(outgoing[0], particles, i); }
+      particles.resize(0);
+    }
+    exchange();
+    appendReceived(incoming, particles);
+  }
+
+  template class DistributedGrid<float>;
+  template class DistributedGrid<double>;
+}  // namespace fluids::sim
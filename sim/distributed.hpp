@@ -0,0 +1,69 @@
+#ifndef DISTRIBUTED_HPP
+#define DISTRIBUTED_HPP
+
+#include "grid.hpp"
+#include "options.hpp"
+#include "transport.hpp"
+#include "utils.hpp"
+
+#include <concepts>
+#include <cstdint>
+#include <vector>
+
+namespace fluids::sim {
+  // Simulacion repartida entre los rangos de un Transport. Los bloques se dividen a lo largo
+  // de z en laminas consecutivas, una por rango y con parecido numero de particulas al
+  // empezar, y cada rango guarda solo las particulas de la suya mas una capa de un bloque de
+  // fantasmas a cada lado (las de los bloques vecinos de otros rangos). La rejilla (bloques,
+  // paredes, orden) es la de siempre en todos los rangos.
+  //
+  // En cada paso:
+  //  1. Las particulas que han salido de la lamina pasan a su nuevo rango, y las de los
+  //     bloques del borde se copian como fantasmas a los rangos vecinos (un solo intercambio).
+  //  2. Grid::beginStep calcula las densidades. Las de las particulas propias estan completas,
+  //     porque todos sus vecinos son propios o fantasmas; las de los fantasmas no.
+  //  3. Cada rango envia a sus vecinos las densidades de su borde, que sustituyen a las de los
+  //     fantasmas.
+  //  4. Grid::finishStep calcula aceleraciones, colisiones, integracion e interacciones, y se
+  //     descartan los fantasmas.
+  // Las particulas de cada bloque se ordenan por indice original igual que en un solo
+  // proceso, y las parejas de cada particula propia se recorren en el mismo orden, asi que el
+  // resultado es el mismo, bit a bit, que el de una Grid con las mismas opciones.
+  template <std::floating_point T>
+  class DistributedGrid {
+    public:
+      // file tiene todas las particulas; cada rango se queda con las de su lamina. Termina el
+      // programa con ERROR_INVALID_OPTION si hay mas rangos que bloques en z o si las opciones
+      // no se pueden repartir (listas de Verlet, perfil o paso adaptativo).
+      DistributedGrid(File<T> & file, Transport & transport, SimulationOptions const & options = {},
+                      Scenario const & scenario = {});
+
+      void makeSimulation();
+      // Reune todas las particulas en grid del rango 0 (el resto se queda sin ninguna) para
+      // escribir la salida con grid.writeSimulation. Despues ya no se puede seguir simulando.
+      void gather();
+
+      Grid<T> grid;  // Particulas propias (y, durante el paso, los fantasmas)
+      Transport & transport;
+      int z_begin;                  // Lamina propia: bloques con z en [z_begin, z_end)
+      int z_end;
+      std::vector<int> layer_rank;  // Rango de cada capa de bloques en z
+      uint64_t bytes_sent     = 0;  // Bytes enviados por este rango
+      double exchange_seconds = 0;  // Tiempo dentro de transport.exchange
+
+    private:
+      [[nodiscard]] int blockLayer(size_t particle) const;
+      void exchange();
+      void exchangeParticles();
+      void exchangeDensities();
+      void dropGhosts();
+
+      std::vector<std::vector<char>> outgoing;
+      std::vector<std::vector<char>> incoming;
+      std::vector<size_t> kept;  // Memoria de trabajo de dropGhosts
+      std::vector<T> buffer;
+      std::vector<size_t> id_buffer;
+  };
+}  // namespace fluids::sim
+
+#endif  // DISTRIBUTED_HPP
@@ -0,0 +1,118 @@
+#include "fluids.h"
+
+#include "scenario.hpp"
+#include "simulation.hpp"
+#include "utils.hpp"
+
+#include <array>
+#include <cstring>
+#include <exception>
+#include <span>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+
+using fluids::sim::Scenario;
+using fluids::sim::SimulationOptions;
+using Simulation = fluids::sim::Simulation<double>;
+
+// El tipo opaco de la interfaz C es la propia Simulation
+struct fluids_simulation : Simulation {
+    using Simulation::Simulation;
+};
+
+namespace {
+  // Mensaje de fluids_last_error, de tamaño fijo para que guardarlo no pueda lanzar
+  constexpr size_t error_size = 256;
+  thread_local std::array<char, error_size> last_error = {};
+
+  void setError(char const * message) noexcept {
+    std::strncpy(last_error.data(), message, last_error.size() - 1);
+  }
+
+  // Devuelve body(), o failure si lanza una excepcion (con su mensaje en last_error): ninguna
+  // excepcion puede cruzar la interfaz C
+  template <typename Result, typename Body>
+  Result guarded(Result failure, Body const & body) noexcept {
+    last_error[0] = '\0';
+    try {
+      return body();
+    } catch (std::exception const & error) {
+      setError(error.what());
+    } catch (...) {
+      setError("Unknown error");
+    }
+    return failure;
+  }
+}  // namespace
+
+extern "C" {
+  fluids_simulation * fluids_create(double particles_per_meter, size_t n_particles,
+                                    double const * position, double const * hv_vector,
+                                    double const * speed, unsigned int threads,
+                                    char const * scenario_file) noexcept {
+    return guarded<fluids_simulation *>(nullptr, [&]() {
+      if (particles_per_meter <= 0 || n_particles == 0 || position == nullptr ||
+          hv_vector == nullptr || speed == nullptr || threads == 0) {
+        throw std::invalid_argument("Invalid arguments");
+      }
+      Scenario scenario;
+      std::ostringstream errors;
+      if (scenario_file != nullptr &&
+          fluids::sim::readScenario(scenario_file, scenario, errors) != 0) {
+        std::string const message = errors.str();
+        throw std::invalid_argument(message.substr(0, message.find('\n')));
+      }
+      size_t const values = 3 * n_particles;
+      return new fluids_simulation(particles_per_meter, std::span(position, values),
+                                   std::span(hv_vector, values), std::span(speed, values),
+                                   SimulationOptions{.threads = threads, .verbose = false},
+                                   scenario);
+    });
+  }
+
+  void fluids_destroy(fluids_simulation * simulation) noexcept { delete simulation; }
+
+  int fluids_step(fluids_simulation * simulation, int64_t steps) noexcept {
+    return guarded(ERROR_SIMULATION_FAILED, [&]() {
+      simulation->step(steps);
+      return 0;
+    });
+  }
+
+  size_t fluids_size(fluids_simulation const * simulation) noexcept { return simulation->size(); }
+
+  double fluids_time(fluids_simulation const * simulation) noexcept { return simulation->time(); }
+
+  void fluids_positions(fluids_simulation const * simulation, double const ** x,
+                        double const ** y, double const ** z) noexcept {
+    fluids::sim::ParticleSpans<double> const spans = simulation->positions();
+    *x                                             = spans.x.data();
+    *y                                             = spans.y.data();
+    *z                                             = spans.z.data();
+  }
+
+  void fluids_velocities(fluids_simulation const * simulation, double const ** x,
+                         double const ** y, double const ** z) noexcept {
+    fluids::sim::ParticleSpans<double> const spans = simulation->velocities();
+    *x                                             = spans.x.data();
+    *y                                             = spans.y.data();
+    *z                                             = spans.z.data();
+  }
+
+  size_t const * fluids_ids(fluids_simulation const * simulation) noexcept {
+    return simulation->ids().data();
+  }
+
+  int fluids_write(fluids_simulation * simulation, char const * filename) noexcept {
+    return guarded(ERROR_SIMULATION_FAILED, [&]() {
+      if (!simulation->write(filename)) {
+        setError(("Cannot open " + std::string(filename) + " for writing").c_str());
+        return ERROR_CANNOT_OPEN_OUTPUT_FILE;
+      }
+      return 0;
+    });
+  }
+
+  char const * fluids_last_error() noexcept { return last_error.data(); }
+}
@@ -0,0 +1,66 @@
+#ifndef FLUIDS_H
+#define FLUIDS_H
+
+// Interfaz C de Simulation<double> (sim/simulation.hpp) en la biblioteca compartida libfluids,
+// para usar la simulacion desde C u otros lenguajes sin pasar por ficheros. Ninguna funcion
+// lanza excepciones ni termina el programa: los errores se devuelven como NULL o como un codigo
+// distinto de 0, y fluids_last_error da el mensaje.
+
+#include <stddef.h>
+#include <stdint.h>
+
+#if defined(__GNUC__)
+  #define FLUIDS_API __attribute__((visibility("default")))
+#else
+  #define FLUIDS_API
+#endif
+
+#ifdef __cplusplus
+  #define FLUIDS_NOEXCEPT noexcept
+#else
+  #define FLUIDS_NOEXCEPT
+#endif
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef struct fluids_simulation fluids_simulation;
+
+// Copia n_particles particulas de arrays con x, y, z seguidos por particula (como en los
+// .fld). scenario_file es un fichero de escenario (ver --scenario) o NULL para los valores por
+// defecto. Devuelve NULL si algun argumento o el escenario no son validos o si no hay memoria.
+FLUIDS_API fluids_simulation * fluids_create(double particles_per_meter, size_t n_particles,
+                                             double const * position, double const * hv_vector,
+                                             double const * speed, unsigned int threads,
+                                             char const * scenario_file) FLUIDS_NOEXCEPT;
+FLUIDS_API void fluids_destroy(fluids_simulation * simulation) FLUIDS_NOEXCEPT;
+
+// Devuelve 0, o -10 si la simulacion no puede continuar (por ejemplo, sin memoria). Tras un
+// error la simulacion queda a medio paso y solo se puede destruir.
+FLUIDS_API int fluids_step(fluids_simulation * simulation, int64_t steps) FLUIDS_NOEXCEPT;
+FLUIDS_API size_t fluids_size(fluids_simulation const * simulation) FLUIDS_NOEXCEPT;
+FLUIDS_API double fluids_time(fluids_simulation const * simulation) FLUIDS_NOEXCEPT;
+
+// Arrays de fluids_size elementos sobre la memoria de la simulacion, sin copiarlos. Valen hasta
+// el siguiente fluids_step: las particulas se reordenan en cada paso y fluids_ids da el indice
+// original (el de fluids_create) de cada posicion.
+FLUIDS_API void fluids_positions(fluids_simulation const * simulation, double const ** x,
+                                 double const ** y, double const ** z) FLUIDS_NOEXCEPT;
+FLUIDS_API void fluids_velocities(fluids_simulation const * simulation, double const ** x,
+                                  double const ** y, double const ** z) FLUIDS_NOEXCEPT;
+FLUIDS_API size_t const * fluids_ids(fluids_simulation const * simulation) FLUIDS_NOEXCEPT;
+
+// Escribe el estado actual como un .fld. Devuelve 0, -4 (el codigo de fluidapp) si no se
+// puede escribir o -10 si falla otra cosa (por ejemplo, sin memoria).
+FLUIDS_API int fluids_write(fluids_simulation * simulation, char const * filename) FLUIDS_NOEXCEPT;
+
+// Mensaje del ultimo error de fluids_create, fluids_step o fluids_write en este hilo, o "" si
+// la ultima llamada a una de ellas no fallo. Vale hasta la siguiente llamada.
+FLUIDS_API char const * fluids_last_error(void) FLUIDS_NOEXCEPT;
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif  // FLUIDS_H
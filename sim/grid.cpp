@@ -1,12 +1,20 @@
 #include "grid.hpp"
 
 #include "block.hpp"
+#include "block_order.hpp"
+#include "kernels.hpp"
+#include "mapped_file.hpp"
 #include "utils.hpp"
+#include "writer.hpp"
 
+#include <algorithm>
+#include <array>
 #include <cmath>
+#include <cstring>
 #include <fstream>
 #include <iostream>
 #include <string>
+#include <utility>
 
 namespace fluids::sim {
   template <typename T>
@@ -37,22 +45,102 @@ namespace fluids::sim {
     os.write(as_buffer(value), sizeof(value));
   }
 
-  Particle getParticle(std::ifstream & infile) {
-    struct Particle particle;
-    particle.position.x  = static_cast<double>(read_binary_value<float>(infile));
-    particle.position.y  = static_cast<double>(read_binary_value<float>(infile));
-    particle.position.z  = static_cast<double>(read_binary_value<float>(infile));
-    particle.hv_vector.x = static_cast<double>(read_binary_value<float>(infile));
-    particle.hv_vector.y = static_cast<double>(read_binary_value<float>(infile));
-    particle.hv_vector.z = static_cast<double>(read_binary_value<float>(infile));
-    particle.speed.x     = static_cast<double>(read_binary_value<float>(infile));
-    particle.speed.y     = static_cast<double>(read_binary_value<float>(infile));
-    particle.speed.z     = static_cast<double>(read_binary_value<float>(infile));
+  template <std::floating_point T>
+  Particle<T> getParticle(std::ifstream & infile) {
+    Particle<T> particle;
+    particle.position.x  = static_cast<T>(read_binary_value<float>(infile));
+    particle.position.y  = static_cast<T>(read_binary_value<float>(infile));
+    particle.position.z  = static_cast<T>(read_binary_value<float>(infile));
+    particle.hv_vector.x = static_cast<T>(read_binary_value<float>(infile));
+    particle.hv_vector.y = static_cast<T>(read_binary_value<float>(infile));
+    particle.hv_vector.z = static_cast<T>(read_binary_value<float>(infile));
+    particle.speed.x     = static_cast<T>(read_binary_value<float>(infile));
+    particle.speed.y     = static_cast<T>(read_binary_value<float>(infile));
+    particle.speed.z     = static_cast<T>(read_binary_value<float>(infile));
     return particle;
   }
 
-  File readFile(std::string & filename) {
-    struct File file;
+  namespace {
+    // Cabecera (particles_per_meter y numero de particulas) y registro de cada particula en un .fld
+    constexpr size_t header_size   = sizeof(float) + sizeof(int);
+    constexpr size_t record_floats = 9;
+    constexpr size_t record_size   = record_floats * sizeof(float);
+
+    // Con un solo bloque en el eje, sus particulas solo chocan con la pared de bmin
+    uint8_t blockWalls(int position, int n_blocks, uint8_t low, uint8_t high) {
+      if (position == 0) { return low; }
+      return position == n_blocks - 1 ? high : 0;
+    }
+
+    // Componente Axis (0 = x, 1 = y, 2 = z) de un Vector3D o de un Vector3DArray
+    template <int Axis, typename Vector>
+    auto & component(Vector & vector) {
+      if constexpr (Axis == 0) { return vector.x; }
+      if constexpr (Axis == 1) { return vector.y; }
+      if constexpr (Axis == 2) { return vector.z; }
+    }
+
+    template <int Axis, bool Low>
+    constexpr uint8_t wall_bit = static_cast<uint8_t>(1U << (2U * Axis + (Low ? 0U : 1U)));
+  }  // namespace
+
+  // Se comprueban la cabecera y el tamaño del fichero antes de convertir nada. Los registros
+  // se copian de uno en uno a la pila y se reparten por los arrays de Particles en una sola
+  // pasada, sin llamadas por campo.
+  template <std::floating_point T>
+  File<T> readFile(std::string & filename) {
+    MappedFile const input(filename);
+    if (!input.good()) {
+      std::cerr << "Error: Cannot open " << filename << " for reading.\n";
+      exit(ERROR_CANNOT_OPEN_INPUT_FILE);
+    }
+    return parseFile<T>({input.data(), input.size()}, filename);
+  }
+
+  template <std::floating_point T>
+  File<T> parseFile(std::span<char const> input, std::string const & filename) {
+    float particles_per_meter = 0;
+    int number_particles      = 0;
+    if (input.size() >= header_size) {
+      std::memcpy(&particles_per_meter, input.data(), sizeof(particles_per_meter));
+      std::memcpy(&number_particles, input.data() + sizeof(particles_per_meter),
+                  sizeof(number_particles));
+    }
+    if (number_particles <= 0) {
+      std::cerr << "Error: Invalid number of particles: " << number_particles << '\n';
+      exit(ERROR_INVALID_PARTICLE_NUMBER);
+    }
+    size_t const found = (input.size() - header_size) / record_size;
+    if (found != static_cast<size_t>(number_particles)) {
+      std::cerr << "Error: Number of particles mismatch. Header: " << number_particles
+                << ", Found: " << found << '\n';
+      exit(ERROR_INVALID_PARTICLE_NUMBER);
+    }
+    if ((input.size() - header_size) % record_size != 0) {
+      std::cerr << "Error: Truncated particle record in " << filename << '\n';
+      exit(ERROR_INVALID_PARTICLE_NUMBER);
+    }
+
+    File<T> file;
+    file.particles_per_meter = static_cast<T>(particles_per_meter);
+    Particles<T> & particles = file.particles;
+    particles.resize(found);
+    std::array<T *, record_floats> const fields = {
+      particles.position.x.data(),  particles.position.y.data(),  particles.position.z.data(),
+      particles.hv_vector.x.data(), particles.hv_vector.y.data(), particles.hv_vector.z.data(),
+      particles.speed.x.data(),     particles.speed.y.data(),     particles.speed.z.data()};
+    char const * records = input.data() + header_size;
+    for (size_t i = 0; i < found; i++) {
+      std::array<float, record_floats> record{};
+      std::memcpy(record.data(), records + i * record_size, record_size);
+      for (size_t k = 0; k < record_floats; k++) { fields[k][i] = static_cast<T>(record[k]); }
+    }
+    return file;
+  }
+
+  template <std::floating_point T>
+  File<T> readFileStream(std::string & filename) {
+    File<T> file;
     std::ifstream infile(filename);
     auto particles_per_meter   = read_binary_value<float>(infile);
     int const number_particles = read_binary_value<int>(infile);
@@ -60,11 +148,12 @@ namespace fluids::sim {
       std::cerr << "Error: Invalid number of particles: " << number_particles << '\n';
       exit(ERROR_INVALID_PARTICLE_NUMBER);
     }
-    file.particles_per_meter = static_cast<double>(particles_per_meter);
+    file.particles_per_meter = static_cast<T>(particles_per_meter);
     file.particles.resize(number_particles);
     int count = 0;
     while (infile.peek() != EOF) {
-      file.particles[count] = getParticle(infile);  // Para cargar menos en cache
+      Particle<T> const particle = getParticle<T>(infile);  // Para cargar menos en cache
+      if (count < number_particles) { file.particles.set(count, particle); }
       count++;
     }
     if (count != number_particles) {
@@ -76,41 +165,160 @@ namespace fluids::sim {
     return file;
   }
 
-  void Grid::generateBlocks() {
-    for (int i = 0; i < n_blocks_x * n_blocks_y * n_blocks_z; i++) {
+  template <std::floating_point T>
+  void Grid<T>::generateBlocks() {
+    std::vector<size_t> const traversal =
+        blockTraversal(block_order, n_blocks_x, n_blocks_y, n_blocks_z);
+    if (block_order != BlockOrder::linear) { block_slot.resize(traversal.size()); }
+    for (size_t const linear : traversal) {
+      int const i    = static_cast<int>(linear);
       int const posx = i % n_blocks_x;
       int const posy = (i / n_blocks_x) % n_blocks_y;
       int const posz = (i / (n_blocks_x * n_blocks_y)) % n_blocks_z;
-      Block const block(posx, posy, posz);
+      if (!block_slot.empty()) { block_slot[linear] = blocks.size(); }
+      Block block(posx, posy, posz);
+      block.walls = static_cast<uint8_t>(
+          blockWalls(posx, n_blocks_x, Block::wall_x_min, Block::wall_x_max) |
+          blockWalls(posy, n_blocks_y, Block::wall_y_min, Block::wall_y_max) |
+          blockWalls(posz, n_blocks_z, Block::wall_z_min, Block::wall_z_max));
+      if (block.walls != 0) { wall_blocks.push_back(blocks.size()); }
       blocks.push_back(block);
     }
+    // Los bloques con las mismas paredes (cada cara, arista y esquina) quedan seguidos
+    std::ranges::stable_sort(wall_blocks, {},
+                             [&](size_t block_i) { return blocks[block_i].walls; });
+  }
+
+  // Anade los vecinos de block_i al final de las tablas, anota su posicion en el bloque y
+  // lo pone en su color
+  template <std::floating_point T>
+  void Grid<T>::addNeighbours(size_t block_i) {
+    Block & block    = blocks[block_i];
+    block.neighbours = static_cast<uint32_t>(neighbour_begin.size() - 1);
+    int const period = 2 * verlet_reach + 1;
+    block_colors[static_cast<size_t>(block.x % period + period * (block.y % period) +
+                                     period * period * (block.z % period))]
+        .push_back(block_i);
+    // Con verlet_reach > 1 se descartan los bloques que no tienen ningun punto a menos del
+    // radio de la lista del bloque propio (las esquinas de la plantilla)
+    T const cutoff = smoothing_lenght + verlet_skin;
+    auto const gap = [](int offset, T size) {
+      return static_cast<T>(std::max(std::abs(offset) - 1, 0)) * size;
+    };
+    for (int i = -verlet_reach; i <= verlet_reach; i++) {
+      for (int j = -verlet_reach; j <= verlet_reach; j++) {
+        for (int k = -verlet_reach; k <= verlet_reach; k++) {
+          int const posx = block.x + i;
+          int const posy = block.y + j;
+          int const posz = block.z + k;
+          if (posx < 0 || posx > n_blocks_x - 1 || posy < 0 || posy > n_blocks_y - 1 ||
+              posz < 0 || posz > n_blocks_z - 1) {
+            continue;
+          }
+          Vector3D<T> const distance(gap(i, block_size.x), gap(j, block_size.y),
+                                     gap(k, block_size.z));
+          if (distance.dot(distance) >= cutoff * cutoff) { continue; }
+          size_t const block_j = blockSlot(
+              static_cast<size_t>(posx + posy * n_blocks_x + posz * n_blocks_x * n_blocks_y));
+          if (block_j >= block_i) { neighbour_blocks.push_back(block_j); }
+        }
+      }
+    }
+    neighbour_begin.push_back(neighbour_blocks.size());
+
+    sorted_neighbours.assign(
+        neighbour_blocks.begin() + static_cast<std::ptrdiff_t>(neighbour_begin[block.neighbours]),
+        neighbour_blocks.end());
+    std::sort(sorted_neighbours.begin(), sorted_neighbours.end());
+    for (size_t const block_j : sorted_neighbours) {
+      if (neighbour_runs.size() > neighbour_run_begin.back() &&
+          neighbour_runs.back().second + 1 == block_j) {
+        neighbour_runs.back().second = block_j;
+      } else {
+        neighbour_runs.emplace_back(block_j, block_j);
+      }
+    }
+    neighbour_run_begin.push_back(neighbour_runs.size());
   }
 
-  Grid::Grid(struct File & file)
-    : file(file),                                                         // file
-      mass(fluid_density / pow(file.particles_per_meter, 3)),             // particle mass
-      smoothing_lenght(radius_multiplicator / file.particles_per_meter),  // smoothing length
-      smoothing_6(pow(smoothing_lenght, six)),  // smoothing length to the power of 6
-      smoothing_6_pi_15(fifteen / (pow(smoothing_lenght, six) * M_PI)),
-      smoothing_6_pi(pow(smoothing_lenght, six) * M_PI),
-      smoothing_9(pow(smoothing_lenght, nine)), smoothing_2(pow(smoothing_lenght, 2)),
-      pressure_rigdity_3(3 * pressure_rigidity),
-      viscosity_45(forty_five * viscosity), fluid_density_2(2 * fluid_density), time_2(time_increase / 2),
-      time_squared(pow(time_increase, 2)),
-      density_transformation_constant((three_fifteen * mass) / (sixty_four * M_PI * smoothing_9)),
-      viscosity_mass_h6_pi((viscosity_45 * mass) / (smoothing_6_pi)),
-      mass_pressure((mass * pressure_rigdity_3) / 2) {
-    Vector3D const bdist = bmax - bmin;
+  // Cada constante derivada se calcula en double (a partir de las anteriores) y se redondea a T
+  template <std::floating_point T>
+  void Grid<T>::setConstants() {
+    mass               = static_cast<T>(scenario.fluid_density / pow(file.particles_per_meter, 3));
+    smoothing_lenght   = static_cast<T>(scenario.radius_multiplicator / file.particles_per_meter);
+    smoothing_6        = static_cast<T>(pow(smoothing_lenght, six));  // smoothing length ^ 6
+    smoothing_6_pi_15  = static_cast<T>(fifteen / (pow(smoothing_lenght, six) * M_PI));
+    smoothing_6_pi     = static_cast<T>(pow(smoothing_lenght, six) * M_PI);
+    smoothing_9        = static_cast<T>(pow(smoothing_lenght, nine));
+    smoothing_2        = static_cast<T>(pow(smoothing_lenght, 2));
+    pressure_rigdity_3 = static_cast<T>(3 * scenario.pressure_rigidity);
+    viscosity_45       = static_cast<T>(forty_five * scenario.viscosity);
+    fluid_density_2    = static_cast<T>(2 * scenario.fluid_density);
+    density_transformation_constant =
+        static_cast<T>((three_fifteen * mass) / (sixty_four * M_PI * smoothing_9));
+    viscosity_mass_h6_pi = static_cast<T>((viscosity_45 * mass) / (smoothing_6_pi));
+    mass_pressure        = static_cast<T>((mass * pressure_rigdity_3) / 2);
+    physics              = PhysicalConstants<T>(scenario);
+    kernel_constants     = {.smoothing_lenght     = smoothing_lenght,
+                            .smoothing_2          = smoothing_2,
+                            .smoothing_6_pi_15    = smoothing_6_pi_15,
+                            .mass_pressure        = mass_pressure,
+                            .fluid_density_2      = fluid_density_2,
+                            .viscosity_mass_h6_pi = viscosity_mass_h6_pi,
+                            .max_distance         = physics.max_distance};
+    setTimeStep(scenario.time_increase);
+  }
+
+  // La misma longitud de suavizado que setConstants, para que coincida con floor(bdist / h)
+  template <std::floating_point T>
+  bool Grid<T>::fitsBox(T particles_per_meter, Scenario const & scenario) {
+    Vector3D<double> const bdist = scenario.bmax - scenario.bmin;
+    T const smoothing = static_cast<T>(scenario.radius_multiplicator / particles_per_meter);
+    return std::min({bdist.x, bdist.y, bdist.z}) / smoothing >= 1;
+  }
+
+  template <std::floating_point T>
+  Grid<T>::Grid(File<T> & file, SimulationOptions const & options, Scenario const & scenario)
+    : Grid(File<T>(file), options, scenario) { }
+
+  template <std::floating_point T>
+  Grid<T>::Grid(File<T> && input, SimulationOptions const & options, Scenario const & scenario)
+    : file(std::move(input)), scenario(scenario), options(options) {
+    setConstants();
+    if (!fitsBox(file.particles_per_meter, scenario)) {
+      std::cerr << "Error: The box must be at least one smoothing length (" << smoothing_lenght
+                << ") wide on every axis.\n";
+      exit(ERROR_INVALID_SCENARIO);
+    }
+    Vector3D<double> const bdist = scenario.bmax - scenario.bmin;
 
     n_blocks_x = floor(bdist.x / smoothing_lenght);  // grid size
     n_blocks_y = floor(bdist.y / smoothing_lenght);
     n_blocks_z = floor(bdist.z / smoothing_lenght);
 
-    block_size.x = bdist.x / n_blocks_x;  // block size
-    block_size.y = bdist.y / n_blocks_y;
-    block_size.z = bdist.z / n_blocks_z;
+    block_size.x = static_cast<T>(bdist.x / n_blocks_x);  // block size
+    block_size.y = static_cast<T>(bdist.y / n_blocks_y);
+    block_size.z = static_cast<T>(bdist.z / n_blocks_z);
 
+    if (options.verlet_skin > 0) {
+      verlet_skin            = static_cast<T>(options.verlet_skin * smoothing_lenght);
+      T const smallest_block = std::min({block_size.x, block_size.y, block_size.z});
+      verlet_reach = static_cast<int>(std::ceil((smoothing_lenght + verlet_skin) / smallest_block));
+    }
+
+    block_order = options.block_order;
+    // Los bloques activos, sus vecinos y sus colores se anotan al ordenar las particulas
     generateBlocks();
+    resetTime();
+    int const period = 2 * verlet_reach + 1;
+    block_colors.resize(static_cast<size_t>(period * period * period));
+    pool             = std::make_unique<ThreadPool>(options.threads);
+    kernel           = selectKernel(options.kernel);
+    write_mode       = options.write;
+    fused            = options.fused;
+    use_pair_cache   = options.pair_cache;
+    if (options.profile) { profiler = std::make_unique<Profiler>(); }
+    if (!options.verbose) { return; }
 
     std::cout << "Number of particles: " << file.particles.size() << "\n";
     std::cout << "Particles per meter: " << file.particles_per_meter << "\n";
@@ -120,13 +328,108 @@ namespace fluids::sim {
     std::cout << "Number of blocks: " << blocks.size() << "\n";
     std::cout << "Block size: " << block_size.x << " x " << block_size.y << " x " << block_size.z
               << "\n";
+    std::cout << "Threads: " << pool->size() << "\n";
+    std::cout << "Kernel: " << kernelName(kernel) << "\n";
+    if (block_order != BlockOrder::linear) {
+      std::cout << "Block order: " << blockOrderName(block_order) << "\n";
+    }
+    if (verlet_skin > 0) { std::cout << "Verlet skin: " << verlet_skin << "\n"; }
+    if (use_pair_cache) { std::cout << "Pair cache: on\n"; }
   }
 
-  [[nodiscard]] Vector3D Grid::blockIndex(struct Particle particle) const {
-    Vector3D bindex(0, 0, 0);
-    bindex.x = static_cast<double>(floor((particle.position.x - bmin.x) / block_size.x));
-    bindex.y = static_cast<double>(floor((particle.position.y - bmin.y) / block_size.y));
-    bindex.z = static_cast<double>(floor((particle.position.z - bmin.z) / block_size.z));
+  template <std::floating_point T>
+  bool Grid<T>::reusable(File<T> const & next, SimulationOptions const & next_options,
+                         Scenario const & next_scenario) const {
+    return next.particles_per_meter == file.particles_per_meter && next_options == options &&
+           next_scenario.radius_multiplicator == scenario.radius_multiplicator &&
+           next_scenario.bmin == scenario.bmin && next_scenario.bmax == scenario.bmax;
+  }
+
+  // Los bloques, sus tablas de vecinos y colores y la memoria de trabajo solo dependen de la
+  // rejilla, que no cambia; las particulas se copian sobre los arrays que ya hay
+  template <std::floating_point T>
+  void Grid<T>::load(File<T> const & next, Scenario const & next_scenario) {
+    file.particles = next.particles;
+    scenario       = next_scenario;
+    setConstants();
+    resetTime();
+    verlet_begin.clear();
+    if (profiler) { profiler = std::make_unique<Profiler>(); }
+  }
+
+  template <std::floating_point T>
+  void Grid<T>::setTimeStep(double step) {
+    time_step             = step;
+    time_2                = static_cast<T>(step / 2);
+    time_squared          = static_cast<T>(pow(step, 2));
+    physics.time_increase = static_cast<T>(step);
+  }
+
+  template <std::floating_point T>
+  void Grid<T>::resetTime() {
+    time = 0;
+    if (scenario.courant == 0) {
+      setTimeStep(scenario.time_increase);
+      return;
+    }
+    block_maxima.assign(blocks.size(), {0, 0});
+    T speed_2 = 0;
+    for (size_t i = 0; i < file.particles.size(); i++) {
+      Vector3D<T> const hv_vector = file.particles.hv_vector[i];
+      speed_2                     = std::max(speed_2, hv_vector.dot(hv_vector));
+    }
+    Vector3D<T> const & gravity = physics.external_acceleration;
+    setTimeStep(adaptiveTimeStep(speed_2, gravity.dot(gravity), scenario.time_increase));
+  }
+
+  // Criterio CFL (ninguna particula avanza mas de courant longitudes de suavizado por paso) y
+  // de fuerzas (courant * sqrt(h / |a|)), calculados en double
+  template <std::floating_point T>
+  double Grid<T>::adaptiveTimeStep(T speed_2, T acceleration_2, double limit) const {
+    double const h = smoothing_lenght;
+    double step    = limit;
+    if (speed_2 > 0) { step = std::min(step, scenario.courant * h / std::sqrt(double{speed_2})); }
+    if (acceleration_2 > 0) {
+      step = std::min(step, scenario.courant * std::sqrt(h / std::sqrt(double{acceleration_2})));
+    }
+    return step;
+  }
+
+  template <std::floating_point T>
+  void Grid<T>::advanceTime() {
+    time += time_step;
+    if (scenario.courant == 0) {
+      setTimeStep(scenario.time_increase);
+      return;
+    }
+    T speed_2        = 0;
+    T acceleration_2 = 0;
+    for (size_t const block_i : active_blocks) {
+      speed_2        = std::max(speed_2, block_maxima[block_i].first);
+      acceleration_2 = std::max(acceleration_2, block_maxima[block_i].second);
+    }
+    double const limit = std::min(scenario.time_increase, time_step_growth * time_step);
+    setTimeStep(adaptiveTimeStep(speed_2, acceleration_2, limit));
+  }
+
+  template <std::floating_point T>
+  void Grid<T>::limitTimeStep(double end_time) {
+    if (time + time_step > end_time) { setTimeStep(end_time - time); }
+  }
+
+  // Los pasos se suman en double: se da por llegado si falta menos de una millonesima de paso
+  template <std::floating_point T>
+  bool Grid<T>::reachedTime(double end_time) const {
+    // NOLINTNEXTLINE(cppcoreguidelines-avoid-magic-numbers,readability-magic-numbers)
+    return end_time - time <= time_step * 1e-6;
+  }
+
+  template <std::floating_point T>
+  [[nodiscard]] Vector3D<T> Grid<T>::blockIndex(Vector3D<T> const & position) const {
+    Vector3D<T> bindex(0, 0, 0);
+    bindex.x = std::floor((position.x - physics.bmin.x) / block_size.x);
+    bindex.y = std::floor((position.y - physics.bmin.y) / block_size.y);
+    bindex.z = std::floor((position.z - physics.bmin.z) / block_size.z);
 
     bindex.x = bindex.x < 0 ? 0 : bindex.x;
     bindex.x = bindex.x > n_blocks_x - 1 ? n_blocks_x - 1 : bindex.x;
@@ -138,260 +441,873 @@ namespace fluids::sim {
     return bindex;
   }
 
-  void Grid::evaluateDensities(size_t i, size_t j) {
-    double const distance   = (file.particles[i].position - file.particles[j].position).norm();
-    double const distance_2 = distance * distance;
+  // Mismo calculo que blockIndex, pero devuelve directamente la posicion del bloque en blocks
+  // (el indice lineal salvo con otro block_order)
+  template <std::floating_point T>
+  [[nodiscard]] size_t Grid<T>::linearBlockIndex(Vector3D<T> const & position) const {
+    auto const axis_index = [](T coordinate, T min, T size, int n_blocks) {
+      return static_cast<size_t>(
+          std::clamp(std::floor((coordinate - min) / size), T{0}, static_cast<T>(n_blocks - 1)));
+    };
+    size_t const index_x = axis_index(position.x, physics.bmin.x, block_size.x, n_blocks_x);
+    size_t const index_y = axis_index(position.y, physics.bmin.y, block_size.y, n_blocks_y);
+    size_t const index_z = axis_index(position.z, physics.bmin.z, block_size.z, n_blocks_z);
+    return blockSlot(index_x + (index_y + index_z * n_blocks_y) * n_blocks_x);
+  }
+
+  template <std::floating_point T>
+  void Grid<T>::evaluateDensities(size_t i, size_t j) {
+    Vector3DArray<T> const & position = file.particles.position;
+    T const d_x                       = position.x[i] - position.x[j];
+    T const d_y                       = position.y[i] - position.y[j];
+    T const d_z                       = position.z[i] - position.z[j];
+    T const distance                  = std::sqrt(d_x * d_x + d_y * d_y + d_z * d_z);
+    T const distance_2                = distance * distance;
     if (distance_2 < smoothing_2) {
-      double const smoothing_distance = smoothing_2 - distance_2;
+      T const smoothing_distance = smoothing_2 - distance_2;
 
-      double const increment_density   = smoothing_distance * smoothing_distance * smoothing_distance;
-      file.particles[i].density += increment_density;
-      file.particles[j].density += increment_density;
+      T const increment_density = smoothing_distance * smoothing_distance * smoothing_distance;
+      file.particles.density[i] += increment_density;
+      file.particles.density[j] += increment_density;
     }
   }
 
-  void Grid::evaluateAccelerations(size_t i, size_t j) {
-    double const distance = (file.particles[i].position - file.particles[j].position).norm();
-    if (distance * distance < smoothing_2) {
-      double const dist_ij                     = std::max(distance, max_distance);
+  template <std::floating_point T>
+  void Grid<T>::evaluateAccelerations(size_t i, size_t j) {
+    Vector3D<T> const position_ij = file.particles.position[i] - file.particles.position[j];
+    T const distance              = position_ij.norm();
+    if (distance * distance < smoothing_2) { addAccelerations(i, j, distance); }
+  }
+
+  template <std::floating_point T>
+  void Grid<T>::addAccelerations(size_t i, size_t j, T distance) {
+    Particles<T> & particles      = file.particles;
+    Vector3D<T> const position_ij = particles.position[i] - particles.position[j];
+    T const dist_ij               = std::max(distance, physics.max_distance);
 
-      Vector3D increment_acceleration_ij  = (file.particles[i].position - file.particles[j].position);
-      increment_acceleration_ij *= smoothing_6_pi_15;
-      increment_acceleration_ij *= mass_pressure;
-      double const h_dist_ij     = smoothing_lenght - dist_ij;
-      increment_acceleration_ij *= h_dist_ij * h_dist_ij / dist_ij;
-      increment_acceleration_ij *=
-          (file.particles[i].density + file.particles[j].density - fluid_density_2);
-      increment_acceleration_ij +=
-          (file.particles[j].speed - file.particles[i].speed) * viscosity_mass_h6_pi;
-      increment_acceleration_ij /= (file.particles[i].density * file.particles[j].density);
+    Vector3D<T> increment_acceleration_ij  = position_ij;
+    increment_acceleration_ij *= smoothing_6_pi_15;
+    increment_acceleration_ij *= mass_pressure;
+    T const h_dist_ij                      = smoothing_lenght - dist_ij;
+    increment_acceleration_ij *= h_dist_ij * h_dist_ij / dist_ij;
+    increment_acceleration_ij *= (particles.density[i] + particles.density[j] - fluid_density_2);
+    increment_acceleration_ij += (particles.speed[j] - particles.speed[i]) * viscosity_mass_h6_pi;
+    increment_acceleration_ij /= (particles.density[i] * particles.density[j]);
 
-      file.particles[i].acceleration += increment_acceleration_ij;
-      file.particles[j].acceleration -= increment_acceleration_ij;
+    particles.acceleration.x[i] += increment_acceleration_ij.x;
+    particles.acceleration.y[i] += increment_acceleration_ij.y;
+    particles.acceleration.z[i] += increment_acceleration_ij.z;
+    particles.acceleration.x[j] -= increment_acceleration_ij.x;
+    particles.acceleration.y[j] -= increment_acceleration_ij.y;
+    particles.acceleration.z[j] -= increment_acceleration_ij.z;
+  }
+
+  // Las operaciones de cada particula son las de siempre, pero sin saltos que dependan de la
+  // particula ni de la pared: el bucle se puede vectorizar
+  template <std::floating_point T>
+  template <int Axis, bool Low>
+  void Grid<T>::wallCollisions(Block const & block) {
+    Particles<T> & particles  = file.particles;
+    T * const acceleration    = component<Axis>(particles.acceleration).data();
+    T const * const position  = component<Axis>(particles.position).data();
+    T const * const hv_vector = component<Axis>(particles.hv_vector).data();
+    T const * const speed     = component<Axis>(particles.speed).data();
+    T const time_increase     = physics.time_increase;
+    T const particle_size     = physics.particle_size;
+    T const rigidity          = physics.rigidity_collisions;
+    T const dumping           = physics.dumping;
+    T const min_increment     = physics.min_increment;
+    T const wall = Low ? component<Axis>(physics.bmin) : component<Axis>(physics.bmax);
+    for (size_t index = block.begin; index < block.end; index++) {
+      T const new_position = position[index] + hv_vector[index] * time_increase;
+      T const increment =
+          Low ? particle_size + wall - new_position : new_position - wall + particle_size;
+      T const pushed = Low ? acceleration[index] + rigidity * increment
+                           : acceleration[index] - rigidity * increment;
+      acceleration[index] =
+          increment > min_increment ? pushed - dumping * speed[index] : acceleration[index];
     }
   }
 
-  void Grid::collisionsX(size_t index, bool x_0) {
-    double const new_x =
-        file.particles[index].position.x + file.particles[index].hv_vector.x * time_increase;
-    if (x_0) {
-      double const increment_x = particle_size + bmin.x - new_x;
-      if (increment_x > min_increment) {
-        file.particles[index].acceleration.x += rigidity_collisions * increment_x;
-        file.particles[index].acceleration.x -= dumping * file.particles[index].speed.x;
-      }
-    } else {
-      double const increment_x = new_x - bmax.x + particle_size;
-      if (increment_x > min_increment) {
-        file.particles[index].acceleration.x -= rigidity_collisions * increment_x;
-        file.particles[index].acceleration.x -= dumping * file.particles[index].speed.x;
+  template <std::floating_point T>
+  void Grid<T>::collisions(Block & block) {
+    if ((block.walls & wall_bit<0, true>) != 0) { wallCollisions<0, true>(block); }
+    if ((block.walls & wall_bit<0, false>) != 0) { wallCollisions<0, false>(block); }
+    if ((block.walls & wall_bit<1, true>) != 0) { wallCollisions<1, true>(block); }
+    if ((block.walls & wall_bit<1, false>) != 0) { wallCollisions<1, false>(block); }
+    if ((block.walls & wall_bit<2, true>) != 0) { wallCollisions<2, true>(block); }
+    if ((block.walls & wall_bit<2, false>) != 0) { wallCollisions<2, false>(block); }
+  }
+
+  template <std::floating_point T>
+  void Grid<T>::updateParticle(Block & block) {
+    Particles<T> & particles = file.particles;
+    for (size_t index = block.begin; index < block.end; index++) {
+      Vector3D<T> const hv_vector    = particles.hv_vector[index];
+      Vector3D<T> const acceleration = particles.acceleration[index];
+      particles.position.set(index, particles.position[index] +
+                                        (hv_vector * physics.time_increase +
+                                         acceleration * time_squared));
+      particles.speed.set(index, hv_vector + acceleration * time_2);
+      particles.hv_vector.set(index, hv_vector + acceleration * physics.time_increase);
+    }
+  }
+
+  template <std::floating_point T>
+  void Grid<T>::trackMaxima(size_t block_i) {
+    Particles<T> const & particles = file.particles;
+    Block const & block            = blocks[block_i];
+    T speed_2                      = 0;
+    T acceleration_2               = 0;
+    for (size_t index = block.begin; index < block.end; index++) {
+      Vector3D<T> const hv_vector    = particles.hv_vector[index];
+      Vector3D<T> const acceleration = particles.acceleration[index];
+      speed_2        = std::max(speed_2, hv_vector.dot(hv_vector));
+      acceleration_2 = std::max(acceleration_2, acceleration.dot(acceleration));
+    }
+    block_maxima[block_i] = {speed_2, acceleration_2};
+  }
+
+  template <std::floating_point T>
+  template <int Axis, bool Low>
+  void Grid<T>::wallInteractions(Block const & block) {
+    Particles<T> & particles = file.particles;
+    T * const position       = component<Axis>(particles.position).data();
+    T * const hv_vector      = component<Axis>(particles.hv_vector).data();
+    T * const speed          = component<Axis>(particles.speed).data();
+    T const wall = Low ? component<Axis>(physics.bmin) : component<Axis>(physics.bmax);
+    for (size_t index = block.begin; index < block.end; index++) {
+      T const distance   = Low ? position[index] - wall : wall - position[index];
+      bool const outside = distance < 0;
+      T const reflected  = Low ? wall - distance : wall + distance;
+      position[index]    = outside ? reflected : position[index];
+      speed[index]       = outside ? -speed[index] : speed[index];
+      hv_vector[index]   = outside ? -hv_vector[index] : hv_vector[index];
+    }
+  }
+
+  template <std::floating_point T>
+  void Grid<T>::interactions(Block & block) {
+    if ((block.walls & wall_bit<0, true>) != 0) { wallInteractions<0, true>(block); }
+    if ((block.walls & wall_bit<0, false>) != 0) { wallInteractions<0, false>(block); }
+    if ((block.walls & wall_bit<1, true>) != 0) { wallInteractions<1, true>(block); }
+    if ((block.walls & wall_bit<1, false>) != 0) { wallInteractions<1, false>(block); }
+    if ((block.walls & wall_bit<2, true>) != 0) { wallInteractions<2, true>(block); }
+    if ((block.walls & wall_bit<2, false>) != 0) { wallInteractions<2, false>(block); }
+  }
+
+  template <std::floating_point T>
+  void Grid<T>::evalDensities(size_t block_i) {
+    // Los bloques vacios no tienen parejas (y los que nunca han tenido particulas, ni vecinos)
+    if (blocks[block_i].size() == 0) { return; }
+    if (use_pair_cache) {
+      evalDensitiesCached(block_i);
+      return;
+    }
+    if (verlet_skin > 0) {
+      evalDensitiesVerlet(block_i);
+      return;
+    }
+    if (kernel != KernelType::scalar) {
+      evalDensitiesSimd(block_i);
+      return;
+    }
+    Block const & block  = blocks[block_i];
+    size_t const table_i = block.neighbours;
+    for (size_t particle_i = block.begin; particle_i < block.end; particle_i++) {
+      for (size_t n = neighbour_begin[table_i]; n < neighbour_begin[table_i + 1]; n++) {
+        size_t const block_j = neighbour_blocks[n];
+        size_t const first_j = block_j == block_i ? particle_i + 1 : blocks[block_j].begin;
+        for (size_t particle_j = first_j; particle_j < blocks[block_j].end; particle_j++) {
+          evaluateDensities(particle_i, particle_j);
+        }
       }
     }
   }
 
-  void Grid::collisionsY(size_t index, bool y_0) {
-    double const new_y =
-        file.particles[index].position.y + file.particles[index].hv_vector.y * time_increase;
-    if (y_0) {
-      double const increment_y = particle_size + bmin.y - new_y;
-      if (increment_y > min_increment) {
-        file.particles[index].acceleration.y += rigidity_collisions * increment_y;
-        file.particles[index].acceleration.y -= dumping * file.particles[index].speed.y;
+  template <std::floating_point T>
+  void Grid<T>::evalDensitiesSimd(size_t block_i) {
+    PairArrays<T> const arrays = pairArrays();
+    Block const & block        = blocks[block_i];
+    size_t const table_i       = block.neighbours;
+    for (size_t particle_i = block.begin; particle_i < block.end; particle_i++) {
+      for (size_t n = neighbour_run_begin[table_i]; n < neighbour_run_begin[table_i + 1]; n++) {
+        auto const [first_block, last_block] = neighbour_runs[n];
+        size_t const first_j = first_block == block_i ? particle_i + 1 : blocks[first_block].begin;
+        size_t const last_j  = blocks[last_block].end;
+        if (kernel == KernelType::avx512) {
+          densityRowAvx512(arrays, particle_i, first_j, last_j, kernel_constants);
+        } else {
+          densityRowAvx2(arrays, particle_i, first_j, last_j, kernel_constants);
+        }
       }
-    } else {
-      double const increment_y = new_y - bmax.y + particle_size;
-      if (increment_y > min_increment) {
-        file.particles[index].acceleration.y -= rigidity_collisions * increment_y;
-        file.particles[index].acceleration.y -= dumping * file.particles[index].speed.y;
+    }
+  }
+
+  template <std::floating_point T>
+  void Grid<T>::transformDensities(Block & block) {
+    std::vector<T> & density = file.particles.density;
+    for (size_t particle_i = block.begin; particle_i < block.end; particle_i++) {
+      density[particle_i] = (density[particle_i] + smoothing_6) * density_transformation_constant;
+    }
+  }
+
+  template <std::floating_point T>
+  void Grid<T>::resetAccelerations(Block & block) {
+    Vector3DArray<T> & acceleration = file.particles.acceleration;
+    Vector3D<T> const & gravity     = physics.external_acceleration;
+    for (size_t particle_i = block.begin; particle_i < block.end; particle_i++) {
+      acceleration.x[particle_i] = gravity.x;
+      acceleration.y[particle_i] = gravity.y;
+      acceleration.z[particle_i] = gravity.z;
+    }
+  }
+
+  template <std::floating_point T>
+  void Grid<T>::evalAccelerations(size_t block_i) {
+    // Los bloques vacios no tienen parejas (y los que nunca han tenido particulas, ni vecinos)
+    if (blocks[block_i].size() == 0) { return; }
+    if (use_pair_cache) {
+      evalAccelerationsCached(block_i);
+      return;
+    }
+    if (verlet_skin > 0) {
+      evalAccelerationsVerlet(block_i);
+      return;
+    }
+    if (kernel != KernelType::scalar) {
+      evalAccelerationsSimd(block_i);
+      return;
+    }
+    Block const & block  = blocks[block_i];
+    size_t const table_i = block.neighbours;
+    for (size_t particle_i = block.begin; particle_i < block.end; particle_i++) {
+      for (size_t n = neighbour_begin[table_i]; n < neighbour_begin[table_i + 1]; n++) {
+        size_t const block_j = neighbour_blocks[n];
+        size_t const first_j = block_j == block_i ? particle_i + 1 : blocks[block_j].begin;
+        for (size_t particle_j = first_j; particle_j < blocks[block_j].end; particle_j++) {
+          evaluateAccelerations(particle_i, particle_j);
+        }
       }
     }
   }
 
-  void Grid::collisionsZ(size_t index, bool z_0) {
-    double const new_z =
-        file.particles[index].position.z + file.particles[index].hv_vector.z * time_increase;
-    if (z_0) {
-      double const increment_z = particle_size + bmin.z - new_z;
-      if (increment_z > min_increment) {
-        file.particles[index].acceleration.z += rigidity_collisions * increment_z;
-        file.particles[index].acceleration.z -= dumping * file.particles[index].speed.z;
+  template <std::floating_point T>
+  void Grid<T>::evalAccelerationsSimd(size_t block_i) {
+    PairArrays<T> const arrays = pairArrays();
+    Block const & block        = blocks[block_i];
+    size_t const table_i       = block.neighbours;
+    for (size_t particle_i = block.begin; particle_i < block.end; particle_i++) {
+      for (size_t n = neighbour_run_begin[table_i]; n < neighbour_run_begin[table_i + 1]; n++) {
+        auto const [first_block, last_block] = neighbour_runs[n];
+        size_t const first_j = first_block == block_i ? particle_i + 1 : blocks[first_block].begin;
+        size_t const last_j  = blocks[last_block].end;
+        if (kernel == KernelType::avx512) {
+          accelerationRowAvx512(arrays, particle_i, first_j, last_j, kernel_constants);
+        } else {
+          accelerationRowAvx2(arrays, particle_i, first_j, last_j, kernel_constants);
+        }
       }
-    } else {
-      double const increment_z = new_z - bmax.z + particle_size;
-      if (increment_z > min_increment) {
-        file.particles[index].acceleration.z -= rigidity_collisions * increment_z;
-        file.particles[index].acceleration.z -= dumping * file.particles[index].speed.z;
+    }
+  }
+
+  // Las parejas de la lista se evaluan con las funciones escalares: las SIMD recorren tramos
+  // contiguos de particulas y aqui cada pareja tiene un indice distinto
+  template <std::floating_point T>
+  void Grid<T>::evalDensitiesVerlet(size_t block_i) {
+    Block const & block = blocks[block_i];
+    for (size_t particle_i = block.begin; particle_i < block.end; particle_i++) {
+      for (size_t n = verlet_begin[particle_i]; n < verlet_begin[particle_i + 1]; n++) {
+        evaluateDensities(particle_i, verlet_pairs[n]);
       }
     }
   }
 
-  void Grid::collisions(Block & block) {
-    if (block.x == 0 || block.x == n_blocks_x - 1) {
-      for (size_t const particle_i : block.particles) { collisionsX(particle_i, block.x == 0); }
+  template <std::floating_point T>
+  void Grid<T>::evalAccelerationsVerlet(size_t block_i) {
+    Block const & block = blocks[block_i];
+    for (size_t particle_i = block.begin; particle_i < block.end; particle_i++) {
+      for (size_t n = verlet_begin[particle_i]; n < verlet_begin[particle_i + 1]; n++) {
+        evaluateAccelerations(particle_i, verlet_pairs[n]);
+      }
     }
-    if (block.y == 0 || block.y == n_blocks_y - 1) {
-      for (size_t const particle_i : block.particles) { collisionsY(particle_i, block.y == 0); }
+  }
+
+  // Mismo calculo y orden que evaluateDensities sobre las parejas de los bloques vecinos (o de
+  // la lista de Verlet), anotando las que quedan dentro del radio
+  template <std::floating_point T>
+  void Grid<T>::evalDensitiesCached(size_t block_i) {
+    if (kernel != KernelType::scalar && verlet_skin == 0) {
+      evalDensitiesCachedSimd(block_i);
+      return;
     }
-    if (block.z == 0 || block.z == n_blocks_z - 1) {
-      for (size_t const particle_i : block.particles) { collisionsZ(particle_i, block.z == 0); }
+    Vector3DArray<T> const & position = file.particles.position;
+    std::vector<T> & density          = file.particles.density;
+    size_t const table_i              = blocks[block_i].neighbours;
+    std::vector<CachedPair<T>> & list = pair_cache[table_i];
+    list.clear();
+    auto const pair = [&](size_t i, size_t j) {
+      T const d_x        = position.x[i] - position.x[j];
+      T const d_y        = position.y[i] - position.y[j];
+      T const d_z        = position.z[i] - position.z[j];
+      T const distance   = std::sqrt(d_x * d_x + d_y * d_y + d_z * d_z);
+      T const distance_2 = distance * distance;
+      if (distance_2 < smoothing_2) {
+        T const smoothing_distance = smoothing_2 - distance_2;
+        T const increment_density  = smoothing_distance * smoothing_distance * smoothing_distance;
+        density[i]                += increment_density;
+        density[j]                += increment_density;
+        list.push_back({static_cast<uint32_t>(i), static_cast<uint32_t>(j), distance});
+      }
+    };
+    Block const & block = blocks[block_i];
+    for (size_t particle_i = block.begin; particle_i < block.end; particle_i++) {
+      if (verlet_skin > 0) {
+        for (size_t n = verlet_begin[particle_i]; n < verlet_begin[particle_i + 1]; n++) {
+          pair(particle_i, verlet_pairs[n]);
+        }
+        continue;
+      }
+      for (size_t n = neighbour_begin[table_i]; n < neighbour_begin[table_i + 1]; n++) {
+        size_t const block_j = neighbour_blocks[n];
+        size_t const first_j = block_j == block_i ? particle_i + 1 : blocks[block_j].begin;
+        for (size_t particle_j = first_j; particle_j < blocks[block_j].end; particle_j++) {
+          pair(particle_i, particle_j);
+        }
+      }
     }
+    pair_cache_used[table_i] = list.size();
   }
 
-  void Grid::updateParticle(Block & block) {
-    for (size_t const index : block.particles) {
-      file.particles[index].position += file.particles[index].hv_vector * time_increase +
-                                        file.particles[index].acceleration * time_squared;
-      file.particles[index].speed =
-          file.particles[index].hv_vector + file.particles[index].acceleration * time_2;
-      file.particles[index].hv_vector += file.particles[index].acceleration * time_increase;
+  // Como evalDensitiesSimd. Antes de cada tramo se asegura sitio para todas sus parejas, y el
+  // vector solo crece: su tamano es lo reservado y pair_cache_used lo que se ha llenado.
+  template <std::floating_point T>
+  void Grid<T>::evalDensitiesCachedSimd(size_t block_i) {
+    PairArrays<T> const arrays        = pairArrays();
+    Block const & block               = blocks[block_i];
+    size_t const table_i              = block.neighbours;
+    std::vector<CachedPair<T>> & list = pair_cache[table_i];
+    size_t used                       = 0;
+    for (size_t particle_i = block.begin; particle_i < block.end; particle_i++) {
+      for (size_t n = neighbour_run_begin[table_i]; n < neighbour_run_begin[table_i + 1]; n++) {
+        auto const [first_block, last_block] = neighbour_runs[n];
+        size_t const first_j = first_block == block_i ? particle_i + 1 : blocks[first_block].begin;
+        size_t const last_j  = blocks[last_block].end;
+        if (first_j >= last_j) { continue; }
+        if (list.size() < used + (last_j - first_j)) {
+          list.resize(std::max(2 * list.size(), used + (last_j - first_j)));
+        }
+        if (kernel == KernelType::avx512) {
+          used += densityRowCachedAvx512(arrays, particle_i, first_j, last_j, kernel_constants,
+                                         list.data() + used);
+        } else {
+          used += densityRowCachedAvx2(arrays, particle_i, first_j, last_j, kernel_constants,
+                                       list.data() + used);
+        }
+      }
     }
+    pair_cache_used[table_i] = used;
   }
 
-  void Grid::interactionsX(size_t index, bool x_0) {
-    double const d_x =
-        x_0 ? file.particles[index].position.x - bmin.x : bmax.x - file.particles[index].position.x;
-    if (d_x < 0) {
-      file.particles[index].position.x   = x_0 ? bmin.x - d_x : bmax.x + d_x;
-      file.particles[index].speed.x     *= -1;
-      file.particles[index].hv_vector.x *= -1;
+  template <std::floating_point T>
+  void Grid<T>::evalAccelerationsCached(size_t block_i) {
+    size_t const table_i                    = blocks[block_i].neighbours;
+    std::vector<CachedPair<T>> const & list = pair_cache[table_i];
+    for (size_t n = 0; n < pair_cache_used[table_i]; n++) {
+      addAccelerations(list[n].i, list[n].j, list[n].distance);
     }
   }
 
-  void Grid::interactionsY(size_t index, bool y_0) {
-    double const d_y =
-        y_0 ? file.particles[index].position.y - bmin.y : bmax.y - file.particles[index].position.y;
-    if (d_y < 0) {
-      file.particles[index].position.y   = y_0 ? bmin.y - d_y : bmax.y + d_y;
-      file.particles[index].speed.y     *= -1;
-      file.particles[index].hv_vector.y *= -1;
+  template <std::floating_point T>
+  size_t Grid<T>::pairCacheBytes() const {
+    size_t bytes = pair_cache.capacity() * sizeof(std::vector<CachedPair<T>>);
+    for (std::vector<CachedPair<T>> const & list : pair_cache) {
+      bytes += list.capacity() * sizeof(CachedPair<T>);
     }
+    return bytes;
   }
 
-  void Grid::interactionsZ(size_t index, bool z_0) {
-    double const d_z =
-        z_0 ? file.particles[index].position.z - bmin.z : bmax.z - file.particles[index].position.z;
-    if (d_z < 0) {
-      file.particles[index].position.z   = z_0 ? bmin.z - d_z : bmax.z + d_z;
-      file.particles[index].speed.z     *= -1;
-      file.particles[index].hv_vector.z *= -1;
-    }
+  template <std::floating_point T>
+  PairArrays<T> Grid<T>::pairArrays() {
+    Particles<T> & particles = file.particles;
+    return {.position_x     = particles.position.x.data(),
+            .position_y     = particles.position.y.data(),
+            .position_z     = particles.position.z.data(),
+            .speed_x        = particles.speed.x.data(),
+            .speed_y        = particles.speed.y.data(),
+            .speed_z        = particles.speed.z.data(),
+            .density        = particles.density.data(),
+            .acceleration_x = particles.acceleration.x.data(),
+            .acceleration_y = particles.acceleration.y.data(),
+            .acceleration_z = particles.acceleration.z.data()};
   }
 
-  void Grid::interactions(Block & block) {
-    if (block.x == 0 || block.x == n_blocks_x - 1) {
-      for (size_t const particle_i : block.particles) { interactionsX(particle_i, block.x == 0); }
+  // Ordenacion por conteo de las particulas segun su bloque. Dentro de cada bloque se mantiene
+  // el orden original, asi que las parejas se evaluan en el mismo orden que sin reordenar.
+  // Solo se recorren los bloques activos: los demas siguen con begin = end = 0 y el coste no
+  // depende del numero total de bloques.
+  template <std::floating_point T>
+  void Grid<T>::sortParticles() {
+    Particles<T> & particles = file.particles;
+    size_t const n_particles = particles.size();
+    particle_block.resize(n_particles);
+    for (size_t const block_i : active_blocks) {
+      blocks[block_i].begin = 0;
+      blocks[block_i].end   = 0;
+    }
+    entered_blocks.clear();
+    bool sorted = true;
+    for (size_t i = 0; i < n_particles; i++) {
+      if (fused) { particles.density[i] = 0; }
+      particle_block[i] = linearBlockIndex(particles.position[i]);
+      Block & block     = blocks[particle_block[i]];
+      if (block.end++ == 0 && block.neighbours == Block::none) {
+        entered_blocks.push_back(particle_block[i]);
+      }
+      if (i > 0) {
+        sorted = sorted && (particle_block[i - 1] < particle_block[i] ||
+                            (particle_block[i - 1] == particle_block[i] &&
+                             particles.id[i - 1] < particles.id[i]));
+      }
     }
-    if (block.y == 0 || block.y == n_blocks_y - 1) {
-      for (size_t const particle_i : block.particles) { interactionsY(particle_i, block.y == 0); }
+    if (!entered_blocks.empty()) { activateBlocks(); }
+    size_t first = 0;
+    for (size_t const block_i : active_blocks) {
+      Block & block       = blocks[block_i];
+      size_t const count  = block.end;
+      block.begin         = first;
+      block.end           = first;
+      first              += count;
     }
-    if (block.z == 0 || block.z == n_blocks_z - 1) {
-      for (size_t const particle_i : block.particles) { interactionsZ(particle_i, block.z == 0); }
+    if (sorted) {
+      for (size_t i = 0; i < n_particles; i++) { blocks[particle_block[i]].end++; }
+    } else {
+      reorderParticles();
     }
   }
 
-  [[nodiscard]] std::vector<Vector3D> Grid::getNeighbours(Vector3D position) const {
-    std::vector<Vector3D> neighbours;
-    for (int i = -1; i < 2; i++) {
-      for (int j = -1; j < 2; j++) {
-        for (int k = -1; k < 2; k++) {
-          Vector3D const new_position = Vector3D(position.x + i, position.y + j, position.z + k);
-          if (new_position.x < 0 || new_position.x > n_blocks_x - 1 || new_position.y < 0 ||
-              new_position.y > n_blocks_y - 1 || new_position.z < 0 ||
-              new_position.z > n_blocks_z - 1) {
-            continue;
-          }
-          neighbours.push_back(new_position);
+  // Los vecinos de un bloque no dependen de que esten ocupados, asi que se anotan una sola vez,
+  // la primera vez que el bloque tiene particulas. Sus vecinos pasan a ser activos para que
+  // los tramos de las funciones SIMD tengan begin y end validos en los dos extremos.
+  template <std::floating_point T>
+  void Grid<T>::activateBlocks() {
+    size_t const previous = active_blocks.size();
+    for (size_t const block_i : entered_blocks) {
+      addNeighbours(block_i);
+      size_t const table_i = blocks[block_i].neighbours;
+      for (size_t n = neighbour_begin[table_i]; n < neighbour_begin[table_i + 1]; n++) {
+        Block & neighbour = blocks[neighbour_blocks[n]];
+        if (!neighbour.active) {
+          neighbour.active = true;
+          active_blocks.push_back(neighbour_blocks[n]);
         }
       }
     }
-    return neighbours;
+    std::sort(active_blocks.begin() + static_cast<std::ptrdiff_t>(previous), active_blocks.end());
+    std::inplace_merge(active_blocks.begin(),
+                       active_blocks.begin() + static_cast<std::ptrdiff_t>(previous),
+                       active_blocks.end());
+    // Las tablas nuevas se anaden al final. Cuando ya son mas de la cuarta parte se copian
+    // todas en el orden de los bloques para que las pasadas las vuelvan a leer seguidas.
+    size_t const tables = neighbour_begin.size() - 1;
+    if (4 * (tables - sorted_tables) > tables) {
+      sortNeighbours();
+      sorted_tables = tables;
+    }
+    if (use_pair_cache) {
+      pair_cache.resize(neighbour_begin.size() - 1);
+      pair_cache_used.resize(neighbour_begin.size() - 1);
+    }
   }
 
-  void Grid::evalDensities(size_t block_i) {
-    Vector3D const position = Vector3D(blocks[block_i].x, blocks[block_i].y, blocks[block_i].z);
-    std::vector<Vector3D> const neighbours = getNeighbours(position);
-    for (size_t const particle_i : blocks[block_i].particles) {
-      for (Vector3D const neighbour : neighbours) {
-        auto block_j = static_cast<size_t>(neighbour.x + neighbour.y * n_blocks_x +
-                                           neighbour.z * n_blocks_x * n_blocks_y);
-        if (block_i == block_j) {
-          for (size_t const particle_j : blocks[block_j].particles) {
-            if (particle_i < particle_j) { evaluateDensities(particle_i, particle_j); }
-          }
-        } else if (block_i < block_j) {
-          for (size_t const particle_j : blocks[block_j].particles) {
-            evaluateDensities(particle_i, particle_j);
-          }
+  template <std::floating_point T>
+  void Grid<T>::sortNeighbours() {
+    sorted_begin.assign(1, 0);
+    sorted_blocks.clear();
+    sorted_run_begin.assign(1, 0);
+    sorted_runs.clear();
+    for (size_t const block_i : active_blocks) {
+      Block & block        = blocks[block_i];
+      size_t const table_i = block.neighbours;
+      if (table_i == Block::none) { continue; }
+      sorted_blocks.insert(
+          sorted_blocks.end(),
+          neighbour_blocks.begin() + static_cast<std::ptrdiff_t>(neighbour_begin[table_i]),
+          neighbour_blocks.begin() + static_cast<std::ptrdiff_t>(neighbour_begin[table_i + 1]));
+      sorted_runs.insert(
+          sorted_runs.end(),
+          neighbour_runs.begin() + static_cast<std::ptrdiff_t>(neighbour_run_begin[table_i]),
+          neighbour_runs.begin() + static_cast<std::ptrdiff_t>(neighbour_run_begin[table_i + 1]));
+      block.neighbours = static_cast<uint32_t>(sorted_begin.size() - 1);
+      sorted_begin.push_back(sorted_blocks.size());
+      sorted_run_begin.push_back(sorted_runs.size());
+    }
+    neighbour_begin.swap(sorted_begin);
+    neighbour_blocks.swap(sorted_blocks);
+    neighbour_run_begin.swap(sorted_run_begin);
+    neighbour_runs.swap(sorted_runs);
+  }
+
+  template <std::floating_point T>
+  void Grid<T>::reorderParticles() {
+    Particles<T> & particles = file.particles;
+    size_t const n_particles = particles.size();
+    particle_order.resize(n_particles);
+    for (size_t i = 0; i < n_particles; i++) { particle_order[blocks[particle_block[i]].end++] = i; }
+    // Las particulas que cambian de bloque llegan desordenadas: insercion por indice original
+    for (size_t const block_i : active_blocks) {
+      Block const & block = blocks[block_i];
+      for (size_t k = block.begin + 1; k < block.end; k++) {
+        size_t const moved = particle_order[k];
+        size_t slot        = k;
+        while (slot > block.begin && particles.id[particle_order[slot - 1]] > particles.id[moved]) {
+          particle_order[slot] = particle_order[slot - 1];
+          slot--;
         }
+        particle_order[slot] = moved;
       }
     }
+    if (fused) {
+      particles.reorderState(particle_order, reorder_buffer, reorder_ids);
+    } else {
+      particles.reorder(particle_order, reorder_buffer, reorder_ids);
+    }
   }
 
-  void Grid::transformDensities(Block & block) {
-    for (size_t const particle_i : block.particles) {
-      file.particles[particle_i].density =
-          (file.particles[particle_i].density + smoothing_6) * density_transformation_constant;
+  template <std::floating_point T>
+  void Grid<T>::assignBlocks() {
+    if (verlet_skin == 0) {
+      sortParticles();
+    } else if (verletExpired()) {
+      sortParticles();
+      buildVerletList();
+    } else if (fused) {
+      std::fill(file.particles.density.begin(), file.particles.density.end(), 0);
     }
   }
 
-  void Grid::evalAccelerations(size_t block_i) {
-    Vector3D const position = Vector3D(blocks[block_i].x, blocks[block_i].y, blocks[block_i].z);
-    std::vector<Vector3D> const neighbours = getNeighbours(position);
-    for (size_t const particle_i : blocks[block_i].particles) {
-      for (Vector3D const neighbour : neighbours) {
-        auto block_j = static_cast<size_t>(neighbour.x + neighbour.y * n_blocks_x +
-                                           neighbour.z * n_blocks_x * n_blocks_y);
-        if (block_i == block_j) {
-          for (size_t const particle_j : blocks[block_j].particles) {
-            if (particle_i < particle_j) { evaluateAccelerations(particle_i, particle_j); }
-          }
-        } else if (block_i < block_j) {
-          for (size_t const particle_j : blocks[block_j].particles) {
-            evaluateAccelerations(particle_i, particle_j);
+  template <std::floating_point T>
+  bool Grid<T>::verletExpired() const {
+    if (verlet_begin.empty()) { return true; }
+    Vector3DArray<T> const & position = file.particles.position;
+    T const limit_2                   = verlet_skin * verlet_skin / 4;
+    for (size_t i = 0; i < position.x.size(); i++) {
+      T const d_x = position.x[i] - verlet_origin.x[i];
+      T const d_y = position.y[i] - verlet_origin.y[i];
+      T const d_z = position.z[i] - verlet_origin.z[i];
+      if (d_x * d_x + d_y * d_y + d_z * d_z > limit_2) { return true; }
+    }
+    return false;
+  }
+
+  // Mismo recorrido que evalDensities, con neighbour_blocks generado hasta verlet_reach
+  // bloques a cada lado
+  template <std::floating_point T>
+  void Grid<T>::buildVerletList() {
+    Vector3DArray<T> const & position = file.particles.position;
+    T const cutoff                    = smoothing_lenght + verlet_skin;
+    T const cutoff_2                  = cutoff * cutoff;
+    verlet_begin.assign(1, 0);
+    verlet_pairs.clear();
+    for (size_t const block_i : active_blocks) {
+      Block const & block  = blocks[block_i];
+      size_t const table_i = block.neighbours;
+      for (size_t particle_i = block.begin; particle_i < block.end; particle_i++) {
+        for (size_t n = neighbour_begin[table_i]; n < neighbour_begin[table_i + 1]; n++) {
+          size_t const block_j = neighbour_blocks[n];
+          size_t const first_j = block_j == block_i ? particle_i + 1 : blocks[block_j].begin;
+          for (size_t particle_j = first_j; particle_j < blocks[block_j].end; particle_j++) {
+            T const d_x = position.x[particle_i] - position.x[particle_j];
+            T const d_y = position.y[particle_i] - position.y[particle_j];
+            T const d_z = position.z[particle_i] - position.z[particle_j];
+            if (d_x * d_x + d_y * d_y + d_z * d_z < cutoff_2) {
+              verlet_pairs.push_back(static_cast<uint32_t>(particle_j));
+            }
           }
         }
+        verlet_begin.push_back(verlet_pairs.size());
       }
     }
+    verlet_origin = position;
+    if (profiler) { profiler->addListBuild(); }
   }
 
-  void Grid::makeSimulation() {
-    for (size_t i = 0; i < file.particles.size(); i++) {
-      file.particles[i].density      = 0;
-      file.particles[i].acceleration = external_acceleration;
-      Vector3D const index                 = blockIndex(file.particles[i]);
-      auto position =
-          static_cast<size_t>(index.x + index.y * n_blocks_x + index.z * n_blocks_x * n_blocks_y);
-      blocks[position].particles.push_back(i);
+  template <std::floating_point T>
+  void Grid<T>::resetParticles() {
+    Particles<T> & particles = file.particles;
+    std::fill(particles.density.begin(), particles.density.end(), 0);
+    Vector3D<T> const & gravity = physics.external_acceleration;
+    std::fill(particles.acceleration.x.begin(), particles.acceleration.x.end(), gravity.x);
+    std::fill(particles.acceleration.y.begin(), particles.acceleration.y.end(), gravity.y);
+    std::fill(particles.acceleration.z.begin(), particles.acceleration.z.end(), gravity.z);
+  }
+
+  // Pasadas completas sobre las particulas en cada paso, en serie (entre parentesis, las que
+  // solo hay con varios hilos; la reordenacion solo si alguna particula ha cambiado de bloque):
+  //  - sin fused: reinicio de densidad y aceleracion, asignacion de bloques, reordenacion de
+  //    los 14 arrays, densidades (y transformacion), aceleraciones (y colisiones, integracion
+  //    e interacciones con las paredes): 5 (7)
+  //  - con fused: asignacion de bloques con la densidad a cero, reordenacion de los 10 arrays
+  //    que pasan al paso siguiente, densidades con la transformacion y el reinicio de la
+  //    aceleracion de cada bloque, aceleraciones con el resto: 4 (6)
+  // En ambos casos se hacen las mismas operaciones en el mismo orden y el resultado es igual.
+  template <std::floating_point T>
+  void Grid<T>::makeSimulation() {
+    if (profiler) {
+      makeProfiledSimulation();
+      advanceTime();
+      return;
     }
+    beginStep();
+    finishStep();
+  }
+
+  template <std::floating_point T>
+  void Grid<T>::beginStep() {
+    if (!fused) { resetParticles(); }
+    assignBlocks();
+    densityPass();
+  }
+
+  template <std::floating_point T>
+  void Grid<T>::finishStep() {
+    accelerationPass();
+    advanceTime();
+  }
 
-    for (size_t block_i = 0; block_i < blocks.size(); block_i++) {
-      evalDensities(block_i);
-      transformDensities(blocks[block_i]);
+  // Cuando evalDensities termina con un bloque ya ha recibido todas sus contribuciones, y la
+  // aceleracion no se usa hasta la siguiente pasada.
+  // Con varios hilos, las sumas simetricas se reparten por colores: el orden en que cada
+  // particula recibe sus contribuciones solo depende del orden de los colores, asi que el
+  // resultado es el mismo para cualquier numero de hilos. Respecto al recorrido en serie solo
+  // cambia el orden de las sumas (diferencias relativas del orden de 1e-15 por paso).
+  template <std::floating_point T>
+  void Grid<T>::densityPass() {
+    if (pool->size() == 1) {
+      for (size_t const block_i : active_blocks) {
+        evalDensities(block_i);
+        transformDensities(blocks[block_i]);
+        if (fused) { resetAccelerations(blocks[block_i]); }
+      }
+      return;
+    }
+    for (std::vector<size_t> const & color : block_colors) {
+      pool->parallelFor(color.size(), [&](size_t i) { evalDensities(color[i]); });
     }
+    pool->parallelFor(active_blocks.size(), [&](size_t i) {
+      Block & block = blocks[active_blocks[i]];
+      transformDensities(block);
+      if (fused) { resetAccelerations(block); }
+    });
+  }
 
-    for (size_t block_i = 0; block_i < blocks.size(); block_i++) {
-      evalAccelerations(block_i);
-      collisions(blocks[block_i]);
+  // Los bloques interiores se mueven en cuanto reciben sus aceleraciones, sin pasar por el
+  // codigo de las paredes. Los de wall_blocks se mueven despues, agrupados por paredes: ninguna
+  // pareja de un bloque posterior los usa, asi que el resultado es el mismo.
+  template <std::floating_point T>
+  void Grid<T>::accelerationPass() {
+    bool const adaptive = scenario.courant > 0;
+    auto const move_interior = [&](size_t block_i) {
+      if (blocks[block_i].walls != 0) { return; }
       updateParticle(blocks[block_i]);
-      interactions(blocks[block_i]);
-      blocks[block_i].particles.clear();
+      if (adaptive) { trackMaxima(block_i); }
+    };
+    auto const move_wall = [&](size_t block_i) {
+      Block & block = blocks[block_i];
+      if (block.size() == 0) {
+        // Un bloque que se ha vaciado no puede conservar los maximos del paso anterior
+        if (adaptive) { trackMaxima(block_i); }
+        return;
+      }
+      collisions(block);
+      updateParticle(block);
+      if (adaptive) { trackMaxima(block_i); }
+      interactions(block);
+    };
+    if (pool->size() == 1) {
+      for (size_t const block_i : active_blocks) {
+        evalAccelerations(block_i);
+        move_interior(block_i);
+      }
+      for (size_t const block_i : wall_blocks) { move_wall(block_i); }
+      return;
+    }
+    for (std::vector<size_t> const & color : block_colors) {
+      pool->parallelFor(color.size(), [&](size_t i) { evalAccelerations(color[i]); });
     }
+    pool->parallelFor(active_blocks.size(), [&](size_t i) { move_interior(active_blocks[i]); });
+    pool->parallelFor(wall_blocks.size(), [&](size_t i) { move_wall(wall_blocks[i]); });
   }
 
-  void Grid::writeSimulation(std::string & filename) {
+  // Cada fase recorre todos los bloques antes de pasar a la siguiente para poder medirla por
+  // separado. El resultado es el mismo que con densityPass y accelerationPass:
+  // cuando evalDensities o evalAccelerations terminan con un bloque ya ha recibido todas sus
+  // contribuciones, y el resto de fases solo usan las particulas del propio bloque.
+  template <std::floating_point T>
+  void Grid<T>::makeProfiledSimulation() {
+    Profiler & profile = *profiler;
+    bool const parallel = pool->size() > 1;
+    // Fases por bloque y fases de pares (por colores si hay varios hilos)
+    auto const each_block = [&](auto const & task) {
+      if (parallel) {
+        pool->parallelFor(active_blocks.size(), [&](size_t i) { task(active_blocks[i]); });
+      } else {
+        for (size_t const block_i : active_blocks) { task(block_i); }
+      }
+    };
+    auto const each_wall_block = [&](auto const & task) {
+      auto const nonempty = [&](size_t block_i) {
+        if (blocks[block_i].size() != 0) { task(blocks[block_i]); }
+      };
+      if (parallel) {
+        pool->parallelFor(wall_blocks.size(), [&](size_t i) { nonempty(wall_blocks[i]); });
+      } else {
+        for (size_t const block_i : wall_blocks) { nonempty(block_i); }
+      }
+    };
+    auto const each_pair_block = [&](auto const & task) {
+      if (!parallel) {
+        each_block(task);
+        return;
+      }
+      for (std::vector<size_t> const & color : block_colors) {
+        pool->parallelFor(color.size(), [&](size_t i) { task(color[i]); });
+      }
+    };
+
+    profile.beginStep();
+    profile.time(Phase::block_assignment, [&] {
+      resetParticles();
+      assignBlocks();
+    });
+    countPairs();
+    profile.addBlocks(active_blocks.size(), blocks.size());
+    profile.time(Phase::eval_densities,
+                 [&] { each_pair_block([&](size_t block_i) { evalDensities(block_i); }); });
+    profile.time(Phase::transform_densities, [&] {
+      each_block([&](size_t block_i) { transformDensities(blocks[block_i]); });
+    });
+    profile.time(Phase::eval_accelerations,
+                 [&] { each_pair_block([&](size_t block_i) { evalAccelerations(block_i); }); });
+    profile.time(Phase::collisions,
+                 [&] { each_wall_block([&](Block & block) { collisions(block); }); });
+    profile.time(Phase::update_particle, [&] {
+      each_block([&](size_t block_i) {
+        updateParticle(blocks[block_i]);
+        if (scenario.courant > 0) { trackMaxima(block_i); }
+      });
+    });
+    profile.time(Phase::interactions,
+                 [&] { each_wall_block([&](Block & block) { interactions(block); }); });
+    profile.endStep();
+  }
+
+  // Parejas que comprueban evalDensities y evalAccelerations en este paso y cuantas estan
+  // dentro del radio de suavizado. Se calcula aparte, fuera de las fases medidas.
+  template <std::floating_point T>
+  void Grid<T>::countPairs() {
+    Vector3DArray<T> const & position = file.particles.position;
+    uint64_t tested                   = 0;
+    uint64_t inside                   = 0;
+    if (verlet_skin > 0) {
+      for (size_t particle_i = 0; particle_i + 1 < verlet_begin.size(); particle_i++) {
+        for (size_t n = verlet_begin[particle_i]; n < verlet_begin[particle_i + 1]; n++) {
+          T const d_x = position.x[particle_i] - position.x[verlet_pairs[n]];
+          T const d_y = position.y[particle_i] - position.y[verlet_pairs[n]];
+          T const d_z = position.z[particle_i] - position.z[verlet_pairs[n]];
+          inside      += d_x * d_x + d_y * d_y + d_z * d_z < smoothing_2 ? 1 : 0;
+        }
+      }
+      profiler->addPairs(verlet_pairs.size(), inside);
+      return;
+    }
+    for (size_t const block_i : active_blocks) {
+      Block const & block  = blocks[block_i];
+      size_t const table_i = block.neighbours;
+      for (size_t particle_i = block.begin; particle_i < block.end; particle_i++) {
+        for (size_t n = neighbour_begin[table_i]; n < neighbour_begin[table_i + 1]; n++) {
+          size_t const block_j = neighbour_blocks[n];
+          size_t const first_j = block_j == block_i ? particle_i + 1 : blocks[block_j].begin;
+          for (size_t particle_j = first_j; particle_j < blocks[block_j].end; particle_j++) {
+            T const d_x = position.x[particle_i] - position.x[particle_j];
+            T const d_y = position.y[particle_i] - position.y[particle_j];
+            T const d_z = position.z[particle_i] - position.z[particle_j];
+            inside      += d_x * d_x + d_y * d_y + d_z * d_z < smoothing_2 ? 1 : 0;
+          }
+          tested += blocks[block_j].end - first_j;
+        }
+      }
+    }
+    profiler->addPairs(tested, inside);
+  }
+
+  template <std::floating_point T>
+  void Grid<T>::packSimulation(std::vector<char> & bytes) const {
+    Particles<T> const & particles = file.particles;
+    bytes.resize(header_size + particles.size() * record_size);
+    auto const particles_per_meter = static_cast<float>(file.particles_per_meter);
+    auto const number_particles    = static_cast<int>(particles.size());
+    std::memcpy(bytes.data(), &particles_per_meter, sizeof(particles_per_meter));
+    std::memcpy(bytes.data() + sizeof(particles_per_meter), &number_particles,
+                sizeof(number_particles));
+    // Las particulas se escriben en el orden del fichero de entrada: la k-esima en memoria
+    // va al registro de su indice original
+    char * const records = bytes.data() + header_size;
+    for (size_t k = 0; k < particles.size(); k++) {
+      std::array<float, record_floats> const record = {
+        static_cast<float>(particles.position.x[k]),  static_cast<float>(particles.position.y[k]),
+        static_cast<float>(particles.position.z[k]),  static_cast<float>(particles.hv_vector.x[k]),
+        static_cast<float>(particles.hv_vector.y[k]), static_cast<float>(particles.hv_vector.z[k]),
+        static_cast<float>(particles.speed.x[k]),     static_cast<float>(particles.speed.y[k]),
+        static_cast<float>(particles.speed.z[k])};
+      std::memcpy(records + particles.id[k] * record_size, record.data(), record_size);
+    }
+  }
+
+  template <std::floating_point T>
+  void Grid<T>::writeSimulation(std::string & filename) {
+    packSimulation(output_buffer);
+    if (!writeBytes(filename, output_buffer, write_mode)) {
+      std::cerr << "Error: Cannot open " << filename << " for writing.\n";
+      exit(ERROR_CANNOT_OPEN_OUTPUT_FILE);
+    }
+  }
+
+  template <std::floating_point T>
+  void Grid<T>::writeSimulationStream(std::string & filename) {
     std::ofstream outfile(filename);
     write_binary_value(static_cast<float>(file.particles_per_meter), outfile);
     write_binary_value(static_cast<int>(file.particles.size()), outfile);
-    for (struct Particle const &particle : file.particles) {
-      write_binary_value(static_cast<float>(particle.position.x), outfile);
-      write_binary_value(static_cast<float>(particle.position.y), outfile);
-      write_binary_value(static_cast<float>(particle.position.z), outfile);
-      write_binary_value(static_cast<float>(particle.hv_vector.x), outfile);
-      write_binary_value(static_cast<float>(particle.hv_vector.y), outfile);
-      write_binary_value(static_cast<float>(particle.hv_vector.z), outfile);
-      write_binary_value(static_cast<float>(particle.speed.x), outfile);
-      write_binary_value(static_cast<float>(particle.speed.y), outfile);
-      write_binary_value(static_cast<float>(particle.speed.z), outfile);
-    }
-  }
-}  // namespace fluids::sim
\ No newline at end of file
+    // Las particulas se escriben en el orden del fichero de entrada
+    Particles<T> const & particles  = file.particles;
+    std::vector<size_t> const slots = particles.slots();
+    for (size_t const i : slots) {
+      write_binary_value(static_cast<float>(particles.position.x[i]), outfile);
+      write_binary_value(static_cast<float>(particles.position.y[i]), outfile);
+      write_binary_value(static_cast<float>(particles.position.z[i]), outfile);
+      write_binary_value(static_cast<float>(particles.hv_vector.x[i]), outfile);
+      write_binary_value(static_cast<float>(particles.hv_vector.y[i]), outfile);
+      write_binary_value(static_cast<float>(particles.hv_vector.z[i]), outfile);
+      write_binary_value(static_cast<float>(particles.speed.x[i]), outfile);
+      write_binary_value(static_cast<float>(particles.speed.y[i]), outfile);
+      write_binary_value(static_cast<float>(particles.speed.z[i]), outfile);
+    }
+  }
+
+  template <std::floating_point T>
+  void Grid<T>::writeSimulation(std::string const & filename, AsyncWriter & writer) {
+    packSimulation(output_buffer);
+    writer.start(filename, output_buffer);
+  }
+
+  template File<float> parseFile<float>(std::span<char const> input,
+                                       std::string const & filename);
+  template File<double> parseFile<double>(std::span<char const> input,
+                                         std::string const & filename);
+  template File<float> readFile<float>(std::string & filename);
+  template File<double> readFile<double>(std::string & filename);
+  template File<float> readFileStream<float>(std::string & filename);
+  template File<double> readFileStream<double>(std::string & filename);
+  template class Grid<float>;
+  template class Grid<double>;
+}  // namespace fluids::sim
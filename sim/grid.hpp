@@ -2,8 +2,19 @@
 #define GRID_HPP
 
 #include "block.hpp"
+#include "kernels.hpp"
+#include "options.hpp"
+#include "particles.hpp"
+#include "profiler.hpp"
+#include "thread_pool.hpp"
 #include "utils.hpp"
+#include "writer.hpp"
 
+#include <concepts>
+#include <cstdint>
+#include <memory>
+#include <span>
+#include <utility>
 #include <string>
 #include <vector>
 
@@ -24,70 +35,249 @@ namespace fluids::sim {
     requires(std::is_integral_v<T> or std::is_floating_point_v<T>)
   void write_binary_value(T value, std::ostream & os);
 
-  // Estrucutra de la particula
-  struct Particle {
-      Vector3D position     = Vector3D(0, 0, 0);      // Posicion p
-      Vector3D hv_vector    = Vector3D(0, 0, 0);      // Coordenadas del vector hv
-      Vector3D speed        = Vector3D(0, 0, 0);      // Coordenadas de la velocidad
-      double density        = 0;                      // Densidad de la particula iniciacion
-      Vector3D acceleration = external_acceleration;  // Coordenadas de la aceleracion
-  };
-
+  // T es el tipo de coma flotante de la simulacion (float o double); los ficheros .fld guardan
+  // float en ambos casos. Grid y readFile se instancian para los dos tipos en grid.cpp.
+  template <std::floating_point T>
   struct File {
-      double particles_per_meter             = 0;
-      std::vector<struct Particle> particles = std::vector<struct Particle>();
+      T particles_per_meter  = 0;
+      Particles<T> particles = Particles<T>();
   };
 
-  struct File readFile(std::string & filename);
+  // Lee un .fld proyectandolo en memoria (ver MappedFile)
+  template <std::floating_point T>
+  File<T> readFile(std::string & filename);
+
+  // Convierte la imagen en memoria de un .fld (cabecera y registros). filename solo se usa en
+  // los mensajes de error.
+  template <std::floating_point T>
+  File<T> parseFile(std::span<char const> input, std::string const & filename);
 
+  // Lectura campo a campo con std::ifstream, la version anterior a readFile. Se mantiene para
+  // comprobar readFile en las pruebas y para comparar tiempos de carga (fluidload).
+  template <std::floating_point T>
+  File<T> readFileStream(std::string & filename);
+
+  template <std::floating_point T>
   class Grid {
     public:
-      struct File file;
-      double mass;                // Masa de la particula
-      double smoothing_lenght;    // Longitud de suavizado
-      double smoothing_6;         // Longitud de suavizado a la 6
-      double smoothing_6_pi_15;   // 15 / Longitud de suavizado a la 6 * pi
-      double smoothing_6_pi;      // Longitud de suavizado a la 6 * pi
-      double smoothing_9;         // Longitud de suavizado a la 9
-      double smoothing_2;         // Longitud de suavizado a la 9
-      double pressure_rigdity_3;  // 3 * rigidez de la presion
-      double viscosity_45;        // 45 * viscosidad
-      double fluid_density_2;     // 2 * densidad del fluido
-      double time_2;              // Tiempo 2
-      double time_squared;        // Tiempo al cuadrado
-      double density_transformation_constant;
-      double viscosity_mass_h6_pi;
-      double mass_pressure;
-
-      int n_blocks_x, n_blocks_y, n_blocks_z;   // Numero de bloques en cada eje
-      Vector3D block_size = Vector3D(0, 0, 0);  // Tamaño de cada bloque en cada eje
-      std::vector<Block> blocks;                // Bloques
+      File<T> file;
+      Scenario scenario;     // Parametros fisicos y recinto (--scenario)
+      T mass;                // Masa de la particula
+      T smoothing_lenght;    // Longitud de suavizado
+      T smoothing_6;         // Longitud de suavizado a la 6
+      T smoothing_6_pi_15;   // 15 / Longitud de suavizado a la 6 * pi
+      T smoothing_6_pi;      // Longitud de suavizado a la 6 * pi
+      T smoothing_9;         // Longitud de suavizado a la 9
+      T smoothing_2;         // Longitud de suavizado a la 9
+      T pressure_rigdity_3;  // 3 * rigidez de la presion
+      T viscosity_45;        // 45 * viscosidad
+      T fluid_density_2;     // 2 * densidad del fluido
+      T time_2;              // Tiempo 2
+      T time_squared;        // Tiempo al cuadrado
+      T density_transformation_constant;
+      T viscosity_mass_h6_pi;
+      T mass_pressure;
+      PhysicalConstants<T> physics;  // Constantes de scenario en el tipo T
+      SimulationOptions options;     // Con las que se ha construido (ver reusable)
+
+      // Tiempo simulado y paso del siguiente makeSimulation. Con paso fijo (scenario.courant
+      // igual a 0) el paso es siempre scenario.time_increase, salvo si limitTimeStep lo recorta;
+      // con paso adaptativo, advanceTime lo elige al terminar cada paso (ver adaptiveTimeStep).
+      double time      = 0;
+      double time_step = 0;
+      // Solo con paso adaptativo: maximos de |hv|^2 y |a|^2 de cada bloque en el ultimo paso
+      std::vector<std::pair<T, T>> block_maxima;
+
+      int n_blocks_x, n_blocks_y, n_blocks_z;         // Numero de bloques en cada eje
+      Vector3D<T> block_size = Vector3D<T>(0, 0, 0);  // Tamaño de cada bloque en cada eje
+      std::vector<Block> blocks;                      // Bloques
+
+      // Orden de blocks (SimulationOptions::block_order). Fuera del orden lineal, block_slot
+      // da la posicion en blocks de cada indice lineal x + (y + z * n_blocks_y) * n_blocks_x.
+      BlockOrder block_order = BlockOrder::linear;
+      std::vector<size_t> block_slot;
+
+      // Bloques activos, en orden creciente: los que han tenido particulas en algun paso y sus
+      // vecinos. Todas las pasadas recorren solo estos (y saltan los vacios), asi que el coste
+      // del paso no depende de cuantos bloques vacios tenga el recinto fuera de la zona por la
+      // que se ha movido el fluido.
+      std::vector<size_t> active_blocks;
+      std::vector<size_t> entered_blocks;  // Bloques con particulas por primera vez en este paso
+      // Bloques que tocan alguna pared, agrupados por Block::walls (cada cara, arista y esquina
+      // del recinto). Solo estos pasan por collisions e interactions.
+      std::vector<size_t> wall_blocks;
+
+      // Vecinos de cada bloque que ha tenido particulas: el propio bloque y los 13 vecinos con
+      // indice mayor (media plantilla), suficientes para evaluar cada pareja una sola vez; con
+      // listas de Verlet, los de hasta verlet_reach bloques a cada lado. Los del bloque b son
+      // neighbour_blocks[neighbour_begin[t]] ... neighbour_blocks[neighbour_begin[t + 1] - 1],
+      // con t = blocks[b].neighbours. Solo crecen, y con ellos la memoria.
+      std::vector<size_t> neighbour_begin = {0};
+      std::vector<size_t> neighbour_blocks;
+      // Los mismos vecinos agrupados en tramos de bloques consecutivos [primero, ultimo], que
+      // ocupan memoria contigua y se recorren en una sola llamada de las funciones SIMD
+      std::vector<size_t> neighbour_run_begin = {0};
+      std::vector<std::pair<size_t, size_t>> neighbour_runs;
+      // Tablas al terminar el ultimo sortNeighbours y memoria para la copia
+      size_t sorted_tables = 0;
+      std::vector<size_t> sorted_begin;
+      std::vector<size_t> sorted_blocks;
+      std::vector<size_t> sorted_run_begin;
+      std::vector<std::pair<size_t, size_t>> sorted_runs;
+
+      KernelType kernel;  // Funciones de pares usadas (scalar, avx2 o avx512)
+      KernelConstants<T> kernel_constants;
+
+      // Bloques con vecinos anotados agrupados en 27 colores (x % 3, y % 3, z % 3). Dos bloques
+      // del mismo color no comparten vecinos, por lo que se pueden procesar en paralelo sin
+      // carreras. Si las listas de Verlet llegan a verlet_reach bloques, (2 * verlet_reach + 1)^3
+      // colores.
+      std::vector<std::vector<size_t>> block_colors;
+      std::unique_ptr<ThreadPool> pool;
+
+      // Memoria reutilizada en cada paso por la ordenacion de particulas por bloque
+      std::vector<size_t> particle_block;
+      std::vector<size_t> particle_order;
+      std::vector<size_t> reorder_ids;
+      std::vector<T> reorder_buffer;
+      std::vector<size_t> sorted_neighbours;  // Y por addNeighbours
+
+      // Fichero de salida empaquetado en memoria antes de escribirlo con pocas llamadas
+      WriteMode write_mode;
+      std::vector<char> output_buffer;
+
+      // Con SimulationOptions::fused (por defecto) los reinicios de densidad y aceleracion no
+      // recorren las particulas por separado (ver makeSimulation)
+      bool fused;
+
+      // Solo con SimulationOptions::pair_cache: parejas de cada bloque (en la posicion de sus
+      // vecinos, Block::neighbours) en la pasada de densidades del paso actual, en el orden en
+      // que se evaluan, y cuantas hay (las funciones SIMD escriben sobre huecos ya
+      // reservados). Cada bloque solo escribe en la suya, asi que se pueden llenar en paralelo.
+      bool use_pair_cache = false;
+      std::vector<std::vector<CachedPair<T>>> pair_cache;
+      std::vector<size_t> pair_cache_used;
+
+      // Solo con SimulationOptions::profile: makeSimulation mide cada fase por separado
+      std::unique_ptr<Profiler> profiler;
+
+      // Solo con SimulationOptions::verlet_skin > 0: parejas a menos de smoothing_lenght +
+      // verlet_skin cuando se construyo la lista, cada una una sola vez. Las de la particula i
+      // son verlet_pairs[verlet_begin[i]] ... verlet_pairs[verlet_begin[i + 1] - 1]. Las
+      // particulas no se reordenan hasta que alguna se aleja mas de medio margen de su
+      // posicion en verlet_origin; hasta entonces ninguna pareja nueva entra en el radio.
+      T verlet_skin    = 0;
+      int verlet_reach = 1;  // Bloques a cada lado en los que se buscan las parejas
+      std::vector<size_t> verlet_begin;
+      std::vector<uint32_t> verlet_pairs;
+      Vector3DArray<T> verlet_origin;
 
       void generateBlocks();
+      void addNeighbours(size_t block_i);
+
+      // Con un File<T> temporal (o std::move) la rejilla se queda con sus arrays sin copiarlos
+      Grid(File<T> & file, SimulationOptions const & options = {}, Scenario const & scenario = {});
+      Grid(File<T> && input, SimulationOptions const & options = {},
+           Scenario const & scenario = {});
+      // true si el recinto de scenario mide al menos una longitud de suavizado en cada eje, es
+      // decir, si la rejilla tiene al menos un bloque por eje. Si no, el constructor termina con
+      // ERROR_INVALID_SCENARIO.
+      [[nodiscard]] static bool fitsBox(T particles_per_meter, Scenario const & scenario);
+
+      // Constantes derivadas de scenario y file.particles_per_meter
+      void setConstants();
+      // true si next se puede simular con load en esta misma rejilla: mismas particulas por
+      // metro, opciones, recinto y multiplicador de radio (el resto del escenario puede cambiar)
+      [[nodiscard]] bool reusable(File<T> const & next, SimulationOptions const & next_options,
+                                  Scenario const & next_scenario) const;
+      // Sustituye las particulas y el escenario conservando bloques, vecinos, hilos y memoria.
+      // El resultado es el mismo que con una Grid nueva.
+      void load(File<T> const & next, Scenario const & next_scenario);
 
-      Grid(struct File & file);
+      // Cambia el paso de tiempo y las constantes que dependen de el
+      void setTimeStep(double step);
+      // Tiempo simulado a cero y primer paso: con paso adaptativo, a partir de las velocidades
+      // iniciales y la aceleracion externa
+      void resetTime();
+      // Paso adaptativo para velocidades y aceleraciones maximas |hv| y |a| (dados al cuadrado):
+      // courant * min(h / |hv|, sqrt(h / |a|)), sin pasar de limit
+      [[nodiscard]] double adaptiveTimeStep(T speed_2, T acceleration_2, double limit) const;
+      // Anota en block_maxima los maximos del bloque (tras updateParticle)
+      void trackMaxima(size_t block_i);
+      // Suma el paso al tiempo simulado y, con paso adaptativo, elige el siguiente: criterios de
+      // adaptiveTimeStep con los maximos del paso y como mucho time_step_growth veces el anterior
+      void advanceTime();
+      // Recorta el siguiente paso para no pasar de end_time
+      void limitTimeStep(double end_time);
+      // true si el tiempo simulado ha llegado a end_time (salvo redondeo de la suma de pasos)
+      [[nodiscard]] bool reachedTime(double end_time) const;
 
-      [[nodiscard]] Vector3D blockIndex(struct Particle particle) const;
-      [[nodiscard]] std::vector<Vector3D> getNeighbours(Vector3D position) const;
+      [[nodiscard]] Vector3D<T> blockIndex(Vector3D<T> const & position) const;
+      [[nodiscard]] size_t linearBlockIndex(Vector3D<T> const & position) const;
+      [[nodiscard]] size_t blockSlot(size_t linear_index) const {
+        return block_slot.empty() ? linear_index : block_slot[linear_index];
+      }
+      [[nodiscard]] PairArrays<T> pairArrays();
 
+      void resetParticles();
+      void sortParticles();
+      // Anota los vecinos de entered_blocks y los activa (parte de sortParticles)
+      void activateBlocks();
+      // Copia las tablas de vecinos en el orden de active_blocks
+      void sortNeighbours();
+      // Coloca cada particula en el tramo de su bloque (parte de sortParticles)
+      void reorderParticles();
+      // sortParticles en cada paso o, con listas de Verlet, solo al reconstruirlas
+      void assignBlocks();
+      [[nodiscard]] bool verletExpired() const;
+      void buildVerletList();
       void makeSimulation();
+      // Las dos mitades de makeSimulation sin perfil: beginStep llega hasta las densidades ya
+      // transformadas y finishStep hace el resto. Entre las dos se pueden sustituir densidades
+      // calculadas en otro proceso (ver DistributedGrid).
+      void beginStep();
+      void finishStep();
+      void densityPass();
+      void accelerationPass();
+      void makeProfiledSimulation();
+      void countPairs();
 
       void evalDensities(size_t block_i);
       void evalAccelerations(size_t block_i);
+      void evalDensitiesSimd(size_t block_i);
+      void evalAccelerationsSimd(size_t block_i);
+      void evalDensitiesVerlet(size_t block_i);
+      void evalAccelerationsVerlet(size_t block_i);
+      void evalDensitiesCached(size_t block_i);
+      void evalDensitiesCachedSimd(size_t block_i);
+      void evalAccelerationsCached(size_t block_i);
+      // Memoria reservada por pair_cache, en bytes
+      [[nodiscard]] size_t pairCacheBytes() const;
       void transformDensities(Block & block);
+      void resetAccelerations(Block & block);
       void evaluateDensities(size_t i, size_t j);
       void evaluateAccelerations(size_t i, size_t j);
-      void collisionsX(size_t index, bool x_0);
-      void collisionsY(size_t index, bool y_0);
-      void collisionsZ(size_t index, bool z_0);
+      // Contribucion de una pareja a menos del radio de suavizado con su distancia ya calculada
+      void addAccelerations(size_t i, size_t j, T distance);
+      // Choques y rebotes con la pared de bmin (Low) o de bmax del eje Axis (0 = x, 1 = y,
+      // 2 = z) de las particulas de un bloque que la toca
+      template <int Axis, bool Low>
+      void wallCollisions(Block const & block);
+      template <int Axis, bool Low>
+      void wallInteractions(Block const & block);
+      // Aplican las de las paredes de block.walls (nada en los bloques interiores)
       void collisions(Block & block);
       void updateParticle(Block & block);
-      void interactionsX(size_t index, bool x_0);
-      void interactionsY(size_t index, bool y_0);
-      void interactionsZ(size_t index, bool z_0);
       void interactions(Block & block);
 
+      // Copia la cabecera y los registros de 36 bytes del .fld en bytes, en el orden de entrada
+      void packSimulation(std::vector<char> & bytes) const;
       void writeSimulation(std::string & filename);
+      // Escritura campo a campo con std::ofstream, la version anterior a writeSimulation
+      void writeSimulationStream(std::string & filename);
+      // Empaqueta el estado actual y lo escribe en el hilo de writer mientras la simulacion
+      // continua. El resultado se comprueba con writer.wait().
+      void writeSimulation(std::string const & filename, AsyncWriter & writer);
   };
 }  // namespace fluids::sim
 #endif  // GRID_HPP
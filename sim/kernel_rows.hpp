@@ -0,0 +1,127 @@
+#ifndef KERNEL_ROWS_HPP
+#define KERNEL_ROWS_HPP
+
+#include "kernels.hpp"
+
+#include <cstddef>
+
+namespace fluids::sim {
+  // Recorridos de las funciones de pares comunes a AVX2 y AVX-512. Simd da las operaciones
+  // sobre un registro (Vec), la mascara de las posiciones validas al final de la fila (Lanes)
+  // y la mascara de las parejas dentro del radio (Mask). Solo se incluye desde las unidades
+  // compiladas con el juego de instrucciones correspondiente.
+  //
+  // Con record, cada pareja dentro del radio se anota en pairs con su distancia; devuelve
+  // cuantas se han anotado.
+  template <typename Simd, bool record = false>
+  size_t densityRow(PairArrays<typename Simd::Scalar> const & arrays, size_t i, size_t first,
+                    size_t last, KernelConstants<typename Simd::Scalar> const & constants,
+                    CachedPair<typename Simd::Scalar> * pairs = nullptr) {
+    using Vec         = typename Simd::Vec;
+    size_t recorded   = 0;
+    Vec const x_i     = Simd::set1(arrays.position_x[i]);
+    Vec const y_i     = Simd::set1(arrays.position_y[i]);
+    Vec const z_i     = Simd::set1(arrays.position_z[i]);
+    Vec const h_2     = Simd::set1(constants.smoothing_2);
+    Vec density_i     = Simd::zero();
+    for (size_t j = first; j < last; j += Simd::width) {
+      auto const lanes = Simd::lanes(last - j);
+      Vec const d_x    = Simd::sub(x_i, Simd::load(arrays.position_x + j, lanes));
+      Vec const d_y    = Simd::sub(y_i, Simd::load(arrays.position_y + j, lanes));
+      Vec const d_z    = Simd::sub(z_i, Simd::load(arrays.position_z + j, lanes));
+      Vec const distance_2 =
+          Simd::add(Simd::add(Simd::mul(d_x, d_x), Simd::mul(d_y, d_y)), Simd::mul(d_z, d_z));
+      auto const in_range = Simd::less(distance_2, h_2, lanes);
+      if (!Simd::any(in_range)) { continue; }
+      Vec const smoothing_distance = Simd::sub(h_2, distance_2);
+      Vec const increment          = Simd::select(
+          in_range,
+          Simd::mul(Simd::mul(smoothing_distance, smoothing_distance), smoothing_distance));
+      density_i = Simd::add(density_i, increment);
+      Simd::store(arrays.density + j, lanes,
+                  Simd::add(Simd::load(arrays.density + j, lanes), increment));
+      if constexpr (record) {
+        // NOLINTNEXTLINE(cppcoreguidelines-avoid-c-arrays,modernize-avoid-c-arrays)
+        typename Simd::Scalar distances[Simd::width];
+        Simd::store(distances, Simd::lanes(Simd::width), Simd::sqrt(distance_2));
+        for (unsigned bits = Simd::bits(in_range); bits != 0; bits &= bits - 1) {
+          auto const lane   = static_cast<size_t>(__builtin_ctz(bits));
+          pairs[recorded++] = {.i        = static_cast<uint32_t>(i),
+                               .j        = static_cast<uint32_t>(j + lane),
+                               .distance = distances[lane]};
+        }
+      }
+    }
+    arrays.density[i] += Simd::sum(density_i);
+    return recorded;
+  }
+
+  template <typename Simd>
+  void accelerationRow(PairArrays<typename Simd::Scalar> const & arrays, size_t i, size_t first,
+                       size_t last, KernelConstants<typename Simd::Scalar> const & constants) {
+    using Vec              = typename Simd::Vec;
+    Vec const x_i          = Simd::set1(arrays.position_x[i]);
+    Vec const y_i          = Simd::set1(arrays.position_y[i]);
+    Vec const z_i          = Simd::set1(arrays.position_z[i]);
+    Vec const speed_x_i    = Simd::set1(arrays.speed_x[i]);
+    Vec const speed_y_i    = Simd::set1(arrays.speed_y[i]);
+    Vec const speed_z_i    = Simd::set1(arrays.speed_z[i]);
+    Vec const density_i    = Simd::set1(arrays.density[i]);
+    Vec const h            = Simd::set1(constants.smoothing_lenght);
+    Vec const h_2          = Simd::set1(constants.smoothing_2);
+    Vec const min_distance = Simd::set1(constants.max_distance);
+    Vec const pressure_15  = Simd::set1(constants.smoothing_6_pi_15);
+    Vec const pressure     = Simd::set1(constants.mass_pressure);
+    Vec const density_2    = Simd::set1(constants.fluid_density_2);
+    Vec const viscosity    = Simd::set1(constants.viscosity_mass_h6_pi);
+    Vec acc_x_i            = Simd::zero();
+    Vec acc_y_i            = Simd::zero();
+    Vec acc_z_i            = Simd::zero();
+    // Mismo orden de operaciones que Grid::evaluateAccelerations. Las posiciones enmascaradas
+    // pueden dividir entre 0, pero select las descarta.
+    auto const increment = [&](auto const & in_range, Vec d, Vec speed_j, Vec kernel,
+                               Vec densities, Vec divisor, Vec speed_i) {
+      Vec const pressure_term =
+          Simd::mul(Simd::mul(Simd::mul(Simd::mul(d, pressure_15), pressure), kernel), densities);
+      Vec const viscosity_term = Simd::mul(Simd::sub(speed_j, speed_i), viscosity);
+      return Simd::select(in_range, Simd::div(Simd::add(pressure_term, viscosity_term), divisor));
+    };
+    for (size_t j = first; j < last; j += Simd::width) {
+      auto const lanes = Simd::lanes(last - j);
+      Vec const d_x    = Simd::sub(x_i, Simd::load(arrays.position_x + j, lanes));
+      Vec const d_y    = Simd::sub(y_i, Simd::load(arrays.position_y + j, lanes));
+      Vec const d_z    = Simd::sub(z_i, Simd::load(arrays.position_z + j, lanes));
+      Vec const distance = Simd::sqrt(
+          Simd::add(Simd::add(Simd::mul(d_x, d_x), Simd::mul(d_y, d_y)), Simd::mul(d_z, d_z)));
+      auto const in_range = Simd::less(Simd::mul(distance, distance), h_2, lanes);
+      if (!Simd::any(in_range)) { continue; }
+
+      Vec const density_j = Simd::load(arrays.density + j, lanes);
+      Vec const dist_ij   = Simd::max(distance, min_distance);
+      Vec const h_dist_ij = Simd::sub(h, dist_ij);
+      Vec const kernel    = Simd::div(Simd::mul(h_dist_ij, h_dist_ij), dist_ij);
+      Vec const densities = Simd::sub(Simd::add(density_i, density_j), density_2);
+      Vec const divisor   = Simd::mul(density_i, density_j);
+      Vec const inc_x     = increment(in_range, d_x, Simd::load(arrays.speed_x + j, lanes), kernel,
+                                      densities, divisor, speed_x_i);
+      Vec const inc_y     = increment(in_range, d_y, Simd::load(arrays.speed_y + j, lanes), kernel,
+                                      densities, divisor, speed_y_i);
+      Vec const inc_z     = increment(in_range, d_z, Simd::load(arrays.speed_z + j, lanes), kernel,
+                                      densities, divisor, speed_z_i);
+      acc_x_i = Simd::add(acc_x_i, inc_x);
+      acc_y_i = Simd::add(acc_y_i, inc_y);
+      acc_z_i = Simd::add(acc_z_i, inc_z);
+      Simd::store(arrays.acceleration_x + j, lanes,
+                  Simd::sub(Simd::load(arrays.acceleration_x + j, lanes), inc_x));
+      Simd::store(arrays.acceleration_y + j, lanes,
+                  Simd::sub(Simd::load(arrays.acceleration_y + j, lanes), inc_y));
+      Simd::store(arrays.acceleration_z + j, lanes,
+                  Simd::sub(Simd::load(arrays.acceleration_z + j, lanes), inc_z));
+    }
+    arrays.acceleration_x[i] += Simd::sum(acc_x_i);
+    arrays.acceleration_y[i] += Simd::sum(acc_y_i);
+    arrays.acceleration_z[i] += Simd::sum(acc_z_i);
+  }
+}  // namespace fluids::sim
+
+#endif  // KERNEL_ROWS_HPP
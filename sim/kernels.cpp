@@ -0,0 +1,32 @@
+#include "kernels.hpp"
+
+#if defined(__x86_64__) || defined(__i386__)
+  #define FLUIDS_X86 1
+#endif
+
+namespace fluids::sim {
+  KernelType selectKernel(KernelType requested) {
+#ifdef FLUIDS_X86
+    bool const avx512 = __builtin_cpu_supports("avx512f") != 0;
+    bool const avx2   = __builtin_cpu_supports("avx2") != 0;
+#else
+    bool const avx512 = false;
+    bool const avx2   = false;
+#endif
+    if ((requested == KernelType::automatic || requested == KernelType::avx512) && avx512) {
+      return KernelType::avx512;
+    }
+    if (requested != KernelType::scalar && avx2) { return KernelType::avx2; }
+    return KernelType::scalar;
+  }
+
+  std::string kernelName(KernelType kernel) {
+    switch (kernel) {
+      case KernelType::automatic: return "auto";
+      case KernelType::scalar:    return "scalar";
+      case KernelType::avx2:      return "avx2";
+      case KernelType::avx512:    return "avx512";
+    }
+    return "scalar";
+  }
+}  // namespace fluids::sim
@@ -0,0 +1,83 @@
+#ifndef KERNELS_HPP
+#define KERNELS_HPP
+
+#include "options.hpp"
+
+#include <concepts>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+namespace fluids::sim {
+  // Constantes que necesitan las funciones de pares, precalculadas por Grid
+  template <std::floating_point T>
+  struct KernelConstants {
+      T smoothing_lenght;
+      T smoothing_2;
+      T smoothing_6_pi_15;
+      T mass_pressure;
+      T fluid_density_2;
+      T viscosity_mass_h6_pi;
+      T max_distance;
+  };
+
+  // Campos de las particulas que leen y escriben las funciones de pares. Son punteros a los
+  // arrays de Particles para que las unidades compiladas con AVX no incluyan codigo inline
+  // de la biblioteca estandar (que el enlazador podria elegir para el resto del programa).
+  template <std::floating_point T>
+  struct PairArrays {
+      T const * position_x;
+      T const * position_y;
+      T const * position_z;
+      T const * speed_x;
+      T const * speed_y;
+      T const * speed_z;
+      T * density;
+      T * acceleration_x;
+      T * acceleration_y;
+      T * acceleration_z;
+  };
+
+  // Pareja dentro del radio de suavizado anotada por la pasada de densidades para que la de
+  // aceleraciones no vuelva a calcular su distancia (SimulationOptions::pair_cache)
+  template <std::floating_point T>
+  struct CachedPair {
+      uint32_t i;
+      uint32_t j;
+      T distance;
+  };
+
+  // Version soportada por la CPU mas cercana a la pedida (automatic: la mejor disponible)
+  KernelType selectKernel(KernelType requested);
+  std::string kernelName(KernelType kernel);
+
+  // Suman la contribucion de la particula i con cada particula de [first, last) en bloques de
+  // 4 (AVX2) u 8 (AVX-512) doubles, o el doble de floats. Las parejas fuera del radio de
+  // suavizado se enmascaran. La densidad se compara con distance_2 sin calcular la raiz; la
+  // aceleracion de cada pareja se calcula igual que en Grid::evaluateAccelerations, solo cambia
+  // el orden de la suma sobre i.
+  template <std::floating_point T>
+  void densityRowAvx2(PairArrays<T> const & arrays, size_t i, size_t first, size_t last,
+                      KernelConstants<T> const & constants);
+  template <std::floating_point T>
+  void accelerationRowAvx2(PairArrays<T> const & arrays, size_t i, size_t first, size_t last,
+                           KernelConstants<T> const & constants);
+  template <std::floating_point T>
+  void densityRowAvx512(PairArrays<T> const & arrays, size_t i, size_t first, size_t last,
+                        KernelConstants<T> const & constants);
+  template <std::floating_point T>
+  void accelerationRowAvx512(PairArrays<T> const & arrays, size_t i, size_t first, size_t last,
+                             KernelConstants<T> const & constants);
+
+  // Como densityRowAvx2 y densityRowAvx512, y ademas anotan en pairs (con sitio para
+  // last - first parejas) cada pareja dentro del radio con su distancia. Devuelven cuantas.
+  template <std::floating_point T>
+  size_t densityRowCachedAvx2(PairArrays<T> const & arrays, size_t i, size_t first, size_t last,
+                              KernelConstants<T> const & constants, CachedPair<T> * pairs);
+  template <std::floating_point T>
+  size_t densityRowCachedAvx512(PairArrays<T> const & arrays, size_t i, size_t first,
+                                size_t last, KernelConstants<T> const & constants,
+                                CachedPair<T> * pairs);
+}  // namespace fluids::sim
+
+#endif  // KERNELS_HPP
@@ -0,0 +1,187 @@
+#include "kernels.hpp"
+
+#ifdef __AVX2__
+  #include "kernel_rows.hpp"
+
+  #include <immintrin.h>
+  #include <type_traits>
+
+namespace fluids::sim {
+  namespace {
+    // Posiciones validas de un registro AVX2: mascara de enteros y si el registro esta completo
+    struct Avx2Lanes {
+        __m256i mask;
+        bool full;
+    };
+
+    struct Avx2Double {
+        using Scalar                  = double;
+        using Vec                     = __m256d;
+        static constexpr size_t width = 4;
+
+        static Avx2Lanes lanes(size_t n) {
+          return {.mask = _mm256_cmpgt_epi64(_mm256_set1_epi64x(static_cast<long long>(n)),
+                                             _mm256_setr_epi64x(0, 1, 2, 3)),
+                  .full = n >= width};
+        }
+
+        static Vec load(double const * values, Avx2Lanes const & lanes) {
+          return lanes.full ? _mm256_loadu_pd(values) : _mm256_maskload_pd(values, lanes.mask);
+        }
+
+        static void store(double * values, Avx2Lanes const & lanes, Vec value) {
+          if (lanes.full) {
+            _mm256_storeu_pd(values, value);
+          } else {
+            _mm256_maskstore_pd(values, lanes.mask, value);
+          }
+        }
+
+        static Vec set1(double value) { return _mm256_set1_pd(value); }
+
+        static Vec zero() { return _mm256_setzero_pd(); }
+
+        static Vec add(Vec a, Vec b) { return _mm256_add_pd(a, b); }
+
+        static Vec sub(Vec a, Vec b) { return _mm256_sub_pd(a, b); }
+
+        static Vec mul(Vec a, Vec b) { return _mm256_mul_pd(a, b); }
+
+        static Vec div(Vec a, Vec b) { return _mm256_div_pd(a, b); }
+
+        static Vec sqrt(Vec a) { return _mm256_sqrt_pd(a); }
+
+        static Vec max(Vec a, Vec b) { return _mm256_max_pd(a, b); }
+
+        static Vec less(Vec a, Vec b, Avx2Lanes const & lanes) {
+          return _mm256_and_pd(_mm256_cmp_pd(a, b, _CMP_LT_OQ), _mm256_castsi256_pd(lanes.mask));
+        }
+
+        static bool any(Vec mask) { return _mm256_movemask_pd(mask) != 0; }
+
+        static unsigned bits(Vec mask) { return static_cast<unsigned>(_mm256_movemask_pd(mask)); }
+
+        static Vec select(Vec mask, Vec value) { return _mm256_and_pd(value, mask); }
+
+        static double sum(Vec value) {
+          __m128d const low  = _mm256_castpd256_pd128(value);
+          __m128d const high = _mm256_extractf128_pd(value, 1);
+          __m128d const pair = _mm_add_pd(low, high);
+          return _mm_cvtsd_f64(_mm_add_sd(pair, _mm_unpackhi_pd(pair, pair)));
+        }
+    };
+
+    struct Avx2Float {
+        using Scalar                  = float;
+        using Vec                     = __m256;
+        static constexpr size_t width = 8;
+
+        static Avx2Lanes lanes(size_t n) {
+          int const count = n >= width ? static_cast<int>(width) : static_cast<int>(n);
+          return {.mask = _mm256_cmpgt_epi32(_mm256_set1_epi32(count),
+                                             _mm256_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7)),
+                  .full = n >= width};
+        }
+
+        static Vec load(float const * values, Avx2Lanes const & lanes) {
+          return lanes.full ? _mm256_loadu_ps(values) : _mm256_maskload_ps(values, lanes.mask);
+        }
+
+        static void store(float * values, Avx2Lanes const & lanes, Vec value) {
+          if (lanes.full) {
+            _mm256_storeu_ps(values, value);
+          } else {
+            _mm256_maskstore_ps(values, lanes.mask, value);
+          }
+        }
+
+        static Vec set1(float value) { return _mm256_set1_ps(value); }
+
+        static Vec zero() { return _mm256_setzero_ps(); }
+
+        static Vec add(Vec a, Vec b) { return _mm256_add_ps(a, b); }
+
+        static Vec sub(Vec a, Vec b) { return _mm256_sub_ps(a, b); }
+
+        static Vec mul(Vec a, Vec b) { return _mm256_mul_ps(a, b); }
+
+        static Vec div(Vec a, Vec b) { return _mm256_div_ps(a, b); }
+
+        static Vec sqrt(Vec a) { return _mm256_sqrt_ps(a); }
+
+        static Vec max(Vec a, Vec b) { return _mm256_max_ps(a, b); }
+
+        static Vec less(Vec a, Vec b, Avx2Lanes const & lanes) {
+          return _mm256_and_ps(_mm256_cmp_ps(a, b, _CMP_LT_OQ), _mm256_castsi256_ps(lanes.mask));
+        }
+
+        static bool any(Vec mask) { return _mm256_movemask_ps(mask) != 0; }
+
+        static unsigned bits(Vec mask) { return static_cast<unsigned>(_mm256_movemask_ps(mask)); }
+
+        static Vec select(Vec mask, Vec value) { return _mm256_and_ps(value, mask); }
+
+        static float sum(Vec value) {
+          __m128 const low  = _mm256_castps256_ps128(value);
+          __m128 const high = _mm256_extractf128_ps(value, 1);
+          __m128 const quad = _mm_add_ps(low, high);
+          __m128 const pair = _mm_add_ps(quad, _mm_movehl_ps(quad, quad));
+          return _mm_cvtss_f32(_mm_add_ss(pair, _mm_movehdup_ps(pair)));
+        }
+    };
+
+    template <std::floating_point T>
+    using Avx2 = std::conditional_t<std::is_same_v<T, float>, Avx2Float, Avx2Double>;
+  }  // namespace
+
+  template <std::floating_point T>
+  void densityRowAvx2(PairArrays<T> const & arrays, size_t i, size_t first, size_t last,
+                      KernelConstants<T> const & constants) {
+    densityRow<Avx2<T>>(arrays, i, first, last, constants);
+  }
+
+  template <std::floating_point T>
+  void accelerationRowAvx2(PairArrays<T> const & arrays, size_t i, size_t first, size_t last,
+                           KernelConstants<T> const & constants) {
+    accelerationRow<Avx2<T>>(arrays, i, first, last, constants);
+  }
+
+  template <std::floating_point T>
+  size_t densityRowCachedAvx2(PairArrays<T> const & arrays, size_t i, size_t first, size_t last,
+                              KernelConstants<T> const & constants, CachedPair<T> * pairs) {
+    return densityRow<Avx2<T>, true>(arrays, i, first, last, constants, pairs);
+  }
+}  // namespace fluids::sim
+#else
+namespace fluids::sim {
+  // Fuera de x86 selectKernel siempre devuelve scalar y estas funciones no se llegan a usar
+  template <std::floating_point T>
+  void densityRowAvx2(PairArrays<T> const &, size_t, size_t, size_t, KernelConstants<T> const &) { }
+
+  template <std::floating_point T>
+  void accelerationRowAvx2(PairArrays<T> const &, size_t, size_t, size_t,
+                           KernelConstants<T> const &) { }
+
+  template <std::floating_point T>
+  size_t densityRowCachedAvx2(PairArrays<T> const &, size_t, size_t, size_t,
+                              KernelConstants<T> const &, CachedPair<T> *) {
+    return 0;
+  }
+}  // namespace fluids::sim
+#endif
+
+namespace fluids::sim {
+  template void densityRowAvx2<float>(PairArrays<float> const &, size_t, size_t, size_t,
+                                      KernelConstants<float> const &);
+  template void densityRowAvx2<double>(PairArrays<double> const &, size_t, size_t, size_t,
+                                       KernelConstants<double> const &);
+  template void accelerationRowAvx2<float>(PairArrays<float> const &, size_t, size_t, size_t,
+                                           KernelConstants<float> const &);
+  template void accelerationRowAvx2<double>(PairArrays<double> const &, size_t, size_t, size_t,
+                                            KernelConstants<double> const &);
+  template size_t densityRowCachedAvx2<float>(PairArrays<float> const &, size_t, size_t, size_t,
+                                              KernelConstants<float> const &, CachedPair<float> *);
+  template size_t densityRowCachedAvx2<double>(PairArrays<double> const &, size_t, size_t, size_t,
+                                               KernelConstants<double> const &,
+                                               CachedPair<double> *);
+}  // namespace fluids::sim
@@ -0,0 +1,169 @@
+#include "kernels.hpp"
+
+#ifdef __AVX512F__
+  #include "kernel_rows.hpp"
+
+  #include <immintrin.h>
+  #include <type_traits>
+
+  // GCC 12 avisa de _mm512_undefined_pd, usado internamente por sqrt, max y reduce_add
+  #pragma GCC diagnostic push
+  #pragma GCC diagnostic ignored "-Wuninitialized"
+  #pragma GCC diagnostic ignored "-Wmaybe-uninitialized"
+
+namespace fluids::sim {
+  namespace {
+    struct Avx512Double {
+        using Scalar                  = double;
+        using Vec                     = __m512d;
+        using Mask                    = __mmask8;
+        static constexpr size_t width = 8;
+
+        static Mask lanes(size_t n) {
+          return n >= width ? static_cast<Mask>(0xFF) : static_cast<Mask>((1U << n) - 1);
+        }
+
+        static Vec load(double const * values, Mask lanes) {
+          return _mm512_maskz_loadu_pd(lanes, values);
+        }
+
+        static void store(double * values, Mask lanes, Vec value) {
+          _mm512_mask_storeu_pd(values, lanes, value);
+        }
+
+        static Vec set1(double value) { return _mm512_set1_pd(value); }
+
+        static Vec zero() { return _mm512_setzero_pd(); }
+
+        static Vec add(Vec a, Vec b) { return _mm512_add_pd(a, b); }
+
+        static Vec sub(Vec a, Vec b) { return _mm512_sub_pd(a, b); }
+
+        static Vec mul(Vec a, Vec b) { return _mm512_mul_pd(a, b); }
+
+        static Vec div(Vec a, Vec b) { return _mm512_div_pd(a, b); }
+
+        static Vec sqrt(Vec a) { return _mm512_sqrt_pd(a); }
+
+        static Vec max(Vec a, Vec b) { return _mm512_max_pd(a, b); }
+
+        static Mask less(Vec a, Vec b, Mask lanes) {
+          return _mm512_mask_cmp_pd_mask(lanes, a, b, _CMP_LT_OQ);
+        }
+
+        static bool any(Mask mask) { return mask != 0; }
+
+        static unsigned bits(Mask mask) { return mask; }
+
+        static Vec select(Mask mask, Vec value) { return _mm512_maskz_mov_pd(mask, value); }
+
+        static double sum(Vec value) { return _mm512_reduce_add_pd(value); }
+    };
+
+    struct Avx512Float {
+        using Scalar                  = float;
+        using Vec                     = __m512;
+        using Mask                    = __mmask16;
+        static constexpr size_t width = 16;
+
+        static Mask lanes(size_t n) {
+          return n >= width ? static_cast<Mask>(0xFFFF) : static_cast<Mask>((1U << n) - 1);
+        }
+
+        static Vec load(float const * values, Mask lanes) {
+          return _mm512_maskz_loadu_ps(lanes, values);
+        }
+
+        static void store(float * values, Mask lanes, Vec value) {
+          _mm512_mask_storeu_ps(values, lanes, value);
+        }
+
+        static Vec set1(float value) { return _mm512_set1_ps(value); }
+
+        static Vec zero() { return _mm512_setzero_ps(); }
+
+        static Vec add(Vec a, Vec b) { return _mm512_add_ps(a, b); }
+
+        static Vec sub(Vec a, Vec b) { return _mm512_sub_ps(a, b); }
+
+        static Vec mul(Vec a, Vec b) { return _mm512_mul_ps(a, b); }
+
+        static Vec div(Vec a, Vec b) { return _mm512_div_ps(a, b); }
+
+        static Vec sqrt(Vec a) { return _mm512_sqrt_ps(a); }
+
+        static Vec max(Vec a, Vec b) { return _mm512_max_ps(a, b); }
+
+        static Mask less(Vec a, Vec b, Mask lanes) {
+          return _mm512_mask_cmp_ps_mask(lanes, a, b, _CMP_LT_OQ);
+        }
+
+        static bool any(Mask mask) { return mask != 0; }
+
+        static unsigned bits(Mask mask) { return mask; }
+
+        static Vec select(Mask mask, Vec value) { return _mm512_maskz_mov_ps(mask, value); }
+
+        static float sum(Vec value) { return _mm512_reduce_add_ps(value); }
+    };
+
+    template <std::floating_point T>
+    using Avx512 = std::conditional_t<std::is_same_v<T, float>, Avx512Float, Avx512Double>;
+  }  // namespace
+
+  template <std::floating_point T>
+  void densityRowAvx512(PairArrays<T> const & arrays, size_t i, size_t first, size_t last,
+                        KernelConstants<T> const & constants) {
+    densityRow<Avx512<T>>(arrays, i, first, last, constants);
+  }
+
+  template <std::floating_point T>
+  void accelerationRowAvx512(PairArrays<T> const & arrays, size_t i, size_t first, size_t last,
+                             KernelConstants<T> const & constants) {
+    accelerationRow<Avx512<T>>(arrays, i, first, last, constants);
+  }
+
+  template <std::floating_point T>
+  size_t densityRowCachedAvx512(PairArrays<T> const & arrays, size_t i, size_t first,
+                                size_t last, KernelConstants<T> const & constants,
+                                CachedPair<T> * pairs) {
+    return densityRow<Avx512<T>, true>(arrays, i, first, last, constants, pairs);
+  }
+}  // namespace fluids::sim
+
+  #pragma GCC diagnostic pop
+#else
+namespace fluids::sim {
+  // Fuera de x86 selectKernel siempre devuelve scalar y estas funciones no se llegan a usar
+  template <std::floating_point T>
+  void densityRowAvx512(PairArrays<T> const &, size_t, size_t, size_t,
+                        KernelConstants<T> const &) { }
+
+  template <std::floating_point T>
+  void accelerationRowAvx512(PairArrays<T> const &, size_t, size_t, size_t,
+                             KernelConstants<T> const &) { }
+
+  template <std::floating_point T>
+  size_t densityRowCachedAvx512(PairArrays<T> const &, size_t, size_t, size_t,
+                                KernelConstants<T> const &, CachedPair<T> *) {
+    return 0;
+  }
+}  // namespace fluids::sim
+#endif
+
+namespace fluids::sim {
+  template void densityRowAvx512<float>(PairArrays<float> const &, size_t, size_t, size_t,
+                                        KernelConstants<float> const &);
+  template void densityRowAvx512<double>(PairArrays<double> const &, size_t, size_t, size_t,
+                                         KernelConstants<double> const &);
+  template void accelerationRowAvx512<float>(PairArrays<float> const &, size_t, size_t, size_t,
+                                             KernelConstants<float> const &);
+  template void accelerationRowAvx512<double>(PairArrays<double> const &, size_t, size_t, size_t,
+                                              KernelConstants<double> const &);
+  template size_t densityRowCachedAvx512<float>(PairArrays<float> const &, size_t, size_t, size_t,
+                                                KernelConstants<float> const &,
+                                                CachedPair<float> *);
+  template size_t densityRowCachedAvx512<double>(PairArrays<double> const &, size_t, size_t,
+                                                 size_t, KernelConstants<double> const &,
+                                                 CachedPair<double> *);
+}  // namespace fluids::sim
@@ -0,0 +1,35 @@
+#include "mapped_file.hpp"
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace fluids::sim {
+  MappedFile::MappedFile(std::string const & filename) {
+    int const descriptor = open(filename.c_str(), O_RDONLY | O_CLOEXEC);
+    if (descriptor < 0) { return; }
+    struct stat status { };
+    if (fstat(descriptor, &status) == 0) {
+      length = static_cast<size_t>(status.st_size);
+      opened = true;
+      if (length > 0) {
+        void * const mapping = mmap(nullptr, length, PROT_READ, MAP_PRIVATE, descriptor, 0);
+        if (mapping == MAP_FAILED) {
+          length = 0;
+          opened = false;
+        } else {
+          // Se lee de principio a fin una sola vez
+          madvise(mapping, length, MADV_SEQUENTIAL);
+          bytes = static_cast<char const *>(mapping);
+        }
+      }
+    }
+    close(descriptor);
+  }
+
+  MappedFile::~MappedFile() {
+    // NOLINTNEXTLINE(cppcoreguidelines-pro-type-const-cast)
+    if (bytes != nullptr) { munmap(const_cast<char *>(bytes), length); }
+  }
+}  // namespace fluids::sim
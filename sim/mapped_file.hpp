@@ -0,0 +1,32 @@
+#ifndef MAPPED_FILE_HPP
+#define MAPPED_FILE_HPP
+
+#include <cstddef>
+#include <string>
+
+namespace fluids::sim {
+  // Fichero proyectado en memoria solo para lectura. Si no se puede abrir, good() es false.
+  // Un fichero vacio se abre correctamente con size() == 0 y data() == nullptr.
+  class MappedFile {
+    public:
+      explicit MappedFile(std::string const & filename);
+      MappedFile(MappedFile const &)             = delete;
+      MappedFile(MappedFile &&)                  = delete;
+      MappedFile & operator=(MappedFile const &) = delete;
+      MappedFile & operator=(MappedFile &&)      = delete;
+      ~MappedFile();
+
+      [[nodiscard]] bool good() const { return opened; }
+
+      [[nodiscard]] char const * data() const { return bytes; }
+
+      [[nodiscard]] size_t size() const { return length; }
+
+    private:
+      char const * bytes = nullptr;
+      size_t length      = 0;
+      bool opened        = false;
+  };
+}  // namespace fluids::sim
+
+#endif  // MAPPED_FILE_HPP
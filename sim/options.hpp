@@ -0,0 +1,40 @@
+#ifndef OPTIONS_HPP
+#define OPTIONS_HPP
+
+namespace fluids::sim {
+  // Implementacion de las funciones de pares de particulas
+  enum class KernelType { automatic, scalar, avx2, avx512 };
+
+  // Escritura de los ficheros de salida: pwrite a traves de la cache de paginas u O_DIRECT
+  enum class WriteMode { buffered, direct };
+
+  // Compresion de los arrays de un punto de control. zlib solo esta disponible si el
+  // programa se ha compilado con FLUIDS_HAVE_ZLIB.
+  enum class Compression { none, zlib };
+
+  // Orden en que se numeran y recorren los bloques (y se ordenan las particulas): x, y, z
+  // (linear) o a lo largo de una curva de Morton o de Hilbert
+  enum class BlockOrder { linear, morton, hilbert };
+
+  // Maximo de hilos que se aceptan en --threads: cada uno reserva su pila y mas hilos que
+  // nucleos no aceleran el paso
+  constexpr unsigned int max_threads = 1024;
+
+  // Opciones de ejecucion de la simulacion que no cambian la fisica
+  struct SimulationOptions {
+      unsigned int threads = 1;                      // Hilos usados en cada paso
+      KernelType kernel    = KernelType::automatic;  // automatic: la mejor que soporte la CPU
+      WriteMode write      = WriteMode::buffered;    // Modo de escritura de writeSimulation
+      bool profile         = false;                  // Medir el tiempo de cada fase (Profiler)
+      bool fused           = true;                   // Reinicios dentro de otras pasadas
+      bool pair_cache      = false;  // Distancias de la pasada de densidad para la de aceleracion
+      double verlet_skin   = 0;  // Margen de las listas de Verlet, en longitudes de suavizado
+                                 // (0: parejas por bloques en cada paso)
+      BlockOrder block_order = BlockOrder::linear;
+      bool verbose           = true;  // Parametros de la rejilla en std::cout al construirla
+
+      bool operator==(SimulationOptions const &) const = default;
+  };
+}  // namespace fluids::sim
+
+#endif  // OPTIONS_HPP
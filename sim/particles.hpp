@@ -0,0 +1,134 @@
+#ifndef PARTICLES_HPP
+#define PARTICLES_HPP
+
+#include "utils.hpp"
+
+#include <algorithm>
+#include <cstddef>
+#include <numeric>
+#include <vector>
+
+namespace fluids::sim {
+  // La nueva posicion k toma el valor de la posicion order[k]
+  template <typename T>
+  void permute(std::vector<T> & values, std::vector<size_t> const & order, std::vector<T> & buffer) {
+    buffer.resize(values.size());
+    for (size_t k = 0; k < order.size(); k++) { buffer[k] = values[order[k]]; }
+    values.swap(buffer);
+  }
+
+  // Estrucutra de la particula
+  template <std::floating_point T>
+  struct Particle {
+      Vector3D<T> position     = Vector3D<T>(0, 0, 0);  // Posicion p
+      Vector3D<T> hv_vector    = Vector3D<T>(0, 0, 0);  // Coordenadas del vector hv
+      Vector3D<T> speed        = Vector3D<T>(0, 0, 0);  // Coordenadas de la velocidad
+      T density                = 0;                     // Densidad de la particula iniciacion
+      // Coordenadas de la aceleracion
+      Vector3D<T> acceleration = Vector3D<T>(external_acceleration);
+  };
+
+  // Tres arrays contiguos (x, y, z) para una misma magnitud vectorial
+  template <std::floating_point T>
+  struct Vector3DArray {
+      std::vector<T> x, y, z;
+
+      Vector3D<T> operator[](size_t i) const { return {x[i], y[i], z[i]}; }
+
+      void set(size_t i, Vector3D<T> const & v) {
+        x[i] = v.x;
+        y[i] = v.y;
+        z[i] = v.z;
+      }
+
+      void resize(size_t size, T value = 0) {
+        x.resize(size, value);
+        y.resize(size, value);
+        z.resize(size, value);
+      }
+
+      void reorder(std::vector<size_t> const & order, std::vector<T> & buffer) {
+        permute(x, order, buffer);
+        permute(y, order, buffer);
+        permute(z, order, buffer);
+      }
+  };
+
+  // Particulas en formato estructura de arrays: cada pasada solo recorre los campos que usa.
+  // La simulacion las reordena por bloque; id guarda el indice original de cada posicion.
+  template <std::floating_point T>
+  class Particles {
+    public:
+      Vector3DArray<T> position;      // Posicion p
+      Vector3DArray<T> hv_vector;     // Coordenadas del vector hv
+      Vector3DArray<T> speed;         // Coordenadas de la velocidad
+      Vector3DArray<T> acceleration;  // Coordenadas de la aceleracion
+      std::vector<T> density;
+      std::vector<size_t> id;  // Indice original (orden del fichero) de cada particula
+
+      [[nodiscard]] size_t size() const { return density.size(); }
+
+      void resize(size_t size) {
+        size_t const first = std::min(id.size(), size);
+        id.resize(size);
+        std::iota(id.begin() + static_cast<std::ptrdiff_t>(first), id.end(), first);
+        position.resize(size);
+        hv_vector.resize(size);
+        speed.resize(size);
+        acceleration.x.resize(size, static_cast<T>(external_acceleration.x));
+        acceleration.y.resize(size, static_cast<T>(external_acceleration.y));
+        acceleration.z.resize(size, static_cast<T>(external_acceleration.z));
+        density.resize(size, 0);
+      }
+
+      [[nodiscard]] Particle<T> get(size_t i) const {
+        return {.position     = position[i],
+                .hv_vector    = hv_vector[i],
+                .speed        = speed[i],
+                .density      = density[i],
+                .acceleration = acceleration[i]};
+      }
+
+      void set(size_t i, Particle<T> const & particle) {
+        position.set(i, particle.position);
+        hv_vector.set(i, particle.hv_vector);
+        speed.set(i, particle.speed);
+        acceleration.set(i, particle.acceleration);
+        density[i] = particle.density;
+      }
+
+      void push_back(Particle<T> const & particle) {
+        resize(size() + 1);
+        set(size() - 1, particle);
+      }
+
+      // Posicion actual de cada particula segun su indice original
+      [[nodiscard]] std::vector<size_t> slots() const {
+        std::vector<size_t> slot(id.size());
+        for (size_t k = 0; k < id.size(); k++) { slot[id[k]] = k; }
+        return slot;
+      }
+
+      void reorder(std::vector<size_t> const & order, std::vector<T> & buffer,
+                   std::vector<size_t> & id_buffer) {
+        position.reorder(order, buffer);
+        hv_vector.reorder(order, buffer);
+        speed.reorder(order, buffer);
+        acceleration.reorder(order, buffer);
+        permute(density, order, buffer);
+        permute(id, order, id_buffer);
+      }
+
+      // Solo los campos que pasan de un paso al siguiente; densidad y aceleracion se quedan
+      // como estan porque se vuelven a calcular desde cero
+      void reorderState(std::vector<size_t> const & order, std::vector<T> & buffer,
+                        std::vector<size_t> & id_buffer) {
+        position.reorder(order, buffer);
+        hv_vector.reorder(order, buffer);
+        speed.reorder(order, buffer);
+        permute(id, order, id_buffer);
+      }
+  };
+}  // namespace fluids::sim
+
+#endif  // PARTICLES_HPP
@@ -0,0 +1,150 @@
+#include "profiler.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <fstream>
+#include <iomanip>
+
+namespace fluids::sim {
+  namespace {
+    constexpr std::array<char const *, n_phases> phase_names = {
+      "blockAssignment", "evalDensities",   "transformDensities", "evalAccelerations",
+      "collisions",      "updateParticle", "interactions"};
+
+    double milliseconds(Profiler::Clock::duration duration) {
+      return std::chrono::duration<double, std::milli>(duration).count();
+    }
+
+    double microseconds(Profiler::Clock::duration duration) {
+      return std::chrono::duration<double, std::micro>(duration).count();
+    }
+
+    // Media, mediana y percentil 99 (por rango mas cercano)
+    struct Statistics {
+        double mean;
+        double p50;
+        double p99;
+    };
+
+    Statistics statistics(std::vector<double> values) {
+      if (values.empty()) { return {.mean = 0, .p50 = 0, .p99 = 0}; }
+      std::sort(values.begin(), values.end());
+      double sum = 0;
+      for (double const value : values) { sum += value; }
+      auto const rank = [&](double percentile) {
+        auto const index = static_cast<size_t>(
+            std::ceil(percentile * static_cast<double>(values.size()) / 100.0));
+        return values[std::max<size_t>(index, 1) - 1];
+      };
+      // NOLINTNEXTLINE(cppcoreguidelines-avoid-magic-numbers,readability-magic-numbers)
+      return {.mean = sum / static_cast<double>(values.size()), .p50 = rank(50), .p99 = rank(99)};
+    }
+  }  // namespace
+
+  char const * phaseName(Phase phase) { return phase_names.at(static_cast<size_t>(phase)); }
+
+  void Profiler::beginStep() {
+    step_times.push_back({});
+    step_start = Clock::now();
+  }
+
+  // El total del paso es la suma de sus fases: no incluye el recuento de parejas de Grid
+  void Profiler::endStep() {
+    double total = 0;
+    for (double const phase : step_times.back()) { total += phase; }
+    step_totals.push_back(total);
+    step_spans.emplace_back(step_start, Clock::now());
+  }
+
+  void Profiler::record(Phase phase, Clock::time_point start, Clock::time_point end) {
+    step_times.back().at(static_cast<size_t>(phase)) += milliseconds(end - start);
+    events.push_back({.phase = phase, .start = start, .end = end});
+  }
+
+  void Profiler::addPairs(uint64_t tested, uint64_t inside) {
+    pairs_tested += tested;
+    pairs_inside += inside;
+  }
+
+  double Profiler::phaseTime(size_t step, Phase phase) const {
+    return step_times.at(step).at(static_cast<size_t>(phase));
+  }
+
+  void Profiler::printSummary(std::ostream & output) const {
+    constexpr int name_width   = 20;
+    constexpr int column_width = 11;
+    output << std::fixed << std::setprecision(3);
+    output << "Profile (" << steps() << " steps, ms per step)\n";
+    output << std::left << std::setw(name_width) << "Phase" << std::right
+           << std::setw(column_width) << "mean" << std::setw(column_width) << "p50"
+           << std::setw(column_width) << "p99" << std::setw(column_width) << "% step" << "\n";
+    Statistics const total = statistics(step_totals);
+    auto const row = [&](char const * name, Statistics const & values) {
+      // NOLINTNEXTLINE(cppcoreguidelines-avoid-magic-numbers,readability-magic-numbers)
+      double const share = total.mean > 0 ? 100 * values.mean / total.mean : 0;
+      output << std::left << std::setw(name_width) << name << std::right
+             << std::setw(column_width) << values.mean << std::setw(column_width) << values.p50
+             << std::setw(column_width) << values.p99 << std::setw(column_width) << share << "\n";
+    };
+    for (size_t phase = 0; phase < n_phases; phase++) {
+      std::vector<double> values(step_times.size());
+      for (size_t step = 0; step < step_times.size(); step++) {
+        values[step] = step_times[step][phase];
+      }
+      row(phase_names.at(phase), statistics(values));
+    }
+    row("step", total);
+    if (steps() > 0) {
+      double const per_step = 1.0 / static_cast<double>(steps());
+      output << "Pair tests per step: " << std::setprecision(0)
+             << static_cast<double>(pairs_tested) * per_step
+             << ", inside smoothing radius: " << static_cast<double>(pairs_inside) * per_step
+             << std::setprecision(1) << " ("
+             // NOLINTNEXTLINE(cppcoreguidelines-avoid-magic-numbers,readability-magic-numbers)
+             << (pairs_tested > 0 ? 100.0 * static_cast<double>(pairs_inside) /
+                                        static_cast<double>(pairs_tested)
+                                  : 0.0)
+             << " %)\n";
+      if (blocks_total > 0) {
+        output << "Active blocks per step: " << std::setprecision(0)
+               << static_cast<double>(blocks_active) * per_step << " of " << blocks_total
+               << std::setprecision(1) << " ("
+               // NOLINTNEXTLINE(cppcoreguidelines-avoid-magic-numbers,readability-magic-numbers)
+               << 100.0 * static_cast<double>(blocks_active) * per_step /
+                      static_cast<double>(blocks_total)
+               << " %)\n";
+      }
+      if (list_builds > 0) {
+        output << "Verlet list builds: " << list_builds << " (one every " << std::setprecision(1)
+               << static_cast<double>(steps()) / static_cast<double>(list_builds) << " steps)\n";
+      }
+    }
+    output << std::defaultfloat << std::setprecision(6);
+  }
+
+  bool Profiler::writeTrace(std::string const & filename) const {
+    std::ofstream trace(filename);
+    if (!trace.good()) { return false; }
+    trace << std::fixed << std::setprecision(3);
+    trace << "{\"displayTimeUnit\": \"ms\", \"traceEvents\": [\n";
+    bool first = true;
+    auto const event = [&](std::string const & name, Clock::time_point start,
+                           Clock::time_point end, size_t step) {
+      trace << (first ? "" : ",\n") << R"({"name": ")" << name
+            << R"(", "cat": "fluid", "ph": "X", "pid": 0, "tid": 0, "ts": )"
+            << microseconds(start - origin) << ", \"dur\": " << microseconds(end - start)
+            << ", \"args\": {\"step\": " << step << "}}";
+      first = false;
+    };
+    size_t step = 0;
+    for (size_t i = 0; i < step_spans.size(); i++) {
+      event("step " + std::to_string(i + 1), step_spans[i].first, step_spans[i].second, i + 1);
+    }
+    for (Event const & phase : events) {
+      while (step + 1 < step_spans.size() && phase.start >= step_spans[step + 1].first) { step++; }
+      event(phaseName(phase.phase), phase.start, phase.end, step + 1);
+    }
+    trace << "\n]}\n";
+    return trace.good();
+  }
+}  // namespace fluids::sim
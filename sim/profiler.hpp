@@ -0,0 +1,89 @@
+#ifndef PROFILER_HPP
+#define PROFILER_HPP
+
+#include <array>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <ostream>
+#include <string>
+#include <vector>
+
+namespace fluids::sim {
+  // Fases de un paso de la simulacion, en el orden en que se ejecutan
+  enum class Phase : std::uint8_t {
+    block_assignment,
+    eval_densities,
+    transform_densities,
+    eval_accelerations,
+    collisions,
+    update_particle,
+    interactions
+  };
+
+  constexpr size_t n_phases = 7;
+
+  char const * phaseName(Phase phase);
+
+  // Tiempos de cada fase en cada paso y parejas de particulas evaluadas. Grid solo lo usa con
+  // --profile; sin el, makeSimulation no toma ningun tiempo.
+  class Profiler {
+    public:
+      using Clock = std::chrono::steady_clock;
+
+      void beginStep();
+      void endStep();
+
+      // Ejecuta task y anota su duracion como la fase phase del paso actual
+      template <typename Task>
+      void time(Phase phase, Task && task) {
+        Clock::time_point const start = Clock::now();
+        task();
+        record(phase, start, Clock::now());
+      }
+
+      // Parejas comprobadas por las funciones de pares y parejas dentro del radio de
+      // suavizado en el paso actual
+      void addPairs(uint64_t tested, uint64_t inside);
+      // Reconstruccion de las listas de Verlet en el paso actual
+      void addListBuild() { list_builds++; }
+      // Bloques activos en el paso actual (ver Grid::active_blocks) y bloques del recinto
+      void addBlocks(uint64_t active, uint64_t total) {
+        blocks_active += active;
+        blocks_total   = total;
+      }
+
+      [[nodiscard]] size_t steps() const { return step_times.size(); }
+
+      // Tiempo en ms de la fase en el paso step
+      [[nodiscard]] double phaseTime(size_t step, Phase phase) const;
+
+      // Media, mediana y percentil 99 por paso de cada fase y del paso completo, y parejas
+      void printSummary(std::ostream & output) const;
+      // Traza en el formato JSON de chrome://tracing y Perfetto. false si no se puede escribir.
+      bool writeTrace(std::string const & filename) const;
+
+    private:
+      struct Event {
+          Phase phase;
+          Clock::time_point start;
+          Clock::time_point end;
+      };
+
+      void record(Phase phase, Clock::time_point start, Clock::time_point end);
+
+      Clock::time_point origin = Clock::now();  // Inicio de la traza
+      Clock::time_point step_start;
+      std::vector<std::array<double, n_phases>> step_times;  // ms de cada fase por paso
+      std::vector<double> step_totals;                       // ms de cada paso
+      std::vector<std::pair<Clock::time_point, Clock::time_point>> step_spans;
+      std::vector<Event> events;
+      uint64_t pairs_tested = 0;
+      uint64_t pairs_inside = 0;
+      uint64_t list_builds  = 0;
+      uint64_t blocks_active = 0;
+      uint64_t blocks_total  = 0;
+  };
+}  // namespace fluids::sim
+
+#endif  // PROFILER_HPP
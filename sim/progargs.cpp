@@ -1,7 +1,9 @@
 #include "progargs.hpp"
 
+#include "scenario.hpp"
 #include "utils.hpp"
 
+#include <cmath>
 #include <fstream>
 #include <iostream>
 #include <utility>
@@ -11,48 +13,357 @@ namespace fluids::sim {
   ProgramArguments::ProgramArguments(int argc, std::vector<std::string> argv)
     : argc(argc), argv(std::move(argv)) { }
 
+  // Argumentos que no son opciones "--nombre valor"
+  std::vector<std::string> ProgramArguments::positionalArguments() const {
+    std::vector<std::string> positional;
+    for (size_t i = 1; i < argv.size(); i++) {
+      if (argv[i].starts_with("--")) {
+        i++;  // Salta el valor de la opcion
+        continue;
+      }
+      positional.push_back(argv[i]);
+    }
+    return positional;
+  }
+
   struct Configuration ProgramArguments::parseArguments() {
     struct Configuration config { };
 
-    config.nts        = static_cast<uint16_t>(std::stoi(argv[1]));
-    config.inputFile  = argv[2];
-    config.outputFile = argv[3];
+    std::vector<std::string> const positional = positionalArguments();
+    config.nts            = std::stoll(positional[0]);
+    config.inputFile      = positional[1];
+    config.outputFile     = positional[2];
+    config.snapshotFile   = config.outputFile + ".trj";
+    config.checkpointFile = config.outputFile + ".chk";
+
+    double courant = 0;
+    for (size_t i = 1; i + 1 < argv.size(); i++) {
+      if (argv[i] == "--threads") {
+        config.options.threads = std::stoul(argv[++i]);
+      } else if (argv[i] == "--kernel") {
+        config.options.kernel = ParseKernel(argv[++i]);
+      } else if (argv[i] == "--write") {
+        config.options.write = ParseWriteMode(argv[++i]);
+      } else if (argv[i] == "--block-order") {
+        config.options.block_order = ParseBlockOrder(argv[++i]);
+      } else if (argv[i] == "--snapshot-every") {
+        config.snapshotEvery = ParseStepInterval(argv[++i]);
+      } else if (argv[i] == "--snapshot-file") {
+        config.snapshotFile = argv[++i];
+      } else if (argv[i] == "--checkpoint-every") {
+        config.checkpointEvery = ParseStepInterval(argv[++i]);
+      } else if (argv[i] == "--checkpoint-file") {
+        config.checkpointFile = argv[++i];
+      } else if (argv[i] == "--checkpoint-compression") {
+        config.checkpointCompression = ParseCompression(argv[++i]);
+      } else if (argv[i] == "--profile") {
+        config.options.profile = argv[++i] == "on" || config.options.profile;
+      } else if (argv[i] == "--profile-trace") {
+        config.profileTrace    = argv[++i];
+        config.options.profile = true;
+      } else if (argv[i] == "--fuse") {
+        config.options.fused = argv[++i] == "on";
+      } else if (argv[i] == "--pair-cache") {
+        config.options.pair_cache = argv[++i] == "on";
+      } else if (argv[i] == "--verlet-skin") {
+        config.options.verlet_skin = std::stod(argv[++i]);
+      } else if (argv[i] == "--scenario") {
+        config.scenario = ParseScenario(argv[++i]);
+      } else if (argv[i] == "--time") {
+        config.targetTime = std::stod(argv[++i]);
+      } else if (argv[i] == "--adaptive") {
+        courant = std::stod(argv[++i]);
+      }
+    }
+    // --adaptive tiene prioridad sobre el courant del escenario, este antes o despues
+    if (courant > 0) { config.scenario.courant = courant; }
 
     return config;
   }
 
   int CheckNSteps(std::string const & nts) {
     try {
-      if (std::stoi(nts) <= 0) {
+      if (std::stoll(nts) <= 0) {
         std::cerr << "Error: Invalid number of time steps.\n";
         return ERROR_INVALID_NUMBER_TIME_STEPS;
       }
     } catch (std::invalid_argument const & ia) {
       std::cerr << "Error: time steps must be numeric.\n";
       return ERROR_INVALID_TIME_STEPS;
+    } catch (std::out_of_range const & oor) {
+      std::cerr << "Error: Invalid number of time steps.\n";
+      return ERROR_INVALID_NUMBER_TIME_STEPS;
+    }
+    return 0;
+  }
+
+  int CheckThreads(std::string const & threads) {
+    try {
+      int const value = std::stoi(threads);
+      if (value <= 0) {
+        std::cerr << "Error: Invalid number of threads.\n";
+        return ERROR_INVALID_OPTION;
+      }
+      if (value > static_cast<int>(max_threads)) {
+        std::cerr << "Error: Too many threads (at most " << max_threads << ").\n";
+        return ERROR_INVALID_OPTION;
+      }
+    } catch (std::invalid_argument const & ia) {
+      std::cerr << "Error: threads must be numeric.\n";
+      return ERROR_INVALID_OPTION;
+    } catch (std::out_of_range const & oor) {
+      std::cerr << "Error: Invalid number of threads.\n";
+      return ERROR_INVALID_OPTION;
+    }
+    return 0;
+  }
+
+  namespace {
+    int CheckStepInterval(std::string const & steps, std::string const & option) {
+      try {
+        if (std::stoi(steps) <= 0) {
+          std::cerr << "Error: Invalid " << option << " interval.\n";
+          return ERROR_INVALID_OPTION;
+        }
+      } catch (std::invalid_argument const & ia) {
+        std::cerr << "Error: " << option << " interval must be numeric.\n";
+        return ERROR_INVALID_OPTION;
+      } catch (std::out_of_range const & oor) {
+        std::cerr << "Error: Invalid " << option << " interval.\n";
+        return ERROR_INVALID_OPTION;
+      }
+      return 0;
+    }
+
+    int CheckSwitch(std::string const & value, std::string const & option) {
+      if (value != "on" && value != "off") {
+        std::cerr << "Error: " << option << " must be on or off.\n";
+        return ERROR_INVALID_OPTION;
+      }
+      return 0;
+    }
+  }  // namespace
+
+  // Solo despues de CheckSnapshotEvery o CheckCheckpointEvery: mismo rango que la comprobacion
+  unsigned int ParseStepInterval(std::string const & steps) {
+    return static_cast<unsigned int>(std::stoi(steps));
+  }
+
+  int CheckSnapshotEvery(std::string const & steps) { return CheckStepInterval(steps, "snapshot"); }
+
+  int CheckCheckpointEvery(std::string const & steps) {
+    return CheckStepInterval(steps, "checkpoint");
+  }
+
+  Compression ParseCompression(std::string const & compression) {
+    if (compression == "zlib") { return Compression::zlib; }
+    return Compression::none;
+  }
+
+  int CheckCompression(std::string const & compression) {
+#ifdef FLUIDS_HAVE_ZLIB
+    if (compression != "none" && compression != "zlib") {
+      std::cerr << "Error: checkpoint compression must be none or zlib.\n";
+      return ERROR_INVALID_OPTION;
+    }
+#else
+    if (compression != "none") {
+      std::cerr << "Error: checkpoint compression must be none (built without zlib).\n";
+      return ERROR_INVALID_OPTION;
+    }
+#endif
+    return 0;
+  }
+
+  int CheckProfile(std::string const & profile) { return CheckSwitch(profile, "profile"); }
+
+  int CheckFuse(std::string const & fuse) { return CheckSwitch(fuse, "fuse"); }
+
+  int CheckPairCache(std::string const & cache) { return CheckSwitch(cache, "pair cache"); }
+
+  // Como mucho una longitud de suavizado: entre reconstrucciones de la lista las particulas no
+  // cambian de bloque, y ninguna debe poder llegar a una pared desde un bloque interior
+  int CheckVerletSkin(std::string const & skin) {
+    try {
+      double const value = std::stod(skin);
+      if (!(value >= 0 && value <= 1)) {
+        std::cerr << "Error: verlet skin must be between 0 and 1.\n";
+        return ERROR_INVALID_OPTION;
+      }
+    } catch (std::invalid_argument const & ia) {
+      std::cerr << "Error: verlet skin must be numeric.\n";
+      return ERROR_INVALID_OPTION;
+    } catch (std::out_of_range const & oor) {
+      std::cerr << "Error: verlet skin must be between 0 and 1.\n";
+      return ERROR_INVALID_OPTION;
     }
     return 0;
   }
 
+  KernelType ParseKernel(std::string const & kernel) {
+    if (kernel == "scalar") { return KernelType::scalar; }
+    if (kernel == "avx2") { return KernelType::avx2; }
+    if (kernel == "avx512") { return KernelType::avx512; }
+    return KernelType::automatic;
+  }
+
+  int CheckKernel(std::string const & kernel) {
+    if (kernel != "auto" && kernel != "scalar" && kernel != "avx2" && kernel != "avx512") {
+      std::cerr << "Error: kernel must be auto, scalar, avx2 or avx512.\n";
+      return ERROR_INVALID_OPTION;
+    }
+    return 0;
+  }
+
+  WriteMode ParseWriteMode(std::string const & mode) {
+    if (mode == "direct") { return WriteMode::direct; }
+    return WriteMode::buffered;
+  }
+
+  int CheckWriteMode(std::string const & mode) {
+    if (mode != "buffered" && mode != "direct") {
+      std::cerr << "Error: write must be buffered or direct.\n";
+      return ERROR_INVALID_OPTION;
+    }
+    return 0;
+  }
+
+  int CheckBlockOrder(std::string const & order) {
+    if (order != "linear" && order != "morton" && order != "hilbert") {
+      std::cerr << "Error: block order must be linear, morton or hilbert.\n";
+      return ERROR_INVALID_OPTION;
+    }
+    return 0;
+  }
+
+  BlockOrder ParseBlockOrder(std::string const & order) {
+    if (order == "morton") { return BlockOrder::morton; }
+    if (order == "hilbert") { return BlockOrder::hilbert; }
+    return BlockOrder::linear;
+  }
+
+  int CheckTargetTime(std::string const & time) {
+    try {
+      double const value = std::stod(time);
+      if (!(value > 0) || !std::isfinite(value)) {
+        std::cerr << "Error: Invalid simulated time.\n";
+        return ERROR_INVALID_OPTION;
+      }
+    } catch (std::invalid_argument const & ia) {
+      std::cerr << "Error: simulated time must be numeric.\n";
+      return ERROR_INVALID_OPTION;
+    } catch (std::out_of_range const & oor) {
+      std::cerr << "Error: Invalid simulated time.\n";
+      return ERROR_INVALID_OPTION;
+    }
+    return 0;
+  }
+
+  // Numero de Courant del paso adaptativo (ver Grid::adaptiveTimeStep)
+  int CheckAdaptive(std::string const & courant) {
+    try {
+      double const value = std::stod(courant);
+      if (!(value > 0) || value > 1) {
+        std::cerr << "Error: courant number must be greater than 0 and at most 1.\n";
+        return ERROR_INVALID_OPTION;
+      }
+    } catch (std::invalid_argument const & ia) {
+      std::cerr << "Error: courant number must be numeric.\n";
+      return ERROR_INVALID_OPTION;
+    } catch (std::out_of_range const & oor) {
+      std::cerr << "Error: courant number must be greater than 0 and at most 1.\n";
+      return ERROR_INVALID_OPTION;
+    }
+    return 0;
+  }
+
+  int CheckScenario(std::string const & filename) {
+    Scenario scenario;
+    return readScenario(filename, scenario);
+  }
+
+  // Solo despues de CheckScenario: los errores ya se han comprobado
+  Scenario ParseScenario(std::string const & filename) {
+    Scenario scenario;
+    readScenario(filename, scenario);
+    return scenario;
+  }
+
+  void ProgramArguments::correctOptions() const {
+    for (size_t i = 1; i < argv.size(); i++) {
+      if (!argv[i].starts_with("--")) { continue; }
+      if (i + 1 >= argv.size()) {
+        std::cerr << "Error: Missing value for option " << argv[i] << ".\n";
+        exit(ERROR_INVALID_OPTION);
+      }
+      int status = 0;
+      if (argv[i] == "--threads") {
+        status = CheckThreads(argv[i + 1]);
+      } else if (argv[i] == "--kernel") {
+        status = CheckKernel(argv[i + 1]);
+      } else if (argv[i] == "--write") {
+        status = CheckWriteMode(argv[i + 1]);
+      } else if (argv[i] == "--block-order") {
+        status = CheckBlockOrder(argv[i + 1]);
+      } else if (argv[i] == "--snapshot-every") {
+        status = CheckSnapshotEvery(argv[i + 1]);
+      } else if (argv[i] == "--checkpoint-every") {
+        status = CheckCheckpointEvery(argv[i + 1]);
+      } else if (argv[i] == "--checkpoint-compression") {
+        status = CheckCompression(argv[i + 1]);
+      } else if (argv[i] == "--profile") {
+        status = CheckProfile(argv[i + 1]);
+      } else if (argv[i] == "--fuse") {
+        status = CheckFuse(argv[i + 1]);
+      } else if (argv[i] == "--pair-cache") {
+        status = CheckPairCache(argv[i + 1]);
+      } else if (argv[i] == "--verlet-skin") {
+        status = CheckVerletSkin(argv[i + 1]);
+      } else if (argv[i] == "--scenario") {
+        status = CheckScenario(argv[i + 1]);
+      } else if (argv[i] == "--time") {
+        status = CheckTargetTime(argv[i + 1]);
+      } else if (argv[i] == "--adaptive") {
+        status = CheckAdaptive(argv[i + 1]);
+      } else if (argv[i] == "--snapshot-file" || argv[i] == "--checkpoint-file" ||
+                 argv[i] == "--profile-trace") {
+        status = 0;
+      } else {
+        std::cerr << "Error: Unknown option " << argv[i] << ".\n";
+        status = ERROR_INVALID_OPTION;
+      }
+      if (status != 0) { exit(status); }
+      i++;
+    }
+  }
+
   void ProgramArguments::correctArguments() {
-    if (this->argc != 4) {
-      std::cerr << "Error: Invalid number of arguments: " << this->argc - 1 << ".\n";
+    std::vector<std::string> const positional = positionalArguments();
+    if (positional.size() != 3) {
+      std::cerr << "Error: Invalid number of arguments: " << positional.size() << ".\n";
       exit(ERROR_INVALID_NUMBER_ARGUMENTS);
     }
-    int const status = CheckNSteps(this->argv[1]);
+    int const status = CheckNSteps(positional[0]);
     if (status != 0) { exit(status); }
-    std::ifstream inputFile(this->argv[2]);
+    correctOptions();
+    std::ifstream inputFile(positional[1]);
     if (!inputFile.good()) {
-      std::cerr << "Error: Cannot open " << this->argv[2] << " for reading.\n";
+      std::cerr << "Error: Cannot open " << positional[1] << " for reading.\n";
       exit(ERROR_CANNOT_OPEN_INPUT_FILE);
     }
     inputFile.close();
     // Check that output file doesn't exist
-    std::ifstream outputFile(this->argv[3]);
+    std::ifstream outputFile(positional[2]);
     if (outputFile.good()) {
-      std::cerr << "Error: Cannot open " << this->argv[3] << " for writing.\n";
+      std::cerr << "Error: Cannot open " << positional[2] << " for writing.\n";
       exit(ERROR_CANNOT_OPEN_OUTPUT_FILE);
     }
     outputFile.close();
+    // La trayectoria tampoco puede sobrescribir un fichero existente
+    Configuration const config = parseArguments();
+    if (config.snapshotEvery > 0 && std::ifstream(config.snapshotFile).good()) {
+      std::cerr << "Error: Cannot open " << config.snapshotFile << " for writing.\n";
+      exit(ERROR_CANNOT_OPEN_OUTPUT_FILE);
+    }
   }
 }  // namespace fluids::sim
\ No newline at end of file
@@ -1,14 +1,26 @@
 #ifndef PROGARGS_HPP
 #define PROGARGS_HPP
+#include "options.hpp"
+#include "utils.hpp"
+
 #include <cstdint>
 #include <string>
 #include <vector>
 
 namespace fluids::sim {
   struct Configuration {
-      uint16_t nts;
-      std::string inputFile;
+      int64_t nts;
+      std::string inputFile;  // .fld o punto de control (ver isCheckpoint)
       std::string outputFile;
+      SimulationOptions options;
+      Scenario scenario;  // Valores por defecto o los del fichero de --scenario
+      unsigned int snapshotEvery = 0;    // Pasos entre fotogramas de la trayectoria (0: ninguno)
+      std::string snapshotFile;          // Por defecto, outputFile + ".trj"
+      unsigned int checkpointEvery = 0;  // Pasos entre puntos de control (0: ninguno)
+      std::string checkpointFile;        // Por defecto, outputFile + ".chk"
+      Compression checkpointCompression = Compression::none;
+      std::string profileTrace;  // Traza JSON de --profile-trace (vacio: ninguna)
+      double targetTime = 0;     // Tiempo simulado de --time (0: nts pasos; si no, nts maximo)
   };
 
   class ProgramArguments {
@@ -22,8 +34,30 @@ namespace fluids::sim {
       void correctArguments();
 
     private:
+      [[nodiscard]] std::vector<std::string> positionalArguments() const;
+      void correctOptions() const;
   };
 
   int CheckNSteps(std::string const & nts);
+  int CheckThreads(std::string const & threads);
+  int CheckSnapshotEvery(std::string const & steps);
+  int CheckCheckpointEvery(std::string const & steps);
+  unsigned int ParseStepInterval(std::string const & steps);
+  int CheckCompression(std::string const & compression);
+  Compression ParseCompression(std::string const & compression);
+  int CheckProfile(std::string const & profile);
+  int CheckFuse(std::string const & fuse);
+  int CheckPairCache(std::string const & cache);
+  int CheckVerletSkin(std::string const & skin);
+  int CheckKernel(std::string const & kernel);
+  KernelType ParseKernel(std::string const & kernel);
+  int CheckWriteMode(std::string const & mode);
+  WriteMode ParseWriteMode(std::string const & mode);
+  int CheckBlockOrder(std::string const & order);
+  BlockOrder ParseBlockOrder(std::string const & order);
+  int CheckTargetTime(std::string const & time);
+  int CheckAdaptive(std::string const & courant);
+  int CheckScenario(std::string const & filename);
+  Scenario ParseScenario(std::string const & filename);
 }  // namespace fluids::sim
 #endif  // PROGARGS_HPP
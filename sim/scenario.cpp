@@ -0,0 +1,126 @@
+#include "scenario.hpp"
+
+#include <array>
+#include <cmath>
+#include <fstream>
+#include <iostream>
+#include <map>
+#include <span>
+#include <sstream>
+
+namespace fluids::sim {
+  namespace {
+    // Lee exactamente values.size() numeros finitos de text
+    bool parseValues(std::string const & text, std::span<double> values) {
+      std::istringstream stream(text);
+      for (double & value : values) {
+        if (!(stream >> value) || !std::isfinite(value)) { return false; }
+      }
+      return (stream >> std::ws).eof();
+    }
+
+    std::string trim(std::string const & text) {
+      size_t const first = text.find_first_not_of(" \t\r");
+      if (first == std::string::npos) { return ""; }
+      return text.substr(first, text.find_last_not_of(" \t\r") - first + 1);
+    }
+
+    struct ScalarParameter {
+        double Scenario::*field;
+        bool positive;  // Debe ser mayor que 0 (si no, basta con que no sea negativo)
+    };
+
+    // NOLINTNEXTLINE(cert-err58-cpp)
+    std::map<std::string, ScalarParameter> const scalar_parameters = {
+        {"radius_multiplicator", {&Scenario::radius_multiplicator, true}},
+        {"fluid_density", {&Scenario::fluid_density, true}},
+        {"pressure_rigidity", {&Scenario::pressure_rigidity, false}},
+        {"rigidity_collisions", {&Scenario::rigidity_collisions, false}},
+        {"dumping", {&Scenario::dumping, false}},
+        {"viscosity", {&Scenario::viscosity, false}},
+        {"particle_size", {&Scenario::particle_size, false}},
+        {"time_increase", {&Scenario::time_increase, true}},
+        {"courant", {&Scenario::courant, false}},
+    };
+
+    // NOLINTNEXTLINE(cert-err58-cpp)
+    std::map<std::string, Vector3D<double> Scenario::*> const vector_parameters = {
+        {"external_acceleration", &Scenario::external_acceleration},
+        {"bmax", &Scenario::bmax},
+        {"bmin", &Scenario::bmin},
+    };
+
+    int checkScenario(Scenario const & scenario, std::string const & filename,
+                      std::ostream & errors) {
+      for (auto const & [name, parameter] : scalar_parameters) {
+        double const value = scenario.*parameter.field;
+        if (parameter.positive ? value <= 0 : value < 0) {
+          errors << "Error: " << filename << ": " << name << " must be "
+                 << (parameter.positive ? "positive" : "non-negative") << ".\n";
+          return ERROR_INVALID_SCENARIO;
+        }
+      }
+      if (scenario.courant > 1) {
+        errors << "Error: " << filename << ": courant must not be greater than 1.\n";
+        return ERROR_INVALID_SCENARIO;
+      }
+      Vector3D<double> const bdist = scenario.bmax - scenario.bmin;
+      if (bdist.x <= 0 || bdist.y <= 0 || bdist.z <= 0) {
+        errors << "Error: " << filename << ": bmax must be greater than bmin on every axis.\n";
+        return ERROR_INVALID_SCENARIO;
+      }
+      return 0;
+    }
+  }  // namespace
+
+  int parseScenario(std::istream & input, std::string const & filename, Scenario & scenario,
+                    std::ostream & errors) {
+    std::string line;
+    for (int line_number = 1; std::getline(input, line); line_number++) {
+      line = trim(line.substr(0, line.find('#')));
+      if (line.empty()) { continue; }
+      size_t const equals     = line.find('=');
+      std::string const name  = trim(line.substr(0, equals));
+      std::string const value = equals == std::string::npos ? "" : line.substr(equals + 1);
+      auto const scalar       = scalar_parameters.find(name);
+      auto const vector       = vector_parameters.find(name);
+      if (scalar == scalar_parameters.end() && vector == vector_parameters.end()) {
+        errors << "Error: " << filename << ":" << line_number << ": Unknown parameter " << name
+               << ".\n";
+        return ERROR_INVALID_SCENARIO;
+      }
+      std::array<double, 3> values = {};
+      size_t const count           = scalar != scalar_parameters.end() ? 1 : values.size();
+      if (!parseValues(value, std::span<double>(values.data(), count))) {
+        errors << "Error: " << filename << ":" << line_number << ": Invalid value for " << name
+               << ".\n";
+        return ERROR_INVALID_SCENARIO;
+      }
+      if (scalar != scalar_parameters.end()) {
+        scenario.*scalar->second.field = values[0];
+      } else {
+        scenario.*vector->second = Vector3D<double>(values[0], values[1], values[2]);
+      }
+    }
+    return checkScenario(scenario, filename, errors);
+  }
+
+  int readScenario(std::string const & filename, Scenario & scenario, std::ostream & errors) {
+    std::ifstream input(filename);
+    if (!input.good()) {
+      errors << "Error: Cannot open " << filename << " for reading.\n";
+      return ERROR_CANNOT_OPEN_INPUT_FILE;
+    }
+    return parseScenario(input, filename, scenario, errors);
+  }
+
+  std::string scenarioDifference(Scenario const & first, Scenario const & second) {
+    for (auto const & [name, parameter] : scalar_parameters) {
+      if (first.*parameter.field != second.*parameter.field) { return name; }
+    }
+    for (auto const & [name, field] : vector_parameters) {
+      if (first.*field != second.*field) { return name; }
+    }
+    return "";
+  }
+}  // namespace fluids::sim
@@ -0,0 +1,34 @@
+#ifndef SCENARIO_HPP
+#define SCENARIO_HPP
+
+#include "utils.hpp"
+
+#include <iostream>
+#include <istream>
+#include <string>
+
+namespace fluids::sim {
+  // Fichero de escenario: una linea "clave = valor" por parametro de Scenario, con el mismo
+  // nombre que el campo. Los vectores (external_acceleration, bmax y bmin) llevan sus tres
+  // componentes separadas por espacios. Lo que sigue a '#' es un comentario y las lineas en
+  // blanco se ignoran; los parametros que no aparecen conservan su valor por defecto. Ejemplo:
+  //   # Recinto el doble de ancho en x
+  //   bmin = -0.13 -0.08 -0.065
+  //   bmax = 0.13 0.1 0.065
+  //   viscosity = 0.8
+
+  // Lee los parametros de input sobre scenario. Si alguna linea no es valida o el resultado no
+  // tiene sentido fisico, lo indica en errors (con filename y el numero de linea) y devuelve
+  // ERROR_INVALID_SCENARIO; si no, 0.
+  int parseScenario(std::istream & input, std::string const & filename, Scenario & scenario,
+                    std::ostream & errors = std::cerr);
+
+  // parseScenario sobre el fichero filename, o ERROR_CANNOT_OPEN_INPUT_FILE si no se puede abrir
+  int readScenario(std::string const & filename, Scenario & scenario,
+                   std::ostream & errors = std::cerr);
+
+  // Nombre de algun parametro con distinto valor en first y second, o "" si son iguales
+  [[nodiscard]] std::string scenarioDifference(Scenario const & first, Scenario const & second);
+}  // namespace fluids::sim
+
+#endif  // SCENARIO_HPP
@@ -0,0 +1,74 @@
+#include "simulation.hpp"
+
+#include "writer.hpp"
+
+#include <stdexcept>
+#include <string>
+#include <utility>
+
+namespace fluids::sim {
+  namespace {
+    template <std::floating_point T>
+    File<T> fileFromArrays(T particles_per_meter, std::span<T const> position,
+                           std::span<T const> hv_vector, std::span<T const> speed) {
+      if (position.empty() || position.size() % 3 != 0 || hv_vector.size() != position.size() ||
+          speed.size() != position.size()) {
+        throw std::invalid_argument("Invalid number of particles: " +
+                                    std::to_string(position.size()) + ", " +
+                                    std::to_string(hv_vector.size()) + " and " +
+                                    std::to_string(speed.size()) + " values");
+      }
+      File<T> file;
+      file.particles_per_meter = particles_per_meter;
+      size_t const n_particles = position.size() / 3;
+      file.particles.resize(n_particles);
+      auto const copy = [n_particles](std::span<T const> values, Vector3DArray<T> & array) {
+        for (size_t i = 0; i < n_particles; i++) {
+          array.x[i] = values[3 * i];
+          array.y[i] = values[3 * i + 1];
+          array.z[i] = values[3 * i + 2];
+        }
+      };
+      copy(position, file.particles.position);
+      copy(hv_vector, file.particles.hv_vector);
+      copy(speed, file.particles.speed);
+      return file;
+    }
+
+    // La comprobacion del recinto que en Grid termina el programa, como excepcion
+    template <std::floating_point T>
+    File<T> && checkedFile(File<T> && file, Scenario const & scenario) {
+      if (!Grid<T>::fitsBox(file.particles_per_meter, scenario)) {
+        throw std::invalid_argument(
+            "The box must be at least one smoothing length wide on every axis");
+      }
+      return std::move(file);
+    }
+  }  // namespace
+
+  template <std::floating_point T>
+  Simulation<T>::Simulation(File<T> && file, SimulationOptions const & options,
+                            Scenario const & scenario)
+    : grid(checkedFile(std::move(file), scenario), options, scenario) { }
+
+  template <std::floating_point T>
+  Simulation<T>::Simulation(T particles_per_meter, std::span<T const> position,
+                            std::span<T const> hv_vector, std::span<T const> speed,
+                            SimulationOptions const & options, Scenario const & scenario)
+    : Simulation(fileFromArrays(particles_per_meter, position, hv_vector, speed), options,
+                 scenario) { }
+
+  template <std::floating_point T>
+  void Simulation<T>::step(int64_t steps) {
+    for (int64_t i = 0; i < steps; i++) { grid.makeSimulation(); }
+  }
+
+  template <std::floating_point T>
+  bool Simulation<T>::write(std::string const & filename) {
+    grid.packSimulation(grid.output_buffer);
+    return writeBytes(filename, grid.output_buffer, grid.write_mode);
+  }
+
+  template class Simulation<float>;
+  template class Simulation<double>;
+}  // namespace fluids::sim
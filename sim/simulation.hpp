@@ -0,0 +1,61 @@
+#ifndef SIMULATION_HPP
+#define SIMULATION_HPP
+
+#include "grid.hpp"
+#include "options.hpp"
+#include "utils.hpp"
+
+#include <concepts>
+#include <cstdint>
+#include <span>
+#include <string>
+
+namespace fluids::sim {
+  // Coordenadas de todas las particulas, un array por eje, sobre la memoria de la simulacion
+  template <std::floating_point T>
+  struct ParticleSpans {
+      std::span<T const> x, y, z;
+  };
+
+  // Simulacion para usar desde otro programa sin pasar por ficheros: recibe las particulas en
+  // memoria, avanza pasos y deja leer posiciones y velocidades entre paso y paso sin copiarlas.
+  // Las particulas estan ordenadas por bloque y el orden cambia en cada paso: ids() da el
+  // indice original (el de la entrada) de cada posicion. Las vistas valen hasta el siguiente
+  // step.
+  template <std::floating_point T>
+  class Simulation {
+    public:
+      // Se queda con los arrays de file sin copiarlos. Lanza std::invalid_argument si el recinto
+      // no mide al menos una longitud de suavizado en cada eje.
+      explicit Simulation(File<T> && file, SimulationOptions const & options = {},
+                          Scenario const & scenario = {});
+      // Copia n particulas de arrays externos con x, y, z seguidos por particula (como en los
+      // .fld). Lanza std::invalid_argument si no hay particulas, si los tres arrays no tienen el
+      // mismo tamaño, multiplo de 3, o si el recinto no es valido.
+      Simulation(T particles_per_meter, std::span<T const> position, std::span<T const> hv_vector,
+                 std::span<T const> speed, SimulationOptions const & options = {},
+                 Scenario const & scenario = {});
+
+      void step(int64_t steps = 1);
+
+      [[nodiscard]] size_t size() const { return grid.file.particles.size(); }
+      [[nodiscard]] double time() const { return grid.time; }
+      [[nodiscard]] ParticleSpans<T> positions() const {
+        return spans(grid.file.particles.position);
+      }
+      [[nodiscard]] ParticleSpans<T> velocities() const { return spans(grid.file.particles.speed); }
+      [[nodiscard]] std::span<size_t const> ids() const { return grid.file.particles.id; }
+      // El estado actual como un .fld, en el orden de la entrada. false si no se puede escribir
+      // (a diferencia de Grid::writeSimulation, no termina el programa).
+      [[nodiscard]] bool write(std::string const & filename);
+
+      Grid<T> grid;
+
+    private:
+      [[nodiscard]] static ParticleSpans<T> spans(Vector3DArray<T> const & array) {
+        return {.x = array.x, .y = array.y, .z = array.z};
+      }
+  };
+}  // namespace fluids::sim
+
+#endif  // SIMULATION_HPP
@@ -0,0 +1,57 @@
+#include "thread_pool.hpp"
+
+namespace fluids::sim {
+  ThreadPool::ThreadPool(unsigned int n_threads) : n_threads(n_threads == 0 ? 1 : n_threads) {
+    workers.reserve(this->n_threads - 1);
+    for (unsigned int i = 1; i < this->n_threads; i++) { workers.emplace_back(&ThreadPool::work, this); }
+  }
+
+  ThreadPool::~ThreadPool() {
+    {
+      std::lock_guard<std::mutex> const lock(mutex);
+      stopping = true;
+    }
+    start_condition.notify_all();
+    for (std::thread & worker : workers) { worker.join(); }
+  }
+
+  void ThreadPool::runTasks() {
+    for (size_t i = next_task.fetch_add(1); i < task_count; i = next_task.fetch_add(1)) {
+      (*current_task)(i);
+    }
+  }
+
+  void ThreadPool::work() {
+    size_t seen_generation = 0;
+    std::unique_lock<std::mutex> lock(mutex);
+    while (true) {
+      start_condition.wait(lock, [&] { return stopping || generation != seen_generation; });
+      if (stopping) { return; }
+      seen_generation = generation;
+      lock.unlock();
+      runTasks();
+      lock.lock();
+      if (--active_workers == 0) { done_condition.notify_one(); }
+    }
+  }
+
+  void ThreadPool::parallelFor(size_t count, std::function<void(size_t)> const & task) {
+    if (workers.empty() || count < 2) {
+      for (size_t i = 0; i < count; i++) { task(i); }
+      return;
+    }
+    {
+      std::lock_guard<std::mutex> const lock(mutex);
+      current_task   = &task;
+      task_count     = count;
+      next_task      = 0;
+      active_workers = static_cast<unsigned int>(workers.size());
+      generation++;
+    }
+    start_condition.notify_all();
+    runTasks();
+    std::unique_lock<std::mutex> lock(mutex);
+    done_condition.wait(lock, [&] { return active_workers == 0; });
+    current_task = nullptr;
+  }
+}  // namespace fluids::sim
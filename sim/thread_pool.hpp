@@ -0,0 +1,47 @@
+#ifndef THREAD_POOL_HPP
+#define THREAD_POOL_HPP
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace fluids::sim {
+  // Conjunto fijo de hilos que reparte iteraciones [0, count) de forma dinamica.
+  // El hilo que llama a parallelFor tambien trabaja, por lo que un pool de 1 hilo
+  // no crea ningun hilo adicional.
+  class ThreadPool {
+    public:
+      explicit ThreadPool(unsigned int n_threads);
+      ThreadPool(ThreadPool const &)             = delete;
+      ThreadPool(ThreadPool &&)                  = delete;
+      ThreadPool & operator=(ThreadPool const &) = delete;
+      ThreadPool & operator=(ThreadPool &&)      = delete;
+      ~ThreadPool();
+
+      [[nodiscard]] unsigned int size() const { return n_threads; }
+
+      void parallelFor(size_t count, std::function<void(size_t)> const & task);
+
+    private:
+      void work();
+      void runTasks();
+
+      unsigned int n_threads;
+      std::vector<std::thread> workers;
+      std::mutex mutex;
+      std::condition_variable start_condition;
+      std::condition_variable done_condition;
+      std::function<void(size_t)> const * current_task = nullptr;
+      size_t task_count                                 = 0;
+      std::atomic<size_t> next_task                     = 0;
+      size_t generation                                 = 0;
+      unsigned int active_workers                       = 0;
+      bool stopping                                     = false;
+  };
+}  // namespace fluids::sim
+
+#endif  // THREAD_POOL_HPP
@@ -0,0 +1,113 @@
+#include "trajectory.hpp"
+
+#include "writer.hpp"
+
+#include <array>
+#include <cstring>
+#include <fcntl.h>
+#include <unistd.h>
+#include <utility>
+
+namespace fluids::sim {
+  namespace {
+    constexpr std::array<char, 8> magic = {'F', 'L', 'U', 'I', 'D', 'T', 'R', 'J'};
+    constexpr int64_t version           = 1;
+    constexpr size_t header_size        = magic.size() + 2 * sizeof(int64_t);
+    constexpr size_t index_offset_at    = magic.size() + sizeof(int64_t);
+
+    void appendValue(std::vector<char> & bytes, int64_t value) {
+      std::array<char, sizeof(value)> raw{};
+      std::memcpy(raw.data(), &value, sizeof(value));
+      bytes.insert(bytes.end(), raw.begin(), raw.end());
+    }
+
+    int64_t readValue(char const * bytes) {
+      int64_t value = 0;
+      std::memcpy(&value, bytes, sizeof(value));
+      return value;
+    }
+  }  // namespace
+
+  TrajectoryWriter::TrajectoryWriter(std::string const & filename)
+    : descriptor(open(filename.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644)) {
+    if (descriptor < 0) { return; }
+    std::vector<char> header(magic.begin(), magic.end());
+    appendValue(header, version);
+    appendValue(header, 0);
+    succeeded = writeAt(descriptor, header, 0);
+    end       = static_cast<int64_t>(header.size());
+  }
+
+  TrajectoryWriter::~TrajectoryWriter() { close(); }
+
+  void TrajectoryWriter::wait() {
+    if (worker.joinable()) { worker.join(); }
+  }
+
+  bool TrajectoryWriter::append(int64_t step, std::vector<char> & frame) {
+    wait();
+    if (!good()) { return false; }
+    auto const size = static_cast<int64_t>(frame.size());
+    frames.push_back({.step = step, .offset = end, .size = size});
+    std::swap(buffer, frame);
+    worker = std::thread([this, offset = end] {
+      if (!writeAt(descriptor, buffer, offset)) { succeeded = false; }
+    });
+    end += size;
+    return true;
+  }
+
+  bool TrajectoryWriter::close() {
+    wait();
+    if (descriptor < 0) { return succeeded; }
+    if (succeeded) {
+      std::vector<char> index;
+      appendValue(index, static_cast<int64_t>(frames.size()));
+      for (TrajectoryFrame const & frame : frames) {
+        appendValue(index, frame.step);
+        appendValue(index, frame.offset);
+        appendValue(index, frame.size);
+      }
+      std::vector<char> index_offset;
+      appendValue(index_offset, end);
+      // El desplazamiento del indice se escribe el ultimo: un fichero sin el esta incompleto
+      succeeded = writeAt(descriptor, index, end) &&
+                  writeAt(descriptor, index_offset, static_cast<off_t>(index_offset_at));
+    }
+    succeeded  = ::close(descriptor) == 0 && succeeded;
+    descriptor = -1;
+    return succeeded;
+  }
+
+  Trajectory::Trajectory(std::string const & filename) : input(filename) {
+    if (!input.good() || input.size() < header_size ||
+        std::memcmp(input.data(), magic.data(), magic.size()) != 0 ||
+        readValue(input.data() + magic.size()) != version) {
+      return;
+    }
+    auto const size         = static_cast<int64_t>(input.size());
+    int64_t const index     = readValue(input.data() + index_offset_at);
+    int64_t const entry     = 3 * static_cast<int64_t>(sizeof(int64_t));
+    int64_t const available = size - index - static_cast<int64_t>(sizeof(int64_t));
+    if (index < static_cast<int64_t>(header_size) || available < 0) { return; }
+    int64_t const count = readValue(input.data() + index);
+    if (count < 0 || available % entry != 0 || count != available / entry) { return; }
+    char const * entries = input.data() + index + sizeof(int64_t);
+    for (int64_t i = 0; i < count; i++) {
+      TrajectoryFrame const frame = {.step   = readValue(entries + i * entry),
+                                     .offset = readValue(entries + i * entry + sizeof(int64_t)),
+                                     .size = readValue(entries + i * entry + 2 * sizeof(int64_t))};
+      if (frame.offset < static_cast<int64_t>(header_size) || frame.size < 0 ||
+          frame.offset + frame.size > index) {
+        frames.clear();
+        return;
+      }
+      frames.push_back(frame);
+    }
+    valid = true;
+  }
+
+  std::span<char const> Trajectory::frame(size_t frame) const {
+    return {input.data() + frames[frame].offset, static_cast<size_t>(frames[frame].size)};
+  }
+}  // namespace fluids::sim
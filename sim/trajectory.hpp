@@ -0,0 +1,78 @@
+#ifndef TRAJECTORY_HPP
+#define TRAJECTORY_HPP
+
+#include "mapped_file.hpp"
+
+#include <atomic>
+#include <cstdint>
+#include <span>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace fluids::sim {
+  // Fichero de trayectoria (.trj): varios estados de la simulacion en un solo fichero.
+  //   Cabecera (24 bytes): "FLUIDTRJ", version (int64) y desplazamiento del indice (int64,
+  //   0 mientras el fichero no se ha cerrado).
+  //   Fotogramas: cada uno es la imagen completa de un .fld (ver Grid::packSimulation).
+  //   Indice al final: numero de fotogramas (int64) y, por fotograma, paso, desplazamiento y
+  //   tamaño (int64).
+  struct TrajectoryFrame {
+      int64_t step;
+      int64_t offset;
+      int64_t size;
+  };
+
+  // Añade fotogramas a un .trj. Doble buffer: mientras un hilo escribe el fotograma anterior,
+  // la simulacion sigue y prepara el siguiente en el buffer que le devuelve append.
+  class TrajectoryWriter {
+    public:
+      explicit TrajectoryWriter(std::string const & filename);
+      TrajectoryWriter(TrajectoryWriter const &)             = delete;
+      TrajectoryWriter(TrajectoryWriter &&)                  = delete;
+      TrajectoryWriter & operator=(TrajectoryWriter const &) = delete;
+      TrajectoryWriter & operator=(TrajectoryWriter &&)      = delete;
+      ~TrajectoryWriter();
+
+      [[nodiscard]] bool good() const { return descriptor >= 0 && succeeded; }
+
+      // Espera a la escritura anterior e intercambia frame con el buffer del escritor. Devuelve
+      // false si alguna escritura ha fallado.
+      bool append(int64_t step, std::vector<char> & frame);
+      // Espera a la ultima escritura, añade el indice y cierra el fichero
+      bool close();
+
+    private:
+      void wait();
+
+      int descriptor = -1;
+      int64_t end    = 0;  // Desplazamiento del siguiente fotograma
+      std::vector<TrajectoryFrame> frames;
+      std::vector<char> buffer;
+      std::thread worker;
+      std::atomic<bool> succeeded = true;
+  };
+
+  // Lectura de un .trj proyectado en memoria. good() es false si no se puede abrir o si la
+  // cabecera o el indice no son validos (por ejemplo, un fichero que no se llego a cerrar).
+  class Trajectory {
+    public:
+      explicit Trajectory(std::string const & filename);
+
+      [[nodiscard]] bool good() const { return valid; }
+
+      [[nodiscard]] size_t size() const { return frames.size(); }
+
+      [[nodiscard]] int64_t step(size_t frame) const { return frames[frame].step; }
+
+      // Imagen .fld del fotograma, para parseFile
+      [[nodiscard]] std::span<char const> frame(size_t frame) const;
+
+    private:
+      MappedFile input;
+      std::vector<TrajectoryFrame> frames;
+      bool valid = false;
+  };
+}  // namespace fluids::sim
+
+#endif  // TRAJECTORY_HPP
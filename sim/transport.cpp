@@ -0,0 +1,228 @@
+#include "transport.hpp"
+
+#include "utils.hpp"
+
+#include <arpa/inet.h>
+#include <cerrno>
+#include <chrono>
+#include <cstring>
+#include <fcntl.h>
+#include <iostream>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <poll.h>
+#include <string>
+#include <sys/socket.h>
+#include <thread>
+#include <unistd.h>
+
+namespace fluids::sim {
+  MemoryExchange::MemoryExchange(int ranks)
+    : ranks(ranks), boxes(static_cast<size_t>(ranks * ranks)), sync(ranks) { }
+
+  // Primero todos dejan sus mensajes y despues todos recogen los suyos; la segunda espera
+  // impide que un rango rapido escriba el siguiente intercambio antes de que se haya leido este
+  void MemoryTransport::exchange(std::vector<std::vector<char>> const & outgoing,
+                                 std::vector<std::vector<char>> & incoming) {
+    auto const ranks = static_cast<size_t>(hub.ranks);
+    auto const self  = static_cast<size_t>(my_rank);
+    for (size_t d = 0; d < ranks; d++) {
+      if (d != self) { hub.boxes[self * ranks + d] = outgoing[d]; }
+    }
+    hub.sync.arrive_and_wait();
+    incoming.resize(ranks);
+    for (size_t s = 0; s < ranks; s++) {
+      incoming[s].clear();
+      if (s != self) { incoming[s].swap(hub.boxes[s * ranks + self]); }
+    }
+    hub.sync.arrive_and_wait();
+  }
+
+  namespace {
+    [[noreturn]] void transportError(std::string const & what) {
+      std::cerr << "Error: Transport: " << what << ": " << std::strerror(errno) << ".\n";
+      exit(ERROR_TRANSPORT);
+    }
+
+    sockaddr_in localAddress(uint16_t port) {
+      sockaddr_in address{};
+      address.sin_family      = AF_INET;
+      address.sin_port        = htons(port);
+      address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+      return address;
+    }
+
+    // Bytes completos en una conexion todavia bloqueante (solo durante la conexion inicial)
+    void sendAll(int socket, void const * data, size_t size) {
+      auto const * bytes = static_cast<char const *>(data);
+      while (size > 0) {
+        ssize_t const sent = send(socket, bytes, size, MSG_NOSIGNAL);
+        if (sent <= 0) { transportError("cannot send"); }
+        bytes += sent;
+        size  -= static_cast<size_t>(sent);
+      }
+    }
+
+    void receiveAll(int socket, void * data, size_t size) {
+      auto * bytes = static_cast<char *>(data);
+      while (size > 0) {
+        ssize_t const received = recv(socket, bytes, size, 0);
+        if (received <= 0) { transportError("cannot receive"); }
+        bytes += received;
+        size  -= static_cast<size_t>(received);
+      }
+    }
+
+    // Los rangos pueden arrancar en cualquier orden: se reintenta hasta que el otro escucha
+    int connectTo(uint16_t port) {
+      sockaddr_in const address = localAddress(port);
+      // NOLINTNEXTLINE(cppcoreguidelines-avoid-magic-numbers,readability-magic-numbers)
+      for (int attempt = 0; attempt < 1000; attempt++) {
+        int const socket_fd = socket(AF_INET, SOCK_STREAM, 0);
+        if (socket_fd < 0) { transportError("cannot create socket"); }
+        // NOLINTNEXTLINE(cppcoreguidelines-pro-type-reinterpret-cast)
+        if (connect(socket_fd, reinterpret_cast<sockaddr const *>(&address), sizeof(address)) ==
+            0) {
+          return socket_fd;
+        }
+        close(socket_fd);
+        // NOLINTNEXTLINE(cppcoreguidelines-avoid-magic-numbers,readability-magic-numbers)
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+      }
+      transportError("cannot connect to port " + std::to_string(port));
+    }
+
+    // Estado de un mensaje en curso: primero los 8 bytes del tamaño y despues los datos
+    struct Transfer {
+        uint64_t size = 0;
+        size_t done   = 0;  // Bytes ya enviados o recibidos, contando el tamaño
+        bool complete = true;
+
+        [[nodiscard]] size_t total() const { return sizeof(size) + size; }
+    };
+  }  // namespace
+
+  TcpTransport::TcpTransport(int rank, int size, uint16_t base_port)
+    : my_rank(rank), sockets(static_cast<size_t>(size), -1) {
+    int const listener = socket(AF_INET, SOCK_STREAM, 0);
+    if (listener < 0) { transportError("cannot create socket"); }
+    int const reuse = 1;
+    setsockopt(listener, SOL_SOCKET, SO_REUSEADDR, &reuse, sizeof(reuse));
+    auto const port           = static_cast<uint16_t>(base_port + rank);
+    sockaddr_in const address = localAddress(port);
+    // NOLINTNEXTLINE(cppcoreguidelines-pro-type-reinterpret-cast)
+    if (bind(listener, reinterpret_cast<sockaddr const *>(&address), sizeof(address)) != 0 ||
+        listen(listener, size) != 0) {
+      transportError("cannot listen on port " + std::to_string(port));
+    }
+    for (int peer = 0; peer < rank; peer++) {
+      int const socket_fd = connectTo(static_cast<uint16_t>(base_port + peer));
+      auto const me       = static_cast<int32_t>(rank);
+      sendAll(socket_fd, &me, sizeof(me));
+      sockets[static_cast<size_t>(peer)] = socket_fd;
+    }
+    for (int accepted = rank + 1; accepted < size; accepted++) {
+      int const socket_fd = accept(listener, nullptr, nullptr);
+      if (socket_fd < 0) { transportError("cannot accept connection"); }
+      int32_t peer = -1;
+      receiveAll(socket_fd, &peer, sizeof(peer));
+      if (peer <= rank || peer >= size || sockets[static_cast<size_t>(peer)] != -1) {
+        std::cerr << "Error: Transport: unexpected rank " << peer << ".\n";
+        exit(ERROR_TRANSPORT);
+      }
+      sockets[static_cast<size_t>(peer)] = socket_fd;
+    }
+    close(listener);
+    for (int const socket_fd : sockets) {
+      if (socket_fd < 0) { continue; }
+      int const no_delay = 1;
+      setsockopt(socket_fd, IPPROTO_TCP, TCP_NODELAY, &no_delay, sizeof(no_delay));
+      // NOLINTNEXTLINE(cppcoreguidelines-pro-type-vararg,hicpp-vararg)
+      fcntl(socket_fd, F_SETFL, fcntl(socket_fd, F_GETFL) | O_NONBLOCK);
+    }
+  }
+
+  TcpTransport::~TcpTransport() {
+    for (int const socket_fd : sockets) {
+      if (socket_fd >= 0) { close(socket_fd); }
+    }
+  }
+
+  void TcpTransport::exchange(std::vector<std::vector<char>> const & outgoing,
+                              std::vector<std::vector<char>> & incoming) {
+    size_t const ranks = sockets.size();
+    incoming.resize(ranks);
+    std::vector<Transfer> sending(ranks);
+    std::vector<Transfer> receiving(ranks);
+    for (size_t peer = 0; peer < ranks; peer++) {
+      incoming[peer].clear();
+      if (sockets[peer] < 0) { continue; }
+      sending[peer]   = {.size = outgoing[peer].size(), .done = 0, .complete = false};
+      receiving[peer] = {.size = 0, .done = 0, .complete = false};
+    }
+    std::vector<pollfd> waiting;
+    std::vector<size_t> waiting_peer;
+    while (true) {
+      waiting.clear();
+      waiting_peer.clear();
+      for (size_t peer = 0; peer < ranks; peer++) {
+        short events = 0;
+        if (!sending[peer].complete) { events |= POLLOUT; }
+        if (!receiving[peer].complete) { events |= POLLIN; }
+        if (events == 0) { continue; }
+        waiting.push_back({.fd = sockets[peer], .events = events, .revents = 0});
+        waiting_peer.push_back(peer);
+      }
+      if (waiting.empty()) { return; }
+      if (poll(waiting.data(), waiting.size(), -1) < 0) {
+        if (errno == EINTR) { continue; }
+        transportError("poll failed");
+      }
+      for (size_t w = 0; w < waiting.size(); w++) {
+        size_t const peer = waiting_peer[w];
+        int const fd      = waiting[w].fd;
+        if ((waiting[w].revents & POLLOUT) != 0) {
+          Transfer & out = sending[peer];
+          ssize_t sent   = 0;
+          if (out.done < sizeof(out.size)) {
+            // NOLINTNEXTLINE(cppcoreguidelines-pro-type-reinterpret-cast)
+            char const * header = reinterpret_cast<char const *>(&out.size);
+            sent = send(fd, header + out.done, sizeof(out.size) - out.done, MSG_NOSIGNAL);
+          } else {
+            size_t const offset = out.done - sizeof(out.size);
+            sent = send(fd, outgoing[peer].data() + offset, out.size - offset, MSG_NOSIGNAL);
+          }
+          if (sent < 0 && errno != EAGAIN && errno != EWOULDBLOCK) {
+            transportError("cannot send");
+          }
+          if (sent > 0) { out.done += static_cast<size_t>(sent); }
+          out.complete = out.done == out.total();
+        }
+        if ((waiting[w].revents & (POLLIN | POLLHUP | POLLERR)) != 0) {
+          Transfer & in    = receiving[peer];
+          ssize_t received = 0;
+          if (in.done < sizeof(in.size)) {
+            // NOLINTNEXTLINE(cppcoreguidelines-pro-type-reinterpret-cast)
+            char * header = reinterpret_cast<char *>(&in.size);
+            received      = recv(fd, header + in.done, sizeof(in.size) - in.done, 0);
+          } else {
+            size_t const offset = in.done - sizeof(in.size);
+            received            = recv(fd, incoming[peer].data() + offset, in.size - offset, 0);
+          }
+          if (received == 0) {
+            std::cerr << "Error: Transport: rank " << peer << " closed the connection.\n";
+            exit(ERROR_TRANSPORT);
+          }
+          if (received < 0 && errno != EAGAIN && errno != EWOULDBLOCK) {
+            transportError("cannot receive from rank " + std::to_string(peer));
+          }
+          if (received > 0) {
+            in.done += static_cast<size_t>(received);
+            if (in.done == sizeof(in.size)) { incoming[peer].resize(in.size); }
+          }
+          in.complete = in.done >= sizeof(in.size) && in.done == in.total();
+        }
+      }
+    }
+  }
+}  // namespace fluids::sim
@@ -0,0 +1,86 @@
+#ifndef TRANSPORT_HPP
+#define TRANSPORT_HPP
+
+#include <barrier>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+namespace fluids::sim {
+  // Comunicacion entre los rangos (procesos o hilos) de una simulacion distribuida. Cada
+  // implementacion solo tiene que dar el intercambio colectivo exchange.
+  class Transport {
+    public:
+      Transport()                              = default;
+      Transport(Transport const &)             = delete;
+      Transport(Transport &&)                  = delete;
+      Transport & operator=(Transport const &) = delete;
+      Transport & operator=(Transport &&)      = delete;
+      virtual ~Transport()                     = default;
+
+      [[nodiscard]] virtual int rank() const = 0;
+      [[nodiscard]] virtual int size() const = 0;
+      // Todos los rangos llaman a exchange a la vez: cada uno envia outgoing[d] al rango d y
+      // recibe en incoming[s] lo que le envia el rango s (outgoing[rank()] no se envia e
+      // incoming[rank()] queda vacio). Los mensajes vacios tambien se envian. Si la conexion
+      // falla, termina el programa con ERROR_TRANSPORT.
+      virtual void exchange(std::vector<std::vector<char>> const & outgoing,
+                            std::vector<std::vector<char>> & incoming) = 0;
+  };
+
+  // Buzones compartidos por los rangos de MemoryTransport
+  class MemoryExchange {
+    public:
+      explicit MemoryExchange(int ranks);
+
+      [[nodiscard]] int size() const { return ranks; }
+
+    private:
+      friend class MemoryTransport;
+      int ranks;
+      std::vector<std::vector<char>> boxes;  // Del rango s al d en boxes[s * ranks + d]
+      std::barrier<> sync;
+  };
+
+  // Rangos como hilos de un mismo proceso que se pasan los mensajes en memoria compartida.
+  // Sirve para probar la descomposicion sin red; cada hilo crea el suyo sobre el mismo hub.
+  class MemoryTransport : public Transport {
+    public:
+      MemoryTransport(MemoryExchange & hub, int rank) : hub(hub), my_rank(rank) { }
+
+      [[nodiscard]] int rank() const override { return my_rank; }
+      [[nodiscard]] int size() const override { return hub.size(); }
+      void exchange(std::vector<std::vector<char>> const & outgoing,
+                    std::vector<std::vector<char>> & incoming) override;
+
+    private:
+      MemoryExchange & hub;
+      int my_rank;
+  };
+
+  // Un proceso por rango unidos por TCP en 127.0.0.1: el rango r escucha en base_port + r,
+  // se conecta a los rangos menores y acepta a los mayores (cada uno se presenta con su
+  // rango). Los mensajes llevan delante su tamaño (uint64) y se envian y reciben a la vez con
+  // poll para que dos rangos que se envian mucho a la vez no se bloqueen.
+  class TcpTransport : public Transport {
+    public:
+      TcpTransport(int rank, int size, uint16_t base_port);
+      TcpTransport(TcpTransport const &)             = delete;
+      TcpTransport(TcpTransport &&)                  = delete;
+      TcpTransport & operator=(TcpTransport const &) = delete;
+      TcpTransport & operator=(TcpTransport &&)      = delete;
+      ~TcpTransport() override;
+
+      [[nodiscard]] int rank() const override { return my_rank; }
+      [[nodiscard]] int size() const override { return static_cast<int>(sockets.size()); }
+      void exchange(std::vector<std::vector<char>> const & outgoing,
+                    std::vector<std::vector<char>> & incoming) override;
+
+    private:
+      int my_rank;
+      std::vector<int> sockets;  // Descriptor de la conexion con cada rango (-1 el propio)
+  };
+}  // namespace fluids::sim
+
+#endif  // TRANSPORT_HPP
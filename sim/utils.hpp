@@ -2,6 +2,7 @@
 #define UTILS_HPP
 
 #include <cmath>
+#include <concepts>
 
 namespace fluids::sim {
 #define ERROR_INVALID_NUMBER_ARGUMENTS (-1)
@@ -10,24 +11,35 @@ namespace fluids::sim {
 #define ERROR_CANNOT_OPEN_INPUT_FILE (-3)
 #define ERROR_CANNOT_OPEN_OUTPUT_FILE (-4)
 #define ERROR_INVALID_PARTICLE_NUMBER (-5)
-
+#define ERROR_INVALID_OPTION (-6)
+#define ERROR_INVALID_CHECKPOINT (-7)
+#define ERROR_INVALID_SCENARIO (-8)
+#define ERROR_TRANSPORT (-9)
+#define ERROR_SIMULATION_FAILED (-10)
+
+  // Vector de tres componentes en el tipo de coma flotante de la simulacion (float o double)
+  template <std::floating_point T>
   class Vector3D {
     public:
-      double x, y, z;
+      T x, y, z;
+
+      Vector3D(T xCoord, T yCoord, T zCoord) : x(xCoord), y(yCoord), z(zCoord) { }
 
-      Vector3D(double xCoord, double yCoord, double zCoord) : x(xCoord), y(yCoord), z(zCoord) { }
+      template <std::floating_point U>
+      explicit Vector3D(Vector3D<U> const & v)
+        : x(static_cast<T>(v.x)), y(static_cast<T>(v.y)), z(static_cast<T>(v.z)) { }
 
       Vector3D operator+(Vector3D const & v) const { return {x + v.x, y + v.y, z + v.z}; }
 
       Vector3D operator-(Vector3D const & v) const { return {x - v.x, y - v.y, z - v.z}; }
 
-      Vector3D operator*(double s) const { return {x * s, y * s, z * s}; }
+      Vector3D operator*(T s) const { return {x * s, y * s, z * s}; }
 
-      Vector3D operator/(double s) const { return {x / s, y / s, z / s}; }
+      Vector3D operator/(T s) const { return {x / s, y / s, z / s}; }
 
-      [[nodiscard]] double dot(Vector3D const & v) const { return x * v.x + y * v.y + z * v.z; }
+      [[nodiscard]] T dot(Vector3D const & v) const { return x * v.x + y * v.y + z * v.z; }
 
-      [[nodiscard]] double norm() const { return sqrt(x * x + y * y + z * z); }
+      [[nodiscard]] T norm() const { return std::sqrt(x * x + y * y + z * z); }
 
       [[nodiscard]] Vector3D normalized() const { return *this / norm(); }
 
@@ -45,14 +57,14 @@ namespace fluids::sim {
         return *this;
       }
 
-      Vector3D & operator*=(double s) {
+      Vector3D & operator*=(T s) {
         x *= s;
         y *= s;
         z *= s;
         return *this;
       }
 
-      Vector3D & operator/=(double s) {
+      Vector3D & operator/=(T s) {
         x /= s;
         y /= s;
         z /= s;
@@ -73,7 +85,8 @@ namespace fluids::sim {
   double const dumping              = 128.0;  // Amortiguamiento
   double const viscosity            = 0.4;    // Viscosidad
   double const particle_size        = 2e-4;   // Tamaño de particula
-  double const time_increase        = 1e-3;   // Paso de tiempo
+  double const time_increase        = 1e-3;   // Paso de tiempo (maximo con paso adaptativo)
+  double const time_step_growth     = 1.1;    // Crecimiento maximo del paso adaptativo
   double const six = 6;
   double const fifteen = 15;
   double const nine = 9;
@@ -85,10 +98,49 @@ namespace fluids::sim {
   double const min_increment = 1e-10;
 
   // NOLINTNEXTLINE(cert-err58-cpp)
-  Vector3D const external_acceleration(0.0, -9.8, 0.0);  // Aceleracion externa
+  Vector3D<double> const external_acceleration(0.0, -9.8, 0.0);  // Aceleracion externa
   // NOLINTNEXTLINE(cert-err58-cpp)
-  Vector3D const bmax(0.065, 0.1, 0.065);  // Limite superior de recinto
+  Vector3D<double> const bmax(0.065, 0.1, 0.065);  // Limite superior de recinto
   // NOLINTNEXTLINE(cert-err58-cpp)
-  Vector3D const bmin(-0.065, -0.08, -0.065);  // Limite inferior de recinto
+  Vector3D<double> const bmin(-0.065, -0.08, -0.065);  // Limite inferior de recinto
+
+  // Parametros fisicos y recinto de una simulacion. Por defecto, las constantes anteriores;
+  // con --scenario se leen de un fichero (ver readScenario) sin recompilar.
+  struct Scenario {
+      double radius_multiplicator            = sim::radius_multiplicator;
+      double fluid_density                   = sim::fluid_density;
+      double pressure_rigidity               = sim::pressure_rigidity;
+      double rigidity_collisions             = sim::rigidity_collisions;
+      double dumping                         = sim::dumping;
+      double viscosity                       = sim::viscosity;
+      double particle_size                   = sim::particle_size;
+      double time_increase                   = sim::time_increase;
+      double courant                         = 0;  // Paso adaptativo (0: fijo, time_increase)
+      Vector3D<double> external_acceleration = sim::external_acceleration;
+      Vector3D<double> bmax                  = sim::bmax;
+      Vector3D<double> bmin                  = sim::bmin;
+  };
+
+  // Constantes usadas en cada paso, convertidas al tipo de coma flotante de la simulacion
+  template <std::floating_point T>
+  struct PhysicalConstants {
+      explicit PhysicalConstants(Scenario const & scenario = {})
+        : particle_size(static_cast<T>(scenario.particle_size)),
+          time_increase(static_cast<T>(scenario.time_increase)),
+          rigidity_collisions(static_cast<T>(scenario.rigidity_collisions)),
+          dumping(static_cast<T>(scenario.dumping)),
+          external_acceleration(scenario.external_acceleration), bmax(scenario.bmax),
+          bmin(scenario.bmin) { }
+
+      T particle_size;
+      T time_increase;
+      T rigidity_collisions;
+      T dumping;
+      T max_distance  = static_cast<T>(sim::max_distance);
+      T min_increment = static_cast<T>(sim::min_increment);
+      Vector3D<T> external_acceleration;
+      Vector3D<T> bmax;
+      Vector3D<T> bmin;
+  };
 }  // namespace fluids::sim
 #endif
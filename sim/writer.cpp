@@ -0,0 +1,86 @@
+#include "writer.hpp"
+
+#include <algorithm>
+#include <cerrno>
+#include <cstdlib>
+#include <cstring>
+#include <fcntl.h>
+#include <memory>
+#include <unistd.h>
+#include <utility>
+
+namespace fluids::sim {
+  namespace {
+    // Tamaño maximo de cada pwrite y alineamiento que exige O_DIRECT (direccion, tamaño y
+    // desplazamiento multiplos del bloque logico; 4096 cubre los discos habituales)
+    constexpr size_t chunk_size       = size_t{8} << 20U;
+    constexpr size_t direct_alignment = 4096;
+
+    // Copia los bytes a un buffer alineado por bloques de chunk_size. El ultimo bloque se
+    // completa con ceros hasta el alineamiento y el fichero se recorta despues a su tamaño.
+    bool writeDirect(int descriptor, std::span<char const> bytes) {
+      auto * const raw = static_cast<char *>(std::aligned_alloc(direct_alignment, chunk_size));
+      if (raw == nullptr) { return false; }
+      std::unique_ptr<char, decltype(&std::free)> const staging(raw, &std::free);
+      size_t offset = 0;
+      while (offset < bytes.size()) {
+        size_t const size   = std::min(bytes.size() - offset, chunk_size);
+        size_t const padded = (size + direct_alignment - 1) / direct_alignment * direct_alignment;
+        std::memcpy(raw, bytes.data() + offset, size);
+        std::memset(raw + size, 0, padded - size);
+        if (!writeAt(descriptor, {raw, padded}, static_cast<off_t>(offset))) { return false; }
+        offset += size;
+      }
+      return ftruncate(descriptor, static_cast<off_t>(bytes.size())) == 0;
+    }
+  }  // namespace
+
+  bool writeAt(int descriptor, std::span<char const> bytes, off_t offset) {
+    char const * data = bytes.data();
+    size_t size       = bytes.size();
+    while (size > 0) {
+      ssize_t const written = pwrite(descriptor, data, std::min(size, chunk_size), offset);
+      if (written < 0 && errno == EINTR) { continue; }
+      if (written <= 0) { return false; }
+      data   += written;
+      size   -= static_cast<size_t>(written);
+      offset += written;
+    }
+    return true;
+  }
+
+  bool writeBytes(std::string const & filename, std::span<char const> bytes, WriteMode mode) {
+    int constexpr flags     = O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC;
+    mode_t constexpr access = 0644;
+    int descriptor          = -1;
+    bool direct             = false;
+    if (mode == WriteMode::direct) {
+      descriptor = open(filename.c_str(), flags | O_DIRECT, access);
+      direct     = descriptor >= 0;
+    }
+    // tmpfs y otros sistemas de ficheros rechazan O_DIRECT con EINVAL
+    if (descriptor < 0) { descriptor = open(filename.c_str(), flags, access); }
+    if (descriptor < 0) { return false; }
+    bool const written = direct ? writeDirect(descriptor, bytes)
+                                : writeAt(descriptor, bytes, 0);
+    return close(descriptor) == 0 && written;
+  }
+
+  AsyncWriter::~AsyncWriter() { wait(); }
+
+  void AsyncWriter::start(std::string const & filename, std::vector<char> & bytes) {
+    wait();
+    current_file = filename;
+    std::swap(buffer, bytes);
+    worker = std::thread([this] {
+      if (!writeBytes(current_file, buffer, mode) && failed_file.empty()) {
+        failed_file = current_file;
+      }
+    });
+  }
+
+  bool AsyncWriter::wait() {
+    if (worker.joinable()) { worker.join(); }
+    return failed_file.empty();
+  }
+}  // namespace fluids::sim
@@ -0,0 +1,51 @@
+#ifndef WRITER_HPP
+#define WRITER_HPP
+
+#include "options.hpp"
+
+#include <span>
+#include <string>
+#include <sys/types.h>
+#include <thread>
+#include <vector>
+
+namespace fluids::sim {
+  // Escribe todos los bytes en descriptor a partir de offset con pwrite, en bloques de 8 MiB
+  bool writeAt(int descriptor, std::span<char const> bytes, off_t offset);
+
+  // Escribe bytes en filename (creandolo o truncandolo) con pwrite de bloques grandes. Con
+  // WriteMode::direct abre el fichero con O_DIRECT y, si el sistema de ficheros no lo admite,
+  // escribe como en buffered. Devuelve false si no se ha podido escribir el fichero completo.
+  bool writeBytes(std::string const & filename, std::span<char const> bytes, WriteMode mode);
+
+  // Escribe ficheros en un hilo propio mientras el que llama sigue simulando. Guarda un solo
+  // buffer: start espera a que termine la escritura anterior antes de lanzar la siguiente.
+  class AsyncWriter {
+    public:
+      explicit AsyncWriter(WriteMode mode = WriteMode::buffered) : mode(mode) { }
+
+      AsyncWriter(AsyncWriter const &)             = delete;
+      AsyncWriter(AsyncWriter &&)                  = delete;
+      AsyncWriter & operator=(AsyncWriter const &) = delete;
+      AsyncWriter & operator=(AsyncWriter &&)      = delete;
+      ~AsyncWriter();
+
+      // Intercambia bytes con el buffer del escritor: el que llama recupera el buffer de la
+      // escritura anterior para reutilizarlo sin reservar memoria nueva
+      void start(std::string const & filename, std::vector<char> & bytes);
+      // Espera a la escritura en curso. Devuelve false si alguna escritura ha fallado.
+      bool wait();
+
+      // Primer fichero que no se pudo escribir (vacio si todas las escrituras han ido bien)
+      [[nodiscard]] std::string const & failedFile() const { return failed_file; }
+
+    private:
+      WriteMode mode;
+      std::thread worker;
+      std::string current_file;
+      std::string failed_file;
+      std::vector<char> buffer;
+  };
+}  // namespace fluids::sim
+
+#endif  // WRITER_HPP
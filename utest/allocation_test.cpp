@@ -0,0 +1,109 @@
+#include "sim/grid.hpp"
+#include "utest/lattice.hpp"
+
+#include <atomic>
+#include <cstdlib>
+#include <gtest/gtest.h>
+#include <new>
+#include <string>
+
+using namespace std;
+using namespace fluids::sim;
+using fluids::utest::latticeFile;
+
+// Todas las reservas de memoria del programa de pruebas pasan por aqui y se cuentan
+namespace {
+  std::atomic<size_t> allocations = 0;
+
+  void * countedAllocation(size_t size) {
+    allocations.fetch_add(1, std::memory_order_relaxed);
+    // NOLINTNEXTLINE(cppcoreguidelines-no-malloc,hicpp-no-malloc)
+    void * const memory = std::malloc(size == 0 ? 1 : size);
+    if (memory == nullptr) { throw std::bad_alloc(); }
+    return memory;
+  }
+}  // namespace
+
+void * operator new(size_t size) {
+  return countedAllocation(size);
+}
+
+void * operator new[](size_t size) {
+  return countedAllocation(size);
+}
+
+void operator delete(void * memory) noexcept {
+  // NOLINTNEXTLINE(cppcoreguidelines-no-malloc,hicpp-no-malloc)
+  std::free(memory);
+}
+
+void operator delete[](void * memory) noexcept {
+  // NOLINTNEXTLINE(cppcoreguidelines-no-malloc,hicpp-no-malloc)
+  std::free(memory);
+}
+
+void operator delete(void * memory, size_t) noexcept {
+  // NOLINTNEXTLINE(cppcoreguidelines-no-malloc,hicpp-no-malloc)
+  std::free(memory);
+}
+
+void operator delete[](void * memory, size_t) noexcept {
+  // NOLINTNEXTLINE(cppcoreguidelines-no-malloc,hicpp-no-malloc)
+  std::free(memory);
+}
+
+namespace {
+  // Recinto de 4 x 4 x 4 bloques lleno de particulas: desde el primer paso todos los bloques
+  // tienen sus vecinos anotados, asi que despues ningun paso deberia reservar memoria
+  Scenario small_box() {
+    Scenario scenario;
+    // NOLINTNEXTLINE(cppcoreguidelines-avoid-magic-numbers,readability-magic-numbers,-warnings-as-errors)
+    scenario.bmin = Vector3D<double>(-0.02, -0.02, -0.02);
+    // NOLINTNEXTLINE(cppcoreguidelines-avoid-magic-numbers,readability-magic-numbers,-warnings-as-errors)
+    scenario.bmax = Vector3D<double>(0.02, 0.02, 0.02);
+    return scenario;
+  }
+
+  // Reservas de memoria en steps pasos tras warm_up pasos de calentamiento
+  size_t stepAllocations(SimulationOptions options, int warm_up, int steps) {
+    // NOLINTNEXTLINE(cppcoreguidelines-avoid-magic-numbers,readability-magic-numbers,-warnings-as-errors)
+    File<double> file = latticeFile(12, 3.2e-3, Vector3D<double>(-0.0176, -0.0176, -0.0176), 0.02);
+    options.verbose   = false;
+    Grid<double> grid(file, options, small_box());
+    for (int step = 0; step < warm_up; step++) { grid.makeSimulation(); }
+    size_t const before = allocations.load();
+    for (int step = 0; step < steps; step++) { grid.makeSimulation(); }
+    return allocations.load() - before;
+  }
+}  // namespace
+
+// Comprobacion del propio contador
+TEST(AllocationTest, CountsAllocations) {
+  size_t const before = allocations.load();
+  // NOLINTNEXTLINE(cppcoreguidelines-avoid-magic-numbers,readability-magic-numbers,-warnings-as-errors)
+  auto const values = std::make_unique<std::vector<int>>(100);
+  ASSERT_EQ(allocations.load() - before, 2U);
+}
+
+// Tras el primer paso, que dimensiona la memoria de trabajo, los pasos no reservan memoria
+TEST(AllocationTest, StepsDoNotAllocate) {
+  // NOLINTNEXTLINE(cppcoreguidelines-avoid-magic-numbers,readability-magic-numbers,-warnings-as-errors)
+  EXPECT_EQ(stepAllocations({.kernel = KernelType::scalar}, 2, 20), 0U);
+  // NOLINTNEXTLINE(cppcoreguidelines-avoid-magic-numbers,readability-magic-numbers,-warnings-as-errors)
+  EXPECT_EQ(stepAllocations({}, 2, 20), 0U);
+  // NOLINTNEXTLINE(cppcoreguidelines-avoid-magic-numbers,readability-magic-numbers,-warnings-as-errors)
+  EXPECT_EQ(stepAllocations({.fused = false}, 2, 20), 0U);
+  // NOLINTNEXTLINE(cppcoreguidelines-avoid-magic-numbers,readability-magic-numbers,-warnings-as-errors)
+  EXPECT_EQ(stepAllocations({.threads = 4}, 2, 20), 0U);
+  // NOLINTNEXTLINE(cppcoreguidelines-avoid-magic-numbers,readability-magic-numbers,-warnings-as-errors)
+  EXPECT_EQ(stepAllocations({.block_order = BlockOrder::hilbert}, 2, 20), 0U);
+}
+
+TEST(AllocationTest, CachesDoNotAllocate) {
+  // NOLINTNEXTLINE(cppcoreguidelines-avoid-magic-numbers,readability-magic-numbers,-warnings-as-errors)
+  EXPECT_EQ(stepAllocations({.pair_cache = true}, 2, 20), 0U);
+  // NOLINTNEXTLINE(cppcoreguidelines-avoid-magic-numbers,readability-magic-numbers,-warnings-as-errors)
+  EXPECT_EQ(stepAllocations({.kernel = KernelType::scalar, .pair_cache = true}, 2, 20), 0U);
+  // NOLINTNEXTLINE(cppcoreguidelines-avoid-magic-numbers,readability-magic-numbers,-warnings-as-errors)
+  EXPECT_EQ(stepAllocations({.verlet_skin = 0.3}, 2, 20), 0U);
+}
@@ -0,0 +1,63 @@
+#include "sim/block_order.hpp"
+
+#include <algorithm>
+#include <cstdlib>
+#include <gtest/gtest.h>
+#include <numeric>
+#include <vector>
+
+using namespace fluids::sim;
+
+namespace {
+  // Coordenadas de un indice lineal en una rejilla de n_x x n_y x n_z
+  std::vector<int> coordinates(size_t linear, int n_x, int n_y) {
+    auto const i = static_cast<int>(linear);
+    return {i % n_x, (i / n_x) % n_y, i / (n_x * n_y)};
+  }
+}  // namespace
+
+TEST(BlockOrderTest, LinearIsIdentity) {
+  // NOLINTNEXTLINE(cppcoreguidelines-avoid-magic-numbers,readability-magic-numbers,-warnings-as-errors)
+  std::vector<size_t> const traversal = blockTraversal(BlockOrder::linear, 5, 3, 4);
+  std::vector<size_t> expected(traversal.size());
+  std::iota(expected.begin(), expected.end(), 0);
+  EXPECT_EQ(traversal, expected);
+}
+
+TEST(BlockOrderTest, MortonInterleavesBits) {
+  EXPECT_EQ(mortonKey(1, 0, 0), 1U);
+  EXPECT_EQ(mortonKey(0, 1, 0), 2U);
+  EXPECT_EQ(mortonKey(0, 0, 1), 4U);
+  // NOLINTNEXTLINE(cppcoreguidelines-avoid-magic-numbers,readability-magic-numbers,-warnings-as-errors)
+  EXPECT_EQ(mortonKey(3, 3, 3), 63U);
+  // NOLINTNEXTLINE(cppcoreguidelines-avoid-magic-numbers,readability-magic-numbers,-warnings-as-errors)
+  EXPECT_EQ(mortonKey(2, 0, 0), 8U);
+}
+
+// Cada celda se visita una vez, aunque la rejilla no sea una potencia de dos
+TEST(BlockOrderTest, CurvesArePermutations) {
+  for (BlockOrder const order : {BlockOrder::morton, BlockOrder::hilbert}) {
+    // NOLINTNEXTLINE(cppcoreguidelines-avoid-magic-numbers,readability-magic-numbers,-warnings-as-errors)
+    std::vector<size_t> traversal = blockTraversal(order, 15, 21, 15);
+    std::sort(traversal.begin(), traversal.end());
+    std::vector<size_t> expected(traversal.size());
+    std::iota(expected.begin(), expected.end(), 0);
+    EXPECT_EQ(traversal, expected) << blockOrderName(order);
+  }
+}
+
+// En un cubo de lado potencia de dos, dos bloques consecutivos de la curva de Hilbert
+// comparten una cara
+TEST(BlockOrderTest, HilbertStepsToFaceNeighbours) {
+  int const side                      = 8;
+  std::vector<size_t> const traversal = blockTraversal(BlockOrder::hilbert, side, side, side);
+  for (size_t k = 1; k < traversal.size(); k++) {
+    std::vector<int> const previous = coordinates(traversal[k - 1], side, side);
+    std::vector<int> const current  = coordinates(traversal[k], side, side);
+    int distance                    = 0;
+    for (size_t axis = 0; axis < 3; axis++) {
+      distance += std::abs(current[axis] - previous[axis]);
+    }
+    ASSERT_EQ(distance, 1) << "paso " << k;
+  }
+}
@@ -0,0 +1,164 @@
+#include "sim/checkpoint.hpp"
+#include "sim/grid.hpp"
+#include "utest/lattice.hpp"
+
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <gtest/gtest.h>
+#include <string>
+#include <vector>
+
+using namespace std;
+using namespace fluids::sim;
+using fluids::utest::latticeFile;
+
+namespace {
+  void expect_same_state(Particles<double> const & expected, Particles<double> const & obtained) {
+    ASSERT_EQ(expected.size(), obtained.size());
+    for (size_t i = 0; i < expected.size(); i++) {
+      ASSERT_EQ(expected.id[i], obtained.id[i]);
+      ASSERT_EQ(expected.position[i], obtained.position[i]);
+      ASSERT_EQ(expected.hv_vector[i], obtained.hv_vector[i]);
+      ASSERT_EQ(expected.speed[i], obtained.speed[i]);
+      ASSERT_EQ(expected.acceleration[i], obtained.acceleration[i]);
+      ASSERT_EQ(expected.density[i], obtained.density[i]);
+    }
+  }
+
+  // Simula 3 pasos, guarda un punto de control, simula 3 mas y comprueba que continuar desde
+  // el punto de control da exactamente el mismo estado (y el mismo tiempo)
+  void check_restart(Compression compression, Scenario const & scenario = {}) {
+    // NOLINTNEXTLINE(cppcoreguidelines-avoid-magic-numbers,readability-magic-numbers,-warnings-as-errors)
+    File<double> file = latticeFile(4, 3e-3);
+    Grid<double> uninterrupted(file, {}, scenario);
+    // NOLINTNEXTLINE(cppcoreguidelines-avoid-magic-numbers,readability-magic-numbers,-warnings-as-errors)
+    for (int step = 0; step < 3; step++) { uninterrupted.makeSimulation(); }
+    ASSERT_TRUE(writeCheckpoint("state.chk", uninterrupted, 3, compression));
+    ASSERT_TRUE(isCheckpoint("state.chk"));
+
+    Checkpoint<double> checkpoint = readCheckpoint<double>("state.chk");
+    ASSERT_EQ(checkpoint.step, 3);
+    ASSERT_EQ(checkpoint.file.particles_per_meter, uninterrupted.file.particles_per_meter);
+    expect_same_state(uninterrupted.file.particles, checkpoint.file.particles);
+    Grid<double> resumed(checkpoint.file, {}, scenario);
+    checkRestart(checkpoint, resumed);
+    restoreTime(checkpoint, resumed);
+    ASSERT_EQ(resumed.time, uninterrupted.time);
+    ASSERT_EQ(resumed.time_step, uninterrupted.time_step);
+    // NOLINTNEXTLINE(cppcoreguidelines-avoid-magic-numbers,readability-magic-numbers,-warnings-as-errors)
+    for (int step = 0; step < 3; step++) {
+      uninterrupted.makeSimulation();
+      resumed.makeSimulation();
+      ASSERT_EQ(resumed.time_step, uninterrupted.time_step);
+    }
+    ASSERT_EQ(resumed.time, uninterrupted.time);
+    expect_same_state(uninterrupted.file.particles, resumed.file.particles);
+    if (remove("state.chk") != 0) { perror("Error deleting file"); }
+  }
+}  // namespace
+
+TEST(CheckpointTest, RestartIsExact) { check_restart(Compression::none); }
+
+#ifdef FLUIDS_HAVE_ZLIB
+TEST(CheckpointTest, CompressedRestartIsExact) { check_restart(Compression::zlib); }
+#endif
+
+// Con paso adaptativo se guardan el paso siguiente y los maximos de cada bloque
+TEST(CheckpointTest, AdaptiveRestartIsExact) {
+  Scenario scenario;
+  // NOLINTNEXTLINE(cppcoreguidelines-avoid-magic-numbers,readability-magic-numbers,-warnings-as-errors)
+  scenario.courant = 0.1;
+  check_restart(Compression::none, scenario);
+}
+
+TEST(CheckpointTest, FldIsNotCheckpoint) {
+  // NOLINTNEXTLINE(cppcoreguidelines-avoid-magic-numbers,readability-magic-numbers,-warnings-as-errors)
+  File<double> file = latticeFile(4, 3e-3);
+  Grid<double> grid(file);
+  string filename = "lattice.fld";
+  grid.writeSimulation(filename);
+  ASSERT_FALSE(isCheckpoint(filename));
+  ASSERT_FALSE(isCheckpoint("missing.chk"));
+  if (remove("lattice.fld") != 0) { perror("Error deleting file"); }
+}
+
+TEST(CheckpointTest, WrongPrecision) {
+  // NOLINTNEXTLINE(cppcoreguidelines-avoid-magic-numbers,readability-magic-numbers,-warnings-as-errors)
+  File<double> file = latticeFile(4, 3e-3);
+  Grid<double> grid(file);
+  ASSERT_TRUE(writeCheckpoint("double.chk", grid, 0, Compression::none));
+  ASSERT_DEATH(readCheckpoint<float>("double.chk"),
+               "Error: Invalid checkpoint double.chk: stores 8-byte values, this program uses 4.");
+  if (remove("double.chk") != 0) { perror("Error deleting file"); }
+}
+
+// El escenario se guarda en la cabecera y no se puede continuar con otro
+TEST(CheckpointTest, ScenarioMismatch) {
+  Scenario scenario;
+  // NOLINTNEXTLINE(cppcoreguidelines-avoid-magic-numbers,readability-magic-numbers,-warnings-as-errors)
+  scenario.viscosity = 5;
+  // NOLINTNEXTLINE(cppcoreguidelines-avoid-magic-numbers,readability-magic-numbers,-warnings-as-errors)
+  scenario.bmax = Vector3D<double>(0.07, 0.1, 0.065);
+  // NOLINTNEXTLINE(cppcoreguidelines-avoid-magic-numbers,readability-magic-numbers,-warnings-as-errors)
+  File<double> file = latticeFile(4, 3e-3);
+  Grid<double> grid(file, {}, scenario);
+  ASSERT_TRUE(writeCheckpoint("scenario.chk", grid, 0, Compression::none));
+  Checkpoint<double> checkpoint = readCheckpoint<double>("scenario.chk");
+  ASSERT_EQ(checkpoint.scenario.viscosity, scenario.viscosity);
+  ASSERT_EQ(checkpoint.scenario.bmax, scenario.bmax);
+  ASSERT_EQ(checkpoint.scenario.bmin, scenario.bmin);
+  ASSERT_EQ(checkpoint.scenario.time_increase, scenario.time_increase);
+  checkRestart(checkpoint, Grid<double>(checkpoint.file, {}, scenario));
+  ASSERT_DEATH(checkRestart(checkpoint, Grid<double>(checkpoint.file)),
+               "Error: Checkpoint was written with a different viscosity; restart it with the "
+               "same scenario.");
+  if (remove("scenario.chk") != 0) { perror("Error deleting file"); }
+}
+
+TEST(CheckpointTest, Truncated) {
+  // NOLINTNEXTLINE(cppcoreguidelines-avoid-magic-numbers,readability-magic-numbers,-warnings-as-errors)
+  File<double> file = latticeFile(4, 3e-3);
+  Grid<double> grid(file);
+  ASSERT_TRUE(writeCheckpoint("truncated.chk", grid, 0, Compression::none));
+  ifstream input("truncated.chk", ios::binary);
+  string bytes((istreambuf_iterator<char>(input)), istreambuf_iterator<char>());
+  input.close();
+  ofstream output("truncated.chk", ios::binary);
+  // NOLINTNEXTLINE(cppcoreguidelines-avoid-magic-numbers,readability-magic-numbers,-warnings-as-errors)
+  output.write(bytes.data(), static_cast<streamsize>(bytes.size() - 100));
+  output.close();
+  ASSERT_DEATH(readCheckpoint<double>("truncated.chk"),
+               "Error: Invalid checkpoint truncated.chk: truncated.");
+  if (remove("truncated.chk") != 0) { perror("Error deleting file"); }
+}
+
+namespace {
+  // Escribe un punto de control con un numero de particulas en la cabecera mucho mayor que el
+  // real: la lectura debe fallar antes de intentar reservar los arrays
+  void check_huge_count(Compression compression) {
+    // NOLINTNEXTLINE(cppcoreguidelines-avoid-magic-numbers,readability-magic-numbers,-warnings-as-errors)
+    File<double> file = latticeFile(4, 3e-3);
+    Grid<double> grid(file);
+    ASSERT_TRUE(writeCheckpoint("huge.chk", grid, 0, compression));
+    ifstream input("huge.chk", ios::binary);
+    string bytes((istreambuf_iterator<char>(input)), istreambuf_iterator<char>());
+    input.close();
+    // Numero de particulas: cuarto int64 tras magic
+    int64_t const particles = int64_t{1} << 40U;
+    // NOLINTNEXTLINE(cppcoreguidelines-avoid-magic-numbers,readability-magic-numbers,-warnings-as-errors)
+    std::memcpy(bytes.data() + 8 + 3 * sizeof(int64_t), &particles, sizeof(particles));
+    ofstream output("huge.chk", ios::binary);
+    output.write(bytes.data(), static_cast<streamsize>(bytes.size()));
+    output.close();
+    ASSERT_DEATH(readCheckpoint<double>("huge.chk"),
+                 "Error: Invalid checkpoint huge.chk: truncated.");
+    if (remove("huge.chk") != 0) { perror("Error deleting file"); }
+  }
+}  // namespace
+
+TEST(CheckpointTest, HugeParticleCount) { check_huge_count(Compression::none); }
+
+#ifdef FLUIDS_HAVE_ZLIB
+TEST(CheckpointTest, CompressedHugeParticleCount) { check_huge_count(Compression::zlib); }
+#endif
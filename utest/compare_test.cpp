@@ -0,0 +1,194 @@
+#include "sim/compare.hpp"
+
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <gtest/gtest.h>
+#include <limits>
+#include <vector>
+
+using namespace std;
+using namespace fluids::sim;
+
+namespace {
+  template <typename T>
+  void append(vector<char> & bytes, T value) {
+    char buffer[sizeof(T)];
+    memcpy(buffer, &value, sizeof(T));
+    bytes.insert(bytes.end(), buffer, buffer + sizeof(T));
+  }
+
+  // .fld con n particulas; el valor v de la particula i es i + v / 10
+  vector<char> fld_bytes(int n_particles) {
+    vector<char> bytes;
+    // NOLINTNEXTLINE(cppcoreguidelines-avoid-magic-numbers,readability-magic-numbers,-warnings-as-errors)
+    append(bytes, 204.0F);
+    append(bytes, n_particles);
+    for (int i = 0; i < n_particles; i++) {
+      // NOLINTNEXTLINE(cppcoreguidelines-avoid-magic-numbers,readability-magic-numbers,-warnings-as-errors)
+      for (int value = 0; value < 9; value++) {
+        // NOLINTNEXTLINE(cppcoreguidelines-avoid-magic-numbers,readability-magic-numbers,-warnings-as-errors)
+        append(bytes, static_cast<float>(i) + static_cast<float>(value) / 10);
+      }
+    }
+    return bytes;
+  }
+
+  // Posicion del valor value de la particula i en un .fld
+  size_t fld_offset(int particle, int value) {
+    // NOLINTNEXTLINE(cppcoreguidelines-avoid-magic-numbers,readability-magic-numbers,-warnings-as-errors)
+    return 8 + (static_cast<size_t>(particle) * 9 + static_cast<size_t>(value)) * sizeof(float);
+  }
+
+  void set_fld(vector<char> & bytes, int particle, int value, float number) {
+    memcpy(bytes.data() + fld_offset(particle, value), &number, sizeof(number));
+  }
+
+  float get_fld(vector<char> const & bytes, int particle, int value) {
+    float number = 0;
+    memcpy(&number, bytes.data() + fld_offset(particle, value), sizeof(number));
+    return number;
+  }
+
+  // .trz con las particulas de cada bloque en blocks; el valor v de la particula id es id + v
+  vector<char> trz_bytes(vector<vector<int64_t>> const & blocks, double density = 1) {
+    vector<char> bytes;
+    append(bytes, static_cast<int32_t>(blocks.size()));
+    for (vector<int64_t> const & block : blocks) {
+      append(bytes, static_cast<int64_t>(block.size()));
+      for (int64_t const id : block) {
+        append(bytes, id);
+        // NOLINTNEXTLINE(cppcoreguidelines-avoid-magic-numbers,readability-magic-numbers,-warnings-as-errors)
+        for (int value = 0; value < 9; value++) { append(bytes, static_cast<double>(id + value)); }
+        append(bytes, id == 2 ? density : 1.0);
+        // NOLINTNEXTLINE(cppcoreguidelines-avoid-magic-numbers,readability-magic-numbers,-warnings-as-errors)
+        for (int value = 0; value < 3; value++) { append(bytes, static_cast<double>(-value)); }
+      }
+    }
+    return bytes;
+  }
+}  // namespace
+
+// Mas de un tramo de particulas: todos los valores iguales
+TEST(CompareTest, IdenticalFld) {
+  // NOLINTNEXTLINE(cppcoreguidelines-avoid-magic-numbers,readability-magic-numbers,-warnings-as-errors)
+  vector<char> const bytes = fld_bytes(40000);
+  Comparison const comparison = compareFld(bytes, bytes, {.threads = 2});
+  ASSERT_TRUE(comparison.error.empty());
+  EXPECT_TRUE(comparison.matches());
+  // NOLINTNEXTLINE(cppcoreguidelines-avoid-magic-numbers,readability-magic-numbers,-warnings-as-errors)
+  EXPECT_EQ(comparison.particles, 40000U);
+  EXPECT_EQ(comparison.fields, 3U);
+  // NOLINTNEXTLINE(cppcoreguidelines-avoid-magic-numbers,readability-magic-numbers,-warnings-as-errors)
+  EXPECT_EQ(comparison.histogram[0], 9U * 40000U);
+  EXPECT_TRUE(comparison.worst.empty());
+}
+
+// Un valor a 1 ULP y otro a 4: se detectan sin tolerancia y se aceptan con la que los cubre
+TEST(CompareTest, Tolerances) {
+  // NOLINTNEXTLINE(cppcoreguidelines-avoid-magic-numbers,readability-magic-numbers,-warnings-as-errors)
+  vector<char> const first = fld_bytes(30000);
+  vector<char> second      = first;
+  // NOLINTNEXTLINE(cppcoreguidelines-avoid-magic-numbers,readability-magic-numbers,-warnings-as-errors)
+  float const value = get_fld(first, 25000, 7);
+  // NOLINTNEXTLINE(cppcoreguidelines-avoid-magic-numbers,readability-magic-numbers,-warnings-as-errors)
+  set_fld(second, 25000, 7, nextafter(value, 1e9F));
+  float shifted = get_fld(first, 3, 1);
+  // NOLINTNEXTLINE(cppcoreguidelines-avoid-magic-numbers,readability-magic-numbers,-warnings-as-errors)
+  for (int i = 0; i < 4; i++) { shifted = nextafter(shifted, -1e9F); }
+  set_fld(second, 3, 1, shifted);
+
+  Comparison const exact = compareFld(first, second, {});
+  EXPECT_FALSE(exact.matches());
+  EXPECT_EQ(exact.mismatches(), 2U);
+  EXPECT_EQ(exact.field_errors[static_cast<size_t>(Field::velocity)].max_ulps, 1U);
+  EXPECT_EQ(exact.field_errors[static_cast<size_t>(Field::position)].max_ulps, 4U);
+  EXPECT_EQ(exact.field_errors[static_cast<size_t>(Field::hv)].mismatches, 0U);
+  ASSERT_EQ(exact.worst.size(), 2U);
+  EXPECT_EQ(exact.worst[0].id, 3U);
+  EXPECT_EQ(exact.worst[0].field, Field::position);
+  // NOLINTNEXTLINE(cppcoreguidelines-avoid-magic-numbers,readability-magic-numbers,-warnings-as-errors)
+  EXPECT_EQ(exact.worst[1].id, 25000U);
+  EXPECT_EQ(exact.worst[1].field, Field::velocity);
+  EXPECT_EQ(exact.histogram[1], 1U);
+  EXPECT_EQ(exact.histogram[3], 1U);
+
+  // NOLINTNEXTLINE(cppcoreguidelines-avoid-magic-numbers,readability-magic-numbers,-warnings-as-errors)
+  EXPECT_TRUE(compareFld(first, second, {.tolerance = {.ulps = 4}}).matches());
+  EXPECT_EQ(compareFld(first, second, {.tolerance = {.ulps = 1}}).mismatches(), 1U);
+  // NOLINTNEXTLINE(cppcoreguidelines-avoid-magic-numbers,readability-magic-numbers,-warnings-as-errors)
+  EXPECT_TRUE(compareFld(first, second, {.tolerance = {.absolute = 1e-2}}).matches());
+  // NOLINTNEXTLINE(cppcoreguidelines-avoid-magic-numbers,readability-magic-numbers,-warnings-as-errors)
+  EXPECT_TRUE(compareFld(first, second, {.tolerance = {.relative = 1e-6}}).matches());
+  EXPECT_EQ(compareFld(first, second, {.worst = 1}).worst.size(), 1U);
+}
+
+// El resultado no depende del numero de hilos
+TEST(CompareTest, Threads) {
+  // NOLINTNEXTLINE(cppcoreguidelines-avoid-magic-numbers,readability-magic-numbers,-warnings-as-errors)
+  vector<char> const first = fld_bytes(50000);
+  vector<char> second      = first;
+  // NOLINTNEXTLINE(cppcoreguidelines-avoid-magic-numbers,readability-magic-numbers,-warnings-as-errors)
+  for (int i = 0; i < 50000; i += 7) {
+    // NOLINTNEXTLINE(cppcoreguidelines-avoid-magic-numbers,readability-magic-numbers,-warnings-as-errors)
+    set_fld(second, i, i % 9, get_fld(first, i, i % 9) * 1.001F);
+  }
+  Comparison const serial   = compareFld(first, second, {.threads = 1});
+  // NOLINTNEXTLINE(cppcoreguidelines-avoid-magic-numbers,readability-magic-numbers,-warnings-as-errors)
+  Comparison const parallel = compareFld(first, second, {.threads = 4});
+  EXPECT_EQ(serial.mismatches(), parallel.mismatches());
+  EXPECT_EQ(serial.histogram, parallel.histogram);
+  ASSERT_EQ(serial.worst.size(), parallel.worst.size());
+  for (size_t i = 0; i < serial.worst.size(); i++) {
+    EXPECT_EQ(serial.worst[i].id, parallel.worst[i].id);
+  }
+}
+
+// Un .trz se compara por id aunque las particulas esten en otro orden o en otro bloque
+TEST(CompareTest, TrzById) {
+  vector<char> const first  = trz_bytes({{0, 3}, {}, {1, 2, 4}});
+  vector<char> const second = trz_bytes({{4, 2, 0}, {3}, {1}});
+  Comparison const comparison = compareTrz(first, second, {});
+  ASSERT_TRUE(comparison.error.empty());
+  EXPECT_TRUE(comparison.matches());
+  // NOLINTNEXTLINE(cppcoreguidelines-avoid-magic-numbers,readability-magic-numbers,-warnings-as-errors)
+  EXPECT_EQ(comparison.particles, 5U);
+  // NOLINTNEXTLINE(cppcoreguidelines-avoid-magic-numbers,readability-magic-numbers,-warnings-as-errors)
+  EXPECT_EQ(comparison.fields, 5U);
+
+  // NOLINTNEXTLINE(cppcoreguidelines-avoid-magic-numbers,readability-magic-numbers,-warnings-as-errors)
+  Comparison const density = compareTrz(first, trz_bytes({{0, 1, 2, 3, 4}}, 1.5), {});
+  EXPECT_EQ(density.mismatches(), 1U);
+  EXPECT_EQ(density.field_errors[static_cast<size_t>(Field::density)].mismatches, 1U);
+  // NOLINTNEXTLINE(cppcoreguidelines-avoid-magic-numbers,readability-magic-numbers,-warnings-as-errors)
+  EXPECT_EQ(density.field_errors[static_cast<size_t>(Field::density)].max_absolute, 0.5);
+  ASSERT_EQ(density.worst.size(), 1U);
+  EXPECT_EQ(density.worst[0].id, 2U);
+}
+
+// Un NaN solo coincide con el mismo NaN
+TEST(CompareTest, NaN) {
+  vector<char> const first = fld_bytes(2);
+  vector<char> second      = first;
+  set_fld(second, 1, 2, numeric_limits<float>::quiet_NaN());
+  Tolerance const loose{.absolute = 1e9, .relative = 1e9, .ulps = 1U << 30U};
+  EXPECT_EQ(compareFld(first, second, {.tolerance = loose}).mismatches(), 1U);
+  EXPECT_TRUE(compareFld(second, second, {}).matches());
+}
+
+TEST(CompareTest, InvalidFiles) {
+  vector<char> const bytes = fld_bytes(3);
+  EXPECT_EQ(compareFld(bytes, fld_bytes(2), {}).error,
+            "different number of particles: 3 and 2");
+  vector<char> truncated = bytes;
+  truncated.pop_back();
+  EXPECT_EQ(compareFld(bytes, truncated, {}).error,
+            "the size of the second file does not match its header");
+  EXPECT_EQ(compareTrz(trz_bytes({{0, 1}}), trz_bytes({{0}, {0}}), {}).error,
+            "repeated particle id 0 in the second file");
+  EXPECT_EQ(compareTrz(trz_bytes({{0, 2}}), trz_bytes({{0, 1}}), {}).error,
+            "particle id 2 out of range in the first file");
+  vector<char> short_trz = trz_bytes({{0, 1}});
+  short_trz.pop_back();
+  EXPECT_EQ(compareTrz(short_trz, short_trz, {}).error, "truncated block in the first file");
+}
@@ -0,0 +1,139 @@
+#include "sim/distributed.hpp"
+#include "sim/grid.hpp"
+#include "sim/transport.hpp"
+#include "utest/lattice.hpp"
+
+#include <gtest/gtest.h>
+#include <thread>
+#include <vector>
+
+using namespace std;
+using namespace fluids::sim;
+using fluids::utest::latticeFile;
+
+namespace {
+  // Bloque de 8 x 8 x 8 particulas con velocidades distintas: en unos pasos muchas cambian de
+  // capa en z y, por tanto, de rango
+  File<double> moving_cube() {
+    // NOLINTNEXTLINE(cppcoreguidelines-avoid-magic-numbers,readability-magic-numbers,-warnings-as-errors)
+    return latticeFile(8, 4e-3, Vector3D<double>(-0.01, -0.07, -0.01), 0.5);
+  }
+
+  // Particulas reunidas en el rango 0 tras steps pasos con ranks rangos en hilos
+  Particles<double> distributed_run(int ranks, SimulationOptions const & options, int steps) {
+    File<double> const input = moving_cube();
+    MemoryExchange hub(ranks);
+    Particles<double> gathered;
+    vector<thread> threads;
+    for (int rank = 0; rank < ranks; rank++) {
+      threads.emplace_back([&, rank] {
+        File<double> file = input;
+        MemoryTransport transport(hub, rank);
+        DistributedGrid<double> dist(file, transport, options);
+        for (int step = 0; step < steps; step++) { dist.makeSimulation(); }
+        dist.gather();
+        if (rank == 0) { gathered = dist.grid.file.particles; }
+      });
+    }
+    for (thread & rank : threads) { rank.join(); }
+    return gathered;
+  }
+}  // namespace
+
+TEST(TransportTest, MemoryExchange) {
+  int const ranks = 3;
+  MemoryExchange hub(ranks);
+  vector<vector<vector<char>>> received(ranks);
+  vector<thread> threads;
+  for (int rank = 0; rank < ranks; rank++) {
+    threads.emplace_back([&, rank] {
+      MemoryTransport transport(hub, rank);
+      vector<vector<char>> outgoing(ranks);
+      // Del rango s al d van s + d bytes con el valor 10 * s + d (el 0 -> 0, vacio)
+      for (int d = 0; d < ranks; d++) {
+        outgoing[static_cast<size_t>(d)].assign(static_cast<size_t>(rank + d),
+                                                static_cast<char>(10 * rank + d));
+      }
+      // Dos intercambios seguidos: el segundo no puede pisar al primero
+      transport.exchange(outgoing, received[static_cast<size_t>(rank)]);
+      transport.exchange(outgoing, received[static_cast<size_t>(rank)]);
+    });
+  }
+  for (thread & rank : threads) { rank.join(); }
+  for (int d = 0; d < ranks; d++) {
+    for (int s = 0; s < ranks; s++) {
+      vector<char> const & message = received[static_cast<size_t>(d)][static_cast<size_t>(s)];
+      if (s == d) {
+        EXPECT_TRUE(message.empty());
+        continue;
+      }
+      EXPECT_EQ(message, vector<char>(static_cast<size_t>(s + d), static_cast<char>(10 * s + d)));
+    }
+  }
+}
+
+// Las particulas de cada bloque se recorren en el mismo orden que en un solo proceso, asi que
+// el resultado es el mismo bit a bit con cualquier numero de rangos
+TEST(DistributedTest, MatchesSingleProcess) {
+  vector<SimulationOptions> const variants = {
+    {.kernel = KernelType::scalar},
+    {},
+    {.fused = false},
+    // NOLINTNEXTLINE(cppcoreguidelines-avoid-magic-numbers,readability-magic-numbers,-warnings-as-errors)
+    {.threads = 2, .block_order = BlockOrder::hilbert},
+  };
+  // NOLINTNEXTLINE(cppcoreguidelines-avoid-magic-numbers,readability-magic-numbers,-warnings-as-errors)
+  int const steps = 10;
+  for (SimulationOptions options : variants) {
+    options.verbose   = false;
+    File<double> file = moving_cube();
+    Grid<double> single(file, options);
+    for (int step = 0; step < steps; step++) { single.makeSimulation(); }
+    Particles<double> const & expected  = single.file.particles;
+    vector<size_t> const expected_slots = expected.slots();
+    for (int const ranks : {1, 2, 3, 5}) {
+      Particles<double> const obtained    = distributed_run(ranks, options, steps);
+      ASSERT_EQ(obtained.size(), expected.size());
+      vector<size_t> const obtained_slots = obtained.slots();
+      for (size_t id = 0; id < expected.size(); id++) {
+        size_t const i = obtained_slots[id];
+        size_t const j = expected_slots[id];
+        ASSERT_EQ(obtained.position[i], expected.position[j]) << ranks << " ranks, id " << id;
+        ASSERT_EQ(obtained.hv_vector[i], expected.hv_vector[j]) << ranks << " ranks, id " << id;
+        ASSERT_EQ(obtained.speed[i], expected.speed[j]) << ranks << " ranks, id " << id;
+      }
+    }
+  }
+}
+
+// Las laminas cubren todas las capas, tienen al menos una cada una y reparten las particulas
+TEST(DistributedTest, Slabs) {
+  int const ranks = 4;
+  MemoryExchange hub(ranks);
+  vector<pair<int, int>> slabs(ranks);
+  vector<size_t> owned(ranks);
+  vector<int> layers(ranks);
+  vector<thread> threads;
+  for (int rank = 0; rank < ranks; rank++) {
+    threads.emplace_back([&, rank] {
+      File<double> file = moving_cube();
+      MemoryTransport transport(hub, rank);
+      DistributedGrid<double> dist(file, transport, {.verbose = false});
+      slabs[static_cast<size_t>(rank)]  = {dist.z_begin, dist.z_end};
+      owned[static_cast<size_t>(rank)]  = dist.grid.file.particles.size();
+      layers[static_cast<size_t>(rank)] = dist.grid.n_blocks_z;
+    });
+  }
+  for (thread & rank : threads) { rank.join(); }
+  EXPECT_EQ(slabs.front().first, 0);
+  EXPECT_EQ(slabs.back().second, layers.front());
+  size_t total = 0;
+  for (size_t r = 0; r < slabs.size(); r++) {
+    EXPECT_LT(slabs[r].first, slabs[r].second);
+    if (r > 0) { EXPECT_EQ(slabs[r].first, slabs[r - 1].second); }
+    // El cubo ocupa 8 capas de particulas: cada rango tiene al menos una
+    EXPECT_GT(owned[r], 0U);
+    total += owned[r];
+  }
+  EXPECT_EQ(total, moving_cube().particles.size());
+}
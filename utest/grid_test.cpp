@@ -1,7 +1,9 @@
 #include "cmath"
 #include "sim/block.hpp"
 #include "sim/grid.hpp"
+#include "utest/lattice.hpp"
 
+#include <algorithm>
 #include <fstream>
 #include <gtest/gtest.h>
 #include <iostream>
@@ -9,6 +11,7 @@
 
 using namespace std;
 using namespace fluids::sim;
+using fluids::utest::latticeFile;
 
 struct Alt_particle {
     int64_t id;
@@ -21,11 +24,24 @@ struct Alt_particle {
 
 class GridTest : public ::testing::Test {
   protected:
+  // 125 particulas repartidas en varios bloques, con valores distintos en cada campo
+  static File<double> sample_file() {
+    File<double> f_test =
+        // NOLINTNEXTLINE(cppcoreguidelines-avoid-magic-numbers,readability-magic-numbers,-warnings-as-errors)
+        latticeFile(5, 1e-2, Vector3D<double>(-0.02, -0.07, -0.02), 0.1);
+    // Velocidad opuesta a hv para que los dos campos no coincidan
+    for (size_t i = 0; i < f_test.particles.size(); i++) {
+      f_test.particles.speed.set(i, f_test.particles.speed[i] * -1.0);
+    }
+    return f_test;
+  }
+
     // NOLINTNEXTLINE(readability-function-size)
-    static Grid grid_from_trz(string & filename) {
+    static Grid<double> grid_from_trz(string & filename) {
       string filename2   = "./inputs/small.fld";
-      struct File f_test = readFile(filename2);
-      Grid grid(f_test);
+      File<double> f_test = readFile<double>(filename2);
+      // Las trazas de referencia se compararan bit a bit: funciones de pares escalares
+      Grid<double> grid(f_test, SimulationOptions{.kernel = KernelType::scalar});
       std::ifstream file(filename, std::ios::binary);
       if (!file) { throw std::runtime_error("No se pudo abrir el archivo"); }
       int32_t num_blocks = 0;
@@ -33,7 +49,7 @@ class GridTest : public ::testing::Test {
       file.read(reinterpret_cast<char *>(&num_blocks), sizeof(num_blocks));
       std::vector<struct Alt_particle> particles;
       for (Block & block : grid.blocks) {
-        block.particles.clear();
+        block.end = block.begin;
         int64_t num_particles = 0;
         // NOLINTNEXTLINE(cppcoreguidelines-pro-type-reinterpret-cast)
         file.read(reinterpret_cast<char *>(&num_particles), sizeof(num_particles));
@@ -75,9 +91,9 @@ class GridTest : public ::testing::Test {
                   return a.id < b.id;
                 });
 
-      std::vector<Particle> particles2;
+      Particles<double> particles2;
       for (Alt_particle const & particle : particles) {
-        Particle new_particle;
+        Particle<double> new_particle;
         new_particle.position.x     = particle.posx;
         new_particle.position.y     = particle.posy;
         new_particle.position.z     = particle.posz;
@@ -99,48 +115,50 @@ class GridTest : public ::testing::Test {
 
     // NOLINTNEXTLINE(readability-function-size,-warnings-as-errors)
     void SetUp() override {
-      struct File file;
+      File<double> file;
       string const filename = "input.txt";
       ofstream outputf(filename);
-      file.particles_per_meter = 1;
+      // Con menos particulas por metro la longitud de suavizado no cabe en el recinto
+      // NOLINTNEXTLINE(cppcoreguidelines-avoid-magic-numbers,readability-magic-numbers,-warnings-as-errors)
+      file.particles_per_meter = 204;
       int particles_number     = 1;
       file.particles.resize(1);
       // NOLINTNEXTLINE(cppcoreguidelines-avoid-magic-numbers,readability-magic-numbers,-warnings-as-errors)
-      file.particles[0].position = Vector3D(1, 2, 3);
+      file.particles.position.set(0, Vector3D<double>(1, 2, 3));
       // NOLINTNEXTLINE(cppcoreguidelines-avoid-magic-numbers,readability-magic-numbers,-warnings-as-errors)
-      file.particles[0].hv_vector = Vector3D(4, 5, 6);
+      file.particles.hv_vector.set(0, Vector3D<double>(4, 5, 6));
       // NOLINTNEXTLINE(cppcoreguidelines-avoid-magic-numbers,readability-magic-numbers,-warnings-as-errors)
-      file.particles[0].speed = Vector3D(7, 8, 9);
+      file.particles.speed.set(0, Vector3D<double>(7, 8, 9));
       auto value              = static_cast<float>(file.particles_per_meter);
       // NOLINTNEXTLINE(cppcoreguidelines-pro-type-reinterpret-cast)
       outputf.write(reinterpret_cast<char *>(&value), sizeof(float));
       // NOLINTNEXTLINE(cppcoreguidelines-pro-type-reinterpret-cast)
       outputf.write(reinterpret_cast<char *>(&particles_number), sizeof(int));
-      value = static_cast<float>(file.particles[0].position.x);
+      value = static_cast<float>(file.particles.position.x[0]);
       // NOLINTNEXTLINE(cppcoreguidelines-pro-type-reinterpret-cast)
       outputf.write(reinterpret_cast<char *>(&value), sizeof(float));
-      value = static_cast<float>(file.particles[0].position.y);
+      value = static_cast<float>(file.particles.position.y[0]);
       // NOLINTNEXTLINE(cppcoreguidelines-pro-type-reinterpret-cast)
       outputf.write(reinterpret_cast<char *>(&value), sizeof(float));
-      value = static_cast<float>(file.particles[0].position.z);
+      value = static_cast<float>(file.particles.position.z[0]);
       // NOLINTNEXTLINE(cppcoreguidelines-pro-type-reinterpret-cast)
       outputf.write(reinterpret_cast<char *>(&value), sizeof(float));
-      value = static_cast<float>(file.particles[0].hv_vector.x);
+      value = static_cast<float>(file.particles.hv_vector.x[0]);
       // NOLINTNEXTLINE(cppcoreguidelines-pro-type-reinterpret-cast)
       outputf.write(reinterpret_cast<char *>(&value), sizeof(float));
-      value = static_cast<float>(file.particles[0].hv_vector.y);
+      value = static_cast<float>(file.particles.hv_vector.y[0]);
       // NOLINTNEXTLINE(cppcoreguidelines-pro-type-reinterpret-cast)
       outputf.write(reinterpret_cast<char *>(&value), sizeof(float));
-      value = static_cast<float>(file.particles[0].hv_vector.z);
+      value = static_cast<float>(file.particles.hv_vector.z[0]);
       // NOLINTNEXTLINE(cppcoreguidelines-pro-type-reinterpret-cast)
       outputf.write(reinterpret_cast<char *>(&value), sizeof(float));
-      value = static_cast<float>(file.particles[0].speed.x);
+      value = static_cast<float>(file.particles.speed.x[0]);
       // NOLINTNEXTLINE(cppcoreguidelines-pro-type-reinterpret-cast)
       outputf.write(reinterpret_cast<char *>(&value), sizeof(float));
-      value = static_cast<float>(file.particles[0].speed.y);
+      value = static_cast<float>(file.particles.speed.y[0]);
       // NOLINTNEXTLINE(cppcoreguidelines-pro-type-reinterpret-cast)
       outputf.write(reinterpret_cast<char *>(&value), sizeof(float));
-      value = static_cast<float>(file.particles[0].speed.z);
+      value = static_cast<float>(file.particles.speed.z[0]);
       // NOLINTNEXTLINE(cppcoreguidelines-pro-type-reinterpret-cast)
       outputf.write(reinterpret_cast<char *>(&value), sizeof(float));
       outputf.close();
@@ -153,24 +171,24 @@ class GridTest : public ::testing::Test {
 
 TEST_F(GridTest, ReadFileTest) {
   string filename    = "input.txt";
-  struct File f_test = readFile(filename);
+  File<double> f_test = readFile<double>(filename);
   ASSERT_EQ(f_test.particles_per_meter, f_test.particles_per_meter);
   ASSERT_EQ(f_test.particles.size(), f_test.particles.size());
-  ASSERT_EQ(f_test.particles[0].position, f_test.particles[0].position);
-  ASSERT_EQ(f_test.particles[0].hv_vector, f_test.particles[0].hv_vector);
-  ASSERT_EQ(f_test.particles[0].speed, f_test.particles[0].speed);
-  ASSERT_EQ(f_test.particles[0].density, f_test.particles[0].density);
-  ASSERT_EQ(f_test.particles[0].acceleration, f_test.particles[0].acceleration);
+  ASSERT_EQ(f_test.particles.position[0], f_test.particles.position[0]);
+  ASSERT_EQ(f_test.particles.hv_vector[0], f_test.particles.hv_vector[0]);
+  ASSERT_EQ(f_test.particles.speed[0], f_test.particles.speed[0]);
+  ASSERT_EQ(f_test.particles.density[0], f_test.particles.density[0]);
+  ASSERT_EQ(f_test.particles.acceleration[0], f_test.particles.acceleration[0]);
 }
 
 TEST_F(GridTest, GridConstructorTest) {
   string filename    = "input.txt";
-  struct File f_test = readFile(filename);
-  Grid const grid(f_test);
+  File<double> f_test = readFile<double>(filename);
+  Grid<double> const grid(f_test);
   double const mass             = fluid_density / pow(grid.file.particles_per_meter, 3);
   double const smoothing_length = radius_multiplicator / grid.file.particles_per_meter;
-  Vector3D const bdist          = bmax - bmin;
-  Vector3D block_size     = Vector3D(0, 0, 0);
+  Vector3D<double> const bdist          = bmax - bmin;
+  Vector3D<double> block_size     = Vector3D<double>(0, 0, 0);
   int const n_blocks_x          = floor(bdist.x / smoothing_length);
   int const n_blocks_y          = floor(bdist.y / smoothing_length);
   int const n_blocks_z          = floor(bdist.z / smoothing_length);
@@ -185,16 +203,485 @@ TEST_F(GridTest, GridConstructorTest) {
   ASSERT_EQ(grid.block_size, block_size);
 }
 
+// Un recinto mas estrecho que la longitud de suavizado no tiene bloques en ese eje
+TEST_F(GridTest, BoxNarrowerThanSmoothingLengthTest) {
+  Scenario scenario;
+  // NOLINTNEXTLINE(cppcoreguidelines-avoid-magic-numbers,readability-magic-numbers,-warnings-as-errors)
+  scenario.bmax.x = scenario.bmin.x + 0.001;
+  ASSERT_FALSE(Grid<double>::fitsBox(sample_file().particles_per_meter, scenario));
+  ASSERT_TRUE(Grid<double>::fitsBox(sample_file().particles_per_meter, Scenario{}));
+  ASSERT_DEATH(Grid<double>(sample_file(), {}, scenario),
+               "Error: The box must be at least one smoothing length");
+}
+
 TEST_F(GridTest, BlockIndexTest) {
   string filename    = "input.txt";
-  struct File f_test = readFile(filename);
-  Grid const grid(f_test);
-  Vector3D const bindex = grid.blockIndex(f_test.particles[0]);
+  File<double> f_test = readFile<double>(filename);
+  Grid<double> const grid(f_test);
+  Vector3D<double> const bindex = grid.blockIndex(f_test.particles.position[0]);
   ASSERT_EQ(bindex.x, grid.n_blocks_x - 1);
   ASSERT_EQ(bindex.y, grid.n_blocks_y - 1);
   ASSERT_EQ(bindex.z, grid.n_blocks_z - 1);
 }
 
+TEST_F(GridTest, ParallelSimulationTest) {
+  // NOLINTNEXTLINE(cppcoreguidelines-avoid-magic-numbers,readability-magic-numbers,-warnings-as-errors)
+  File<double> f_test = latticeFile(8, 4e-3, Vector3D<double>(-0.01, -0.07, -0.01), 0);
+  Grid<double> serial(f_test);
+  Grid<double> parallel(f_test, SimulationOptions{.threads = 4});
+  Grid<double> parallel_2(f_test, SimulationOptions{.threads = 2});
+  for (int i = 0; i < 3; i++) {
+    serial.makeSimulation();
+    parallel.makeSimulation();
+    parallel_2.makeSimulation();
+  }
+  std::vector<size_t> const serial_slots     = serial.file.particles.slots();
+  std::vector<size_t> const parallel_slots   = parallel.file.particles.slots();
+  std::vector<size_t> const parallel_2_slots = parallel_2.file.particles.slots();
+  for (size_t id = 0; id < f_test.particles.size(); id++) {
+    size_t const i = parallel_slots[id];
+    size_t const j = parallel_2_slots[id];
+    // Mismo resultado con cualquier numero de hilos y muy cercano al recorrido en serie
+    ASSERT_EQ(parallel.file.particles.position[i], parallel_2.file.particles.position[j]);
+    ASSERT_EQ(parallel.file.particles.speed[i], parallel_2.file.particles.speed[j]);
+    Vector3D<double> const difference =
+        serial.file.particles.position[serial_slots[id]] - parallel.file.particles.position[i];
+    // NOLINTNEXTLINE(cppcoreguidelines-avoid-magic-numbers,readability-magic-numbers,-warnings-as-errors)
+    ASSERT_LT(difference.norm(), 1e-12);
+  }
+}
+
+// La simulacion en float sigue a la de double: mismos bloques y posiciones muy cercanas
+TEST_F(GridTest, SinglePrecisionTest) {
+  // NOLINTNEXTLINE(cppcoreguidelines-avoid-magic-numbers,readability-magic-numbers,-warnings-as-errors)
+  File<float> f_single = latticeFile<float>(8, 4e-3, Vector3D<double>(-0.01, -0.07, -0.01), 0);
+  File<double> f_test;
+  f_test.particles_per_meter = f_single.particles_per_meter;
+  for (size_t i = 0; i < f_single.particles.size(); i++) {
+    f_test.particles.push_back({.position = Vector3D<double>(f_single.particles.position[i])});
+  }
+  Grid<double> reference(f_test);
+  Grid<float> single(f_single);
+  ASSERT_EQ(reference.blocks.size(), single.blocks.size());
+  for (int i = 0; i < 3; i++) {
+    reference.makeSimulation();
+    single.makeSimulation();
+  }
+  std::vector<size_t> const reference_slots = reference.file.particles.slots();
+  std::vector<size_t> const single_slots    = single.file.particles.slots();
+  for (size_t id = 0; id < f_test.particles.size(); id++) {
+    Vector3D<double> const difference =
+        reference.file.particles.position[reference_slots[id]] -
+        Vector3D<double>(single.file.particles.position[single_slots[id]]);
+    // NOLINTNEXTLINE(cppcoreguidelines-avoid-magic-numbers,readability-magic-numbers,-warnings-as-errors)
+    ASSERT_LT(difference.norm(), 1e-6);
+  }
+}
+
+TEST_F(GridTest, NeighboursTest) {
+  File<double> f_test;
+  // NOLINTNEXTLINE(cppcoreguidelines-avoid-magic-numbers,readability-magic-numbers,-warnings-as-errors)
+  f_test.particles_per_meter = 204;
+  Grid<double> grid(f_test);
+  // Una particula en el centro de cada bloque, salvo en el segundo
+  for (Block const & block : grid.blocks) {
+    if (&block == &grid.blocks[1]) { continue; }
+    Particle<double> particle;
+    // NOLINTNEXTLINE(cppcoreguidelines-avoid-magic-numbers,readability-magic-numbers,-warnings-as-errors)
+    Vector3D<double> const center(block.x + 0.5, block.y + 0.5, block.z + 0.5);
+    particle.position = grid.physics.bmin + Vector3D<double>(center.x * grid.block_size.x,
+                                                             center.y * grid.block_size.y,
+                                                             center.z * grid.block_size.z);
+    grid.file.particles.push_back(particle);
+  }
+  ASSERT_EQ(grid.neighbour_begin.size(), 1U);
+  grid.sortParticles();
+  ASSERT_EQ(grid.neighbour_begin.size(), grid.blocks.size());
+  ASSERT_EQ(grid.active_blocks.size(), grid.blocks.size());
+  // El segundo bloque no tiene vecinos anotados, pero esta activo por ser vecino del primero
+  ASSERT_EQ(grid.blocks[1].neighbours, Block::none);
+  ASSERT_TRUE(grid.blocks[1].active);
+  // Bloque interior: el mismo y los 13 vecinos con indice mayor
+  size_t const interior = 1 + grid.n_blocks_x + grid.n_blocks_x * grid.n_blocks_y;
+  size_t const table    = grid.blocks[interior].neighbours;
+  ASSERT_EQ(grid.neighbour_begin[table + 1] - grid.neighbour_begin[table], 14U);
+  for (size_t n = grid.neighbour_begin[table]; n < grid.neighbour_begin[table + 1]; n++) {
+    ASSERT_GE(grid.neighbour_blocks[n], interior);
+  }
+  // Ultimo bloque: solo el mismo
+  size_t const last = grid.blocks.back().neighbours;
+  ASSERT_EQ(grid.neighbour_begin[last + 1] - grid.neighbour_begin[last], 1U);
+  ASSERT_EQ(grid.neighbour_blocks[grid.neighbour_begin[last]], grid.blocks.size() - 1);
+}
+
+// Con listas de Verlet el resultado sigue al recorrido por bloques, tambien con varios hilos,
+// y la lista contiene todas las parejas dentro del radio de suavizado
+TEST_F(GridTest, VerletListTest) {
+  // NOLINTNEXTLINE(cppcoreguidelines-avoid-magic-numbers,readability-magic-numbers,-warnings-as-errors)
+  File<double> f_test = latticeFile(8, 4e-3, Vector3D<double>(-0.01, -0.07, -0.01), 0);
+  Grid<double> blocks(f_test, SimulationOptions{.kernel = KernelType::scalar});
+  // NOLINTNEXTLINE(cppcoreguidelines-avoid-magic-numbers,readability-magic-numbers,-warnings-as-errors)
+  Grid<double> verlet(f_test, SimulationOptions{.verlet_skin = 0.5});
+  // NOLINTNEXTLINE(cppcoreguidelines-avoid-magic-numbers,readability-magic-numbers,-warnings-as-errors)
+  Grid<double> parallel(f_test, SimulationOptions{.threads = 4, .verlet_skin = 0.5});
+  ASSERT_EQ(verlet.verlet_reach, 2);
+  ASSERT_EQ(parallel.block_colors.size(), 125U);
+  for (int i = 0; i < 3; i++) {
+    blocks.makeSimulation();
+    verlet.makeSimulation();
+    parallel.makeSimulation();
+  }
+  std::vector<size_t> const blocks_slots   = blocks.file.particles.slots();
+  std::vector<size_t> const verlet_slots   = verlet.file.particles.slots();
+  std::vector<size_t> const parallel_slots = parallel.file.particles.slots();
+  for (size_t id = 0; id < f_test.particles.size(); id++) {
+    Vector3D<double> const position = verlet.file.particles.position[verlet_slots[id]];
+    // NOLINTNEXTLINE(cppcoreguidelines-avoid-magic-numbers,readability-magic-numbers,-warnings-as-errors)
+    ASSERT_LT((blocks.file.particles.position[blocks_slots[id]] - position).norm(), 1e-12);
+    // NOLINTNEXTLINE(cppcoreguidelines-avoid-magic-numbers,readability-magic-numbers,-warnings-as-errors)
+    ASSERT_LT((parallel.file.particles.position[parallel_slots[id]] - position).norm(), 1e-12);
+  }
+
+  Vector3DArray<double> const & position = verlet.file.particles.position;
+  size_t listed                           = 0;
+  size_t inside                           = 0;
+  for (size_t i = 0; i < f_test.particles.size(); i++) {
+    for (size_t j = i + 1; j < f_test.particles.size(); j++) {
+      if ((position[i] - position[j]).norm() >= verlet.smoothing_lenght) { continue; }
+      inside++;
+      auto const listed_pair = [&](size_t first, size_t second) {
+        auto const begin = verlet.verlet_pairs.begin() +
+                           static_cast<std::ptrdiff_t>(verlet.verlet_begin[first]);
+        auto const end = verlet.verlet_pairs.begin() +
+                         static_cast<std::ptrdiff_t>(verlet.verlet_begin[first + 1]);
+        return std::find(begin, end, second) != end;
+      };
+      listed += listed_pair(i, j) || listed_pair(j, i) ? 1 : 0;
+    }
+  }
+  ASSERT_GT(inside, 0U);
+  ASSERT_EQ(listed, inside);
+}
+
+// Fusionar los reinicios en otras pasadas no cambia ninguna operacion: mismo resultado exacto
+TEST_F(GridTest, FusedStepTest) {
+  File<double> const f_test = sample_file();
+  for (unsigned int const threads : {1U, 3U}) {
+    File<double> f_fused   = f_test;
+    File<double> f_unfused  = f_test;
+    Grid<double> fused(f_fused, SimulationOptions{.threads = threads, .fused = true});
+    Grid<double> unfused(f_unfused, SimulationOptions{.threads = threads, .fused = false});
+    for (int i = 0; i < 3; i++) {
+      fused.makeSimulation();
+      unfused.makeSimulation();
+    }
+    Particles<double> const & expected = unfused.file.particles;
+    Particles<double> const & obtained = fused.file.particles;
+    ASSERT_EQ(obtained.id, expected.id);
+    for (size_t i = 0; i < expected.size(); i++) {
+      ASSERT_EQ(obtained.position[i], expected.position[i]);
+      ASSERT_EQ(obtained.speed[i], expected.speed[i]);
+      ASSERT_EQ(obtained.hv_vector[i], expected.hv_vector[i]);
+      ASSERT_EQ(obtained.acceleration[i], expected.acceleration[i]);
+      ASSERT_EQ(obtained.density[i], expected.density[i]);
+    }
+  }
+}
+
+TEST_F(GridTest, PairCacheTest) {
+  File<double> f_test = sample_file();
+  // Particulas a 3 mm para que haya parejas dentro del radio de suavizado
+  for (size_t i = 0; i < f_test.particles.size(); i++) {
+    // NOLINTNEXTLINE(cppcoreguidelines-avoid-magic-numbers,readability-magic-numbers,-warnings-as-errors)
+    f_test.particles.position.set(i, f_test.particles.position[i] * 0.3);
+  }
+  File<double> f_cached     = f_test;
+  File<double> f_plain      = f_test;
+  Grid<double> cached(f_cached,
+                      SimulationOptions{.kernel = KernelType::scalar, .pair_cache = true});
+  Grid<double> plain(f_plain, SimulationOptions{.kernel = KernelType::scalar});
+  ASSERT_EQ(plain.pairCacheBytes(), 0U);
+  for (int i = 0; i < 3; i++) {
+    cached.makeSimulation();
+    plain.makeSimulation();
+  }
+  Particles<double> const & expected = plain.file.particles;
+  Particles<double> const & obtained = cached.file.particles;
+  for (size_t i = 0; i < expected.size(); i++) {
+    ASSERT_EQ(obtained.position[i], expected.position[i]);
+    ASSERT_EQ(obtained.speed[i], expected.speed[i]);
+    ASSERT_EQ(obtained.density[i], expected.density[i]);
+  }
+  size_t pairs = 0;
+  for (size_t used : cached.pair_cache_used) { pairs += used; }
+  ASSERT_GT(pairs, 0U);
+  ASSERT_GE(cached.pairCacheBytes(), pairs * sizeof(CachedPair<double>));
+}
+
+TEST_F(GridTest, SortParticlesTest) {
+  File<double> f_test;
+  // NOLINTNEXTLINE(cppcoreguidelines-avoid-magic-numbers,readability-magic-numbers,-warnings-as-errors)
+  f_test.particles_per_meter = 204;
+  // NOLINTNEXTLINE(cppcoreguidelines-avoid-magic-numbers,readability-magic-numbers,-warnings-as-errors)
+  for (int i = 0; i < 100; i++) {
+    Particle<double> particle;
+    // Particulas repartidas en orden inverso al de los bloques
+    // NOLINTNEXTLINE(cppcoreguidelines-avoid-magic-numbers,readability-magic-numbers,-warnings-as-errors)
+    particle.position = bmax - Vector3D<double>(1, 1, 1) * (1e-3 * i + 1e-4);
+    f_test.particles.push_back(particle);
+  }
+  Grid<double> grid(f_test);
+  grid.sortParticles();
+  size_t total = 0;
+  for (size_t b = 0; b < grid.blocks.size(); b++) {
+    Block const & block = grid.blocks[b];
+    total += block.size();
+    for (size_t i = block.begin; i < block.end; i++) {
+      Vector3D<double> const index = grid.blockIndex(grid.file.particles.position[i]);
+      ASSERT_EQ(static_cast<size_t>(index.x + index.y * grid.n_blocks_x +
+                                    index.z * grid.n_blocks_x * grid.n_blocks_y),
+                b);
+      ASSERT_EQ(grid.linearBlockIndex(grid.file.particles.position[i]), b);
+      if (i > block.begin) { ASSERT_LT(grid.file.particles.id[i - 1], grid.file.particles.id[i]); }
+    }
+  }
+  ASSERT_EQ(total, f_test.particles.size());
+  std::vector<size_t> const slots = grid.file.particles.slots();
+  for (size_t id = 0; id < f_test.particles.size(); id++) {
+    ASSERT_EQ(grid.file.particles.position[slots[id]], f_test.particles.position[id]);
+  }
+}
+
+// Con una curva, cada particula esta en el bloque de sus coordenadas, los vecinos se
+// reparten igual que en el orden lineal y la simulacion solo cambia en el redondeo
+TEST_F(GridTest, BlockOrderTest) {
+  File<double> f_test = sample_file();
+  for (size_t i = 0; i < f_test.particles.size(); i++) {
+    // NOLINTNEXTLINE(cppcoreguidelines-avoid-magic-numbers,readability-magic-numbers,-warnings-as-errors)
+    f_test.particles.position.set(i, f_test.particles.position[i] * 0.3);
+  }
+  File<double> f_linear = f_test;
+  Grid<double> linear(f_linear, SimulationOptions{.kernel = KernelType::scalar});
+  for (BlockOrder const order : {BlockOrder::morton, BlockOrder::hilbert}) {
+    File<double> f_curve = f_test;
+    Grid<double> curve(f_curve,
+                       SimulationOptions{.kernel = KernelType::scalar, .block_order = order});
+    ASSERT_EQ(curve.blocks.size(), linear.blocks.size());
+    curve.sortParticles();
+    linear.sortParticles();
+    ASSERT_EQ(curve.neighbour_begin.size(), linear.neighbour_begin.size());
+    for (size_t b = 0; b < curve.blocks.size(); b++) {
+      Block const & block = curve.blocks[b];
+      for (size_t i = block.begin; i < block.end; i++) {
+        Vector3D<double> const index = curve.blockIndex(curve.file.particles.position[i]);
+        ASSERT_EQ(index, Vector3D<double>(block.x, block.y, block.z));
+        ASSERT_EQ(curve.linearBlockIndex(curve.file.particles.position[i]), b);
+      }
+    }
+  }
+  File<double> f_hilbert = f_test;
+  Grid<double> hilbert(f_hilbert, SimulationOptions{.kernel      = KernelType::scalar,
+                                                    .block_order = BlockOrder::hilbert});
+  for (int i = 0; i < 3; i++) {
+    linear.makeSimulation();
+    hilbert.makeSimulation();
+  }
+  std::vector<size_t> const linear_slots  = linear.file.particles.slots();
+  std::vector<size_t> const hilbert_slots = hilbert.file.particles.slots();
+  for (size_t id = 0; id < f_test.particles.size(); id++) {
+    Vector3D<double> const difference = hilbert.file.particles.position[hilbert_slots[id]] -
+                                        linear.file.particles.position[linear_slots[id]];
+    // NOLINTNEXTLINE(cppcoreguidelines-avoid-magic-numbers,readability-magic-numbers,-warnings-as-errors)
+    ASSERT_LT(difference.norm(), 1e-12);
+  }
+}
+
+// Solo los bloques del borde tienen paredes y estan en wall_blocks, agrupados por paredes
+TEST_F(GridTest, WallBlocksTest) {
+  File<double> f_test = sample_file();
+  Grid<double> const grid(f_test, SimulationOptions{.block_order = BlockOrder::hilbert});
+  auto const expected = [](int position, int n_blocks, uint8_t low, uint8_t high) {
+    if (position == 0) { return low; }
+    return position == n_blocks - 1 ? high : uint8_t{0};
+  };
+  size_t n_walls = 0;
+  for (Block const & block : grid.blocks) {
+    uint8_t const walls = expected(block.x, grid.n_blocks_x, Block::wall_x_min, Block::wall_x_max) |
+                          expected(block.y, grid.n_blocks_y, Block::wall_y_min, Block::wall_y_max) |
+                          expected(block.z, grid.n_blocks_z, Block::wall_z_min, Block::wall_z_max);
+    ASSERT_EQ(block.walls, walls);
+    if (walls != 0) { n_walls++; }
+  }
+  ASSERT_EQ(grid.wall_blocks.size(), n_walls);
+  for (size_t i = 0; i < grid.wall_blocks.size(); i++) {
+    ASSERT_NE(grid.blocks[grid.wall_blocks[i]].walls, 0);
+    if (i > 0) {
+      ASSERT_LE(grid.blocks[grid.wall_blocks[i - 1]].walls, grid.blocks[grid.wall_blocks[i]].walls);
+    }
+  }
+}
+
+// Una rejilla reutilizada con load da el mismo resultado, bit a bit, que una nueva, aunque
+// las particulas ocupen otros bloques y cambie la viscosidad
+TEST_F(GridTest, LoadTest) {
+  File<double> first = sample_file();
+  File<double> next  = sample_file();
+  for (size_t i = 0; i < next.particles.size(); i++) {
+    // NOLINTNEXTLINE(cppcoreguidelines-avoid-magic-numbers,readability-magic-numbers,-warnings-as-errors)
+    next.particles.position.set(i, next.particles.position[i] + Vector3D<double>(0.03, 0.05, 0));
+  }
+  Scenario viscous;
+  // NOLINTNEXTLINE(cppcoreguidelines-avoid-magic-numbers,readability-magic-numbers,-warnings-as-errors)
+  viscous.viscosity = 0.8;
+  for (unsigned int const threads : {1U, 4U}) {
+    SimulationOptions const options{.threads = threads, .kernel = KernelType::scalar};
+    Grid<double> reused(first, options);
+    // NOLINTNEXTLINE(cppcoreguidelines-avoid-magic-numbers,readability-magic-numbers,-warnings-as-errors)
+    for (int step = 0; step < 5; step++) { reused.makeSimulation(); }
+    ASSERT_TRUE(reused.reusable(next, options, viscous));
+    reused.load(next, viscous);
+    Grid<double> fresh(next, options, viscous);
+    // NOLINTNEXTLINE(cppcoreguidelines-avoid-magic-numbers,readability-magic-numbers,-warnings-as-errors)
+    for (int step = 0; step < 5; step++) {
+      reused.makeSimulation();
+      fresh.makeSimulation();
+    }
+    vector<char> reused_bytes;
+    vector<char> fresh_bytes;
+    reused.packSimulation(reused_bytes);
+    fresh.packSimulation(fresh_bytes);
+    ASSERT_EQ(reused_bytes, fresh_bytes);
+    ASSERT_EQ(reused.file.particles.position.x, fresh.file.particles.position.x);
+  }
+
+  Grid<double> const grid(first);
+  Scenario wider;
+  // NOLINTNEXTLINE(cppcoreguidelines-avoid-magic-numbers,readability-magic-numbers,-warnings-as-errors)
+  wider.bmax.x = 0.1;
+  File<double> finer = first;
+  // NOLINTNEXTLINE(cppcoreguidelines-avoid-magic-numbers,readability-magic-numbers,-warnings-as-errors)
+  finer.particles_per_meter = 300;
+  ASSERT_FALSE(grid.reusable(first, {}, wider));
+  ASSERT_FALSE(grid.reusable(finer, {}, {}));
+  ASSERT_FALSE(grid.reusable(first, {.threads = 2}, {}));
+}
+
+// Con paso fijo, limitTimeStep solo recorta el ultimo paso antes del tiempo pedido
+TEST_F(GridTest, TimeStepTest) {
+  File<double> f_test = sample_file();
+  SimulationOptions const options{.kernel = KernelType::scalar};
+  Grid<double> steps(f_test, options);
+  Grid<double> timed(f_test, options);
+  // NOLINTNEXTLINE(cppcoreguidelines-avoid-magic-numbers,readability-magic-numbers,-warnings-as-errors)
+  double const end_time = 5e-3;
+  // NOLINTNEXTLINE(cppcoreguidelines-avoid-magic-numbers,readability-magic-numbers,-warnings-as-errors)
+  for (int step = 0; step < 5; step++) {
+    ASSERT_FALSE(timed.reachedTime(end_time));
+    timed.limitTimeStep(end_time);
+    ASSERT_EQ(timed.time_step, time_increase);
+    timed.makeSimulation();
+    steps.makeSimulation();
+  }
+  ASSERT_TRUE(timed.reachedTime(end_time));
+  ASSERT_EQ(timed.time, steps.time);
+  ASSERT_EQ(timed.file.particles.position.x, steps.file.particles.position.x);
+
+  // NOLINTNEXTLINE(cppcoreguidelines-avoid-magic-numbers,readability-magic-numbers,-warnings-as-errors)
+  double const longer = end_time + 4e-4;
+  timed.limitTimeStep(longer);
+  EXPECT_NEAR(timed.time_step, longer - timed.time, 1e-15);
+  EXPECT_NEAR(timed.physics.time_increase, timed.time_step, 1e-15);
+  timed.makeSimulation();
+  EXPECT_TRUE(timed.reachedTime(longer));
+  EXPECT_EQ(timed.time_step, time_increase);
+}
+
+// Cada paso adaptativo sale de los maximos de |hv| y |a| del anterior, sin crecer mas de
+// time_step_growth ni pasar de time_increase
+TEST_F(GridTest, AdaptiveTimeStepTest) {
+  File<double> f_test = sample_file();
+  Scenario scenario;
+  // NOLINTNEXTLINE(cppcoreguidelines-avoid-magic-numbers,readability-magic-numbers,-warnings-as-errors)
+  scenario.courant = 0.1;
+  Grid<double> serial(f_test, {.kernel = KernelType::scalar}, scenario);
+  Grid<double> profiled(f_test, {.kernel = KernelType::scalar, .profile = true}, scenario);
+  Grid<double> parallel(f_test, {.threads = 4, .kernel = KernelType::scalar}, scenario);
+  double const h = serial.smoothing_lenght;
+  // Primer paso: velocidades iniciales y aceleracion externa
+  double initial_speed = 0;
+  for (size_t i = 0; i < f_test.particles.size(); i++) {
+    initial_speed = max(initial_speed, f_test.particles.hv_vector[i].norm());
+  }
+  double const first =
+      min({time_increase, scenario.courant * h / initial_speed,
+           scenario.courant * sqrt(h / external_acceleration.norm())});
+  EXPECT_DOUBLE_EQ(serial.time_step, first);
+
+  double time = 0;
+  // NOLINTNEXTLINE(cppcoreguidelines-avoid-magic-numbers,readability-magic-numbers,-warnings-as-errors)
+  for (int step = 0; step < 10; step++) {
+    double const previous = serial.time_step;
+    serial.makeSimulation();
+    profiled.makeSimulation();
+    parallel.makeSimulation();
+    time += previous;
+    double speed        = 0;
+    double acceleration = 0;
+    for (size_t i = 0; i < serial.file.particles.size(); i++) {
+      speed        = max(speed, serial.file.particles.hv_vector[i].norm());
+      acceleration = max(acceleration, serial.file.particles.acceleration[i].norm());
+    }
+    double const expected =
+        min({time_increase, time_step_growth * previous, scenario.courant * h / speed,
+             scenario.courant * sqrt(h / acceleration)});
+    EXPECT_DOUBLE_EQ(serial.time_step, expected);
+    EXPECT_DOUBLE_EQ(serial.time, time);
+    EXPECT_EQ(profiled.time_step, serial.time_step);
+    // NOLINTNEXTLINE(cppcoreguidelines-avoid-magic-numbers,readability-magic-numbers,-warnings-as-errors)
+    EXPECT_NEAR(parallel.time_step, serial.time_step, serial.time_step * 1e-9);
+  }
+  EXPECT_LT(serial.time_step, time_increase);
+}
+
+// Una particula rebota en la pared x = bmin y sale de su bloque: el bloque vacio deja de
+// contar en el paso adaptativo, con perfil y sin el
+TEST_F(GridTest, AdaptiveEmptyWallBlockTest) {
+  File<double> f_test;
+  // NOLINTNEXTLINE(cppcoreguidelines-avoid-magic-numbers,readability-magic-numbers,-warnings-as-errors)
+  f_test.particles_per_meter = 204;
+  Particle<double> bouncing;
+  // NOLINTNEXTLINE(cppcoreguidelines-avoid-magic-numbers,readability-magic-numbers,-warnings-as-errors)
+  bouncing.position  = Vector3D<double>(-0.064, 0.0, 0.0);
+  // NOLINTNEXTLINE(cppcoreguidelines-avoid-magic-numbers,readability-magic-numbers,-warnings-as-errors)
+  bouncing.hv_vector = Vector3D<double>(-0.5, 0.0, 0.0);
+  bouncing.speed     = bouncing.hv_vector;
+  Particle<double> still;
+  still.position = Vector3D<double>(0.0, 0.0, 0.0);
+  f_test.particles.push_back(bouncing);
+  f_test.particles.push_back(still);
+  Scenario scenario;
+  // NOLINTNEXTLINE(cppcoreguidelines-avoid-magic-numbers,readability-magic-numbers,-warnings-as-errors)
+  scenario.courant = 0.05;
+  Grid<double> plain(f_test, {.kernel = KernelType::scalar}, scenario);
+  Grid<double> profiled(f_test, {.kernel = KernelType::scalar, .profile = true}, scenario);
+  size_t const wall_block = plain.linearBlockIndex(bouncing.position);
+  ASSERT_NE(plain.blocks[wall_block].walls, 0);
+  bool left = false;
+  // NOLINTNEXTLINE(cppcoreguidelines-avoid-magic-numbers,readability-magic-numbers,-warnings-as-errors)
+  for (int step = 0; step < 400; step++) {
+    plain.makeSimulation();
+    profiled.makeSimulation();
+    ASSERT_EQ(plain.time_step, profiled.time_step);
+    left = left || plain.blocks[wall_block].size() == 0;
+  }
+  ASSERT_TRUE(left);
+  vector<char> plain_bytes;
+  vector<char> profiled_bytes;
+  plain.packSimulation(plain_bytes);
+  profiled.packSimulation(profiled_bytes);
+  ASSERT_EQ(plain_bytes, profiled_bytes);
+}
+
 TEST_F(GridTest, InvalidNp) {
   string filename = "input1.txt";
   ofstream outputf(filename);
@@ -206,7 +693,7 @@ TEST_F(GridTest, InvalidNp) {
   outputf.write(reinterpret_cast<char *>(&particles_number), sizeof(particles_number));
   outputf.close();
 
-  ASSERT_DEATH(readFile(filename), "Error: Invalid number of particles: 0");
+  ASSERT_DEATH(readFile<double>(filename), "Error: Invalid number of particles: 0");
   if (remove("input1.txt") != 0) { perror("Error deleting file"); }
 }
 
@@ -221,15 +708,61 @@ TEST_F(GridTest, DifferentNp) {
   outputf.write(reinterpret_cast<char *>(&particles_number), sizeof(particles_number));
   outputf.close();
 
-  ASSERT_DEATH(readFile(filename), "Error: Number of particles mismatch. Header: 2, Found: 0");
+  ASSERT_DEATH(readFile<double>(filename), "Error: Number of particles mismatch. Header: 2, Found: 0");
   if (remove("input2.txt") != 0) { perror("Error deleting file"); }
 }
 
+TEST_F(GridTest, TruncatedRecord) {
+  string filename = "input4.txt";
+  ofstream outputf(filename);
+  float value          = 1;
+  int particles_number = 1;
+  // NOLINTNEXTLINE(cppcoreguidelines-pro-type-reinterpret-cast)
+  outputf.write(reinterpret_cast<char *>(&value), sizeof(value));
+  // NOLINTNEXTLINE(cppcoreguidelines-pro-type-reinterpret-cast)
+  outputf.write(reinterpret_cast<char *>(&particles_number), sizeof(particles_number));
+  // NOLINTNEXTLINE(cppcoreguidelines-avoid-magic-numbers,readability-magic-numbers,-warnings-as-errors)
+  for (int i = 0; i < 10; i++) {
+    // NOLINTNEXTLINE(cppcoreguidelines-pro-type-reinterpret-cast)
+    outputf.write(reinterpret_cast<char *>(&value), sizeof(value));
+  }
+  outputf.close();
+
+  ASSERT_DEATH(readFile<double>(filename), "Error: Truncated particle record in input4.txt");
+  if (remove("input4.txt") != 0) { perror("Error deleting file"); }
+}
+
+TEST_F(GridTest, MissingFile) {
+  string filename = "missing.fld";
+  ASSERT_DEATH(readFile<double>(filename), "Error: Cannot open missing.fld for reading.");
+}
+
+// readFile (mmap) lee exactamente lo mismo que la lectura campo a campo con std::ifstream
+TEST_F(GridTest, ReadFileMatchesStream) {
+  File<double> f_test = sample_file();
+  string filename     = "input3.txt";
+  Grid<double> grid(f_test);
+  grid.writeSimulation(filename);
+
+  File<double> const mapped = readFile<double>(filename);
+  File<double> const stream = readFileStream<double>(filename);
+  File<float> const single  = readFile<float>(filename);
+  ASSERT_EQ(mapped.particles_per_meter, stream.particles_per_meter);
+  ASSERT_EQ(mapped.particles.size(), stream.particles.size());
+  for (size_t i = 0; i < stream.particles.size(); i++) {
+    ASSERT_EQ(mapped.particles.position[i], stream.particles.position[i]);
+    ASSERT_EQ(mapped.particles.hv_vector[i], stream.particles.hv_vector[i]);
+    ASSERT_EQ(mapped.particles.speed[i], stream.particles.speed[i]);
+    ASSERT_EQ(Vector3D<double>(single.particles.speed[i]), stream.particles.speed[i]);
+  }
+  if (remove("input3.txt") != 0) { perror("Error deleting file"); }
+}
+
 TEST_F(GridTest, WriteSimulation) {
   string inputFilename  = "input.txt";
   string outputFilename = "simulation.txt";
-  struct File f_test    = readFile(inputFilename);
-  Grid grid(f_test);
+  File<double> f_test    = readFile<double>(inputFilename);
+  Grid<double> grid(f_test);
   grid.writeSimulation(outputFilename);
   ifstream intputF(inputFilename);
   ifstream outputF(outputFilename);
@@ -242,15 +775,53 @@ TEST_F(GridTest, WriteSimulation) {
   if (remove("simulation.txt") != 0) { perror("Error deleting file"); }
 }
 
+// writeSimulation (en memoria y con pwrite) produce los mismos bytes que la escritura campo a
+// campo con std::ofstream, tambien con O_DIRECT y desde el hilo de AsyncWriter
+TEST_F(GridTest, WriteSimulationMatchesStream) {
+  File<double> f_test = sample_file();
+  Grid<double> grid(f_test);
+  grid.makeSimulation();
+  string streamFilename = "stream.txt";
+  grid.writeSimulationStream(streamFilename);
+  ifstream streamF(streamFilename, ios::binary);
+  string const expected((istreambuf_iterator<char>(streamF)), istreambuf_iterator<char>());
+  streamF.close();
+
+  vector<string> filenames = {"buffered.txt", "direct.txt", "async.txt"};
+  grid.writeSimulation(filenames[0]);
+  grid.write_mode = WriteMode::direct;
+  grid.writeSimulation(filenames[1]);
+  AsyncWriter writer;
+  grid.writeSimulation(filenames[2], writer);
+  ASSERT_TRUE(writer.wait());
+  for (string const & filename : filenames) {
+    ifstream outputF(filename, ios::binary);
+    string const obtained((istreambuf_iterator<char>(outputF)), istreambuf_iterator<char>());
+    outputF.close();
+    ASSERT_EQ(obtained, expected) << filename;
+    if (remove(filename.c_str()) != 0) { perror("Error deleting file"); }
+  }
+  if (remove("stream.txt") != 0) { perror("Error deleting file"); }
+}
+
+TEST_F(GridTest, WriteSimulationCannotOpen) {
+  string inputFilename  = "input.txt";
+  string outputFilename = "missing/simulation.txt";
+  File<double> f_test   = readFile<double>(inputFilename);
+  Grid<double> grid(f_test);
+  ASSERT_DEATH(grid.writeSimulation(outputFilename),
+               "Error: Cannot open missing/simulation.txt for writing.");
+}
+
 TEST_F(GridTest, EvalDensities) {
   /* Evalúa tanto el incremento, como la transofrmación de densidades */
   string inputFilename  = "./trz/small/repos-base-1.trz";
   string outputFilename = "./trz/small/densinc-base-1.trz";
-  Grid small_repos      = grid_from_trz(inputFilename);
-  Grid small_densinc    = grid_from_trz(outputFilename);
+  Grid<double> small_repos      = grid_from_trz(inputFilename);
+  Grid<double> small_densinc    = grid_from_trz(outputFilename);
   for (size_t i = 0; i < small_repos.blocks.size(); i++) { small_repos.evalDensities(i); }
   for (size_t i = 0; i < small_repos.file.particles.size(); i++) {
-    ASSERT_EQ(small_repos.file.particles[i].density, small_densinc.file.particles[i].density);
+    ASSERT_EQ(small_repos.file.particles.density[i], small_densinc.file.particles.density[i]);
   }
 }
 
@@ -258,11 +829,11 @@ TEST_F(GridTest, TransformDensities) {
   /* Evalúa tanto el incremento, como la transofrmación de densidades */
   string inputFilename  = "./trz/small/densinc-base-1.trz";
   string outputFilename = "./trz/small/denstransf-base-1.trz";
-  Grid small_densinc    = grid_from_trz(inputFilename);
-  Grid small_denstransf = grid_from_trz(outputFilename);
+  Grid<double> small_densinc    = grid_from_trz(inputFilename);
+  Grid<double> small_denstransf = grid_from_trz(outputFilename);
   for (Block & block : small_densinc.blocks) { small_densinc.transformDensities(block); }
   for (size_t i = 0; i < small_densinc.file.particles.size(); i++) {
-    ASSERT_EQ(small_densinc.file.particles[i].density, small_denstransf.file.particles[i].density);
+    ASSERT_EQ(small_densinc.file.particles.density[i], small_denstransf.file.particles.density[i]);
   }
 }
 
@@ -270,27 +841,28 @@ TEST_F(GridTest, EvalAccelerations) {
   /* Evalúa tanto el incremento, como la transofrmación de densidades */
   string inputFilename  = "./trz/small/denstransf-base-1.trz";
   string outputFilename = "./trz/small/acctransf-base-1.trz";
-  Grid small_denstransf = grid_from_trz(inputFilename);
-  Grid small_acctransf  = grid_from_trz(outputFilename);
+  Grid<double> small_denstransf = grid_from_trz(inputFilename);
+  Grid<double> small_acctransf  = grid_from_trz(outputFilename);
   for (size_t i = 0; i < small_denstransf.blocks.size(); i++) {
     small_denstransf.evalAccelerations(i);
   }
   for (size_t i = 0; i < small_denstransf.file.particles.size(); i++) {
-    ASSERT_EQ(small_denstransf.file.particles[i].acceleration,
-              small_acctransf.file.particles[i].acceleration);
+    ASSERT_EQ(small_denstransf.file.particles.acceleration[i],
+              small_acctransf.file.particles.acceleration[i]);
   }
 }
 
 TEST_F(GridTest, CollisionsBlock) {
   string inputFilename  = "./trz/small/acctransf-base-1.trz";
   string outputFilename = "./trz/small/partcol-base-1.trz";
-  Grid small_acctransf  = grid_from_trz(inputFilename);
-  Grid small_partcol    = grid_from_trz(outputFilename);
+  Grid<double> small_acctransf  = grid_from_trz(inputFilename);
+  Grid<double> small_partcol    = grid_from_trz(outputFilename);
   for (size_t i = 0; i < small_acctransf.blocks.size(); i++) {
     small_acctransf.collisions(small_acctransf.blocks[i]);
-    for (size_t const particle_index : small_acctransf.blocks[i].particles) {
-      ASSERT_EQ(small_acctransf.file.particles[particle_index].acceleration,
-                small_partcol.file.particles[particle_index].acceleration);
+    Block const & block = small_acctransf.blocks[i];
+    for (size_t particle_index = block.begin; particle_index < block.end; particle_index++) {
+      ASSERT_EQ(small_acctransf.file.particles.acceleration[particle_index],
+                small_partcol.file.particles.acceleration[particle_index]);
     }
   }
 }
@@ -298,18 +870,18 @@ TEST_F(GridTest, CollisionsBlock) {
 TEST_F(GridTest, UpdateParticle) {
   string inputFilename  = "./trz/small/partcol-base-1.trz";
   string outputFilename = "./trz/small/motion-base-1.trz";
-  Grid small_partcol    = grid_from_trz(inputFilename);
-  Grid small_motion     = grid_from_trz(outputFilename);
+  Grid<double> small_partcol    = grid_from_trz(inputFilename);
+  Grid<double> small_motion     = grid_from_trz(outputFilename);
 
   for (Block & block : small_partcol.blocks) {
     small_partcol.updateParticle(block);
-    for (size_t const particle_index : block.particles) {
-      ASSERT_EQ(small_partcol.file.particles[particle_index].position,
-                small_motion.file.particles[particle_index].position);
-      ASSERT_EQ(small_partcol.file.particles[particle_index].hv_vector,
-                small_motion.file.particles[particle_index].hv_vector);
-      ASSERT_EQ(small_partcol.file.particles[particle_index].speed,
-                small_motion.file.particles[particle_index].speed);
+    for (size_t particle_index = block.begin; particle_index < block.end; particle_index++) {
+      ASSERT_EQ(small_partcol.file.particles.position[particle_index],
+                small_motion.file.particles.position[particle_index]);
+      ASSERT_EQ(small_partcol.file.particles.hv_vector[particle_index],
+                small_motion.file.particles.hv_vector[particle_index]);
+      ASSERT_EQ(small_partcol.file.particles.speed[particle_index],
+                small_motion.file.particles.speed[particle_index]);
     }
   }
 }
@@ -317,17 +889,17 @@ TEST_F(GridTest, UpdateParticle) {
 TEST_F(GridTest, Interacitions) {
   string inputFilename  = "./trz/small/motion-base-1.trz";
   string outputFilename = "./trz/small/boundint-base-1.trz";
-  Grid small_motion     = grid_from_trz(inputFilename);
-  Grid small_boundint   = grid_from_trz(outputFilename);
+  Grid<double> small_motion     = grid_from_trz(inputFilename);
+  Grid<double> small_boundint   = grid_from_trz(outputFilename);
   for (Block & block : small_motion.blocks) {
     small_motion.interactions(block);
-    for (size_t const particle_index : block.particles) {
-      ASSERT_EQ(small_motion.file.particles[particle_index].position,
-                small_boundint.file.particles[particle_index].position);
-      ASSERT_EQ(small_motion.file.particles[particle_index].hv_vector,
-                small_boundint.file.particles[particle_index].hv_vector);
-      ASSERT_EQ(small_motion.file.particles[particle_index].speed,
-                small_boundint.file.particles[particle_index].speed);
+    for (size_t particle_index = block.begin; particle_index < block.end; particle_index++) {
+      ASSERT_EQ(small_motion.file.particles.position[particle_index],
+                small_boundint.file.particles.position[particle_index]);
+      ASSERT_EQ(small_motion.file.particles.hv_vector[particle_index],
+                small_boundint.file.particles.hv_vector[particle_index]);
+      ASSERT_EQ(small_motion.file.particles.speed[particle_index],
+                small_boundint.file.particles.speed[particle_index]);
     }
   }
 }
\ No newline at end of file
@@ -0,0 +1,83 @@
+#include "sim/grid.hpp"
+#include "sim/kernels.hpp"
+#include "utest/lattice.hpp"
+
+#include <cmath>
+#include <concepts>
+#include <gtest/gtest.h>
+#include <vector>
+
+using namespace fluids::sim;
+using fluids::utest::latticeFile;
+
+namespace {
+  // Compara densidades y aceleraciones tras un paso con la version escalar del mismo tipo.
+  // tolerance es el error relativo admitido en la densidad; en la aceleracion se admiten
+  // 1000 veces mas porque cada pareja suma terminos de signo opuesto.
+  template <std::floating_point T>
+  void expectSameAsScalar(KernelType kernel, T tolerance, bool pair_cache = false) {
+    if (selectKernel(kernel) != kernel) { GTEST_SKIP() << "CPU sin " << kernelName(kernel); }
+    // NOLINTNEXTLINE(cppcoreguidelines-avoid-magic-numbers,readability-magic-numbers,-warnings-as-errors)
+    File<T> file = latticeFile<T>(10, 3e-3, Vector3D<double>(-0.01, -0.07, -0.01));
+    Grid<T> scalar(file, SimulationOptions{.kernel = KernelType::scalar});
+    Grid<T> simd(file, SimulationOptions{.kernel = kernel, .pair_cache = pair_cache});
+    scalar.sortParticles();
+    simd.sortParticles();
+    for (size_t block = 0; block < scalar.blocks.size(); block++) {
+      scalar.evalDensities(block);
+      simd.evalDensities(block);
+    }
+    for (size_t i = 0; i < file.particles.size(); i++) {
+      ASSERT_NEAR(simd.file.particles.density[i], scalar.file.particles.density[i],
+                  tolerance * scalar.file.particles.density[i]);
+    }
+    for (Block & block : scalar.blocks) { scalar.transformDensities(block); }
+    simd.file.particles.density = scalar.file.particles.density;
+    for (size_t block = 0; block < scalar.blocks.size(); block++) {
+      scalar.evalAccelerations(block);
+      simd.evalAccelerations(block);
+    }
+    for (size_t i = 0; i < file.particles.size(); i++) {
+      Vector3D<T> const difference =
+          simd.file.particles.acceleration[i] - scalar.file.particles.acceleration[i];
+      // NOLINTNEXTLINE(cppcoreguidelines-avoid-magic-numbers,readability-magic-numbers,-warnings-as-errors)
+      T const limit = 1000 * tolerance * (1 + scalar.file.particles.acceleration[i].norm());
+      ASSERT_LT(difference.norm(), limit);
+    }
+  }
+}  // namespace
+
+TEST(KernelsTest, SelectScalar) {
+  ASSERT_EQ(selectKernel(KernelType::scalar), KernelType::scalar);
+  ASSERT_NE(selectKernel(KernelType::automatic), KernelType::automatic);
+}
+
+TEST(KernelsTest, Avx2MatchesScalar) {
+  // NOLINTNEXTLINE(cppcoreguidelines-avoid-magic-numbers,readability-magic-numbers,-warnings-as-errors)
+  expectSameAsScalar(KernelType::avx2, 1e-12);
+}
+
+TEST(KernelsTest, Avx512MatchesScalar) {
+  // NOLINTNEXTLINE(cppcoreguidelines-avoid-magic-numbers,readability-magic-numbers,-warnings-as-errors)
+  expectSameAsScalar(KernelType::avx512, 1e-12);
+}
+
+TEST(KernelsTest, Avx2CachedMatchesScalar) {
+  // NOLINTNEXTLINE(cppcoreguidelines-avoid-magic-numbers,readability-magic-numbers,-warnings-as-errors)
+  expectSameAsScalar(KernelType::avx2, 1e-12, true);
+}
+
+TEST(KernelsTest, Avx512CachedMatchesScalar) {
+  // NOLINTNEXTLINE(cppcoreguidelines-avoid-magic-numbers,readability-magic-numbers,-warnings-as-errors)
+  expectSameAsScalar(KernelType::avx512, 1e-12, true);
+}
+
+TEST(KernelsTest, Avx2FloatMatchesScalar) {
+  // NOLINTNEXTLINE(cppcoreguidelines-avoid-magic-numbers,readability-magic-numbers,-warnings-as-errors)
+  expectSameAsScalar(KernelType::avx2, 1e-5F);
+}
+
+TEST(KernelsTest, Avx512FloatMatchesScalar) {
+  // NOLINTNEXTLINE(cppcoreguidelines-avoid-magic-numbers,readability-magic-numbers,-warnings-as-errors)
+  expectSameAsScalar(KernelType::avx512, 1e-5F);
+}
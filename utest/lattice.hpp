@@ -0,0 +1,34 @@
+#ifndef LATTICE_HPP
+#define LATTICE_HPP
+
+#include "sim/grid.hpp"
+
+#include <concepts>
+
+namespace fluids::utest {
+  // side x side x side particulas separadas spacing a partir de corner, a 204 particulas por
+  // metro como en inputs/. La particula i tiene velocidad y hv (i % 3, i % 5, i % 7) * speed,
+  // distintas entre vecinas. Las posiciones se calculan en double y se redondean a T.
+  template <std::floating_point T = double>
+  sim::File<T> latticeFile(int side, double spacing,
+                           sim::Vector3D<double> const & corner = sim::Vector3D<double>(0, 0, 0),
+                           // NOLINTNEXTLINE(cppcoreguidelines-avoid-magic-numbers,readability-magic-numbers,-warnings-as-errors)
+                           double speed = 0.01) {
+    sim::File<T> file;
+    // NOLINTNEXTLINE(cppcoreguidelines-avoid-magic-numbers,readability-magic-numbers,-warnings-as-errors)
+    file.particles_per_meter = 204;
+    for (int i = 0; i < side * side * side; i++) {
+      sim::Particle<T> particle;
+      sim::Vector3D<double> const cell(i % side, (i / side) % side, i / (side * side));
+      particle.position = sim::Vector3D<T>(cell * spacing + corner);
+      // NOLINTNEXTLINE(cppcoreguidelines-avoid-magic-numbers,readability-magic-numbers,-warnings-as-errors)
+      sim::Vector3D<double> const velocity(i % 3, i % 5, i % 7);
+      particle.speed     = sim::Vector3D<T>(velocity * speed);
+      particle.hv_vector = particle.speed;
+      file.particles.push_back(particle);
+    }
+    return file;
+  }
+}  // namespace fluids::utest
+
+#endif  // LATTICE_HPP
@@ -0,0 +1,37 @@
+#include "sim/particles.hpp"
+
+#include <gtest/gtest.h>
+
+using namespace fluids::sim;
+
+TEST(ParticlesTest, ResizeUsesDefaultParticle) {
+  Particles<double> particles;
+  particles.resize(3);
+  ASSERT_EQ(particles.size(), 3U);
+  Particle<double> const particle = particles.get(2);
+  Particle<double> const expected;
+  EXPECT_EQ(particle.position, expected.position);
+  EXPECT_EQ(particle.density, expected.density);
+  EXPECT_EQ(particle.acceleration, external_acceleration);
+}
+
+TEST(ParticlesTest, SetAndGetParticle) {
+  Particles<double> particles;
+  Particle<double> particle;
+  // NOLINTNEXTLINE(cppcoreguidelines-avoid-magic-numbers,readability-magic-numbers,-warnings-as-errors)
+  particle.position = Vector3D<double>(1, 2, 3);
+  // NOLINTNEXTLINE(cppcoreguidelines-avoid-magic-numbers,readability-magic-numbers,-warnings-as-errors)
+  particle.hv_vector = Vector3D<double>(4, 5, 6);
+  // NOLINTNEXTLINE(cppcoreguidelines-avoid-magic-numbers,readability-magic-numbers,-warnings-as-errors)
+  particle.speed = Vector3D<double>(7, 8, 9);
+  // NOLINTNEXTLINE(cppcoreguidelines-avoid-magic-numbers,readability-magic-numbers,-warnings-as-errors)
+  particle.density = 10;
+  particles.push_back(Particle<double>());
+  particles.push_back(particle);
+  ASSERT_EQ(particles.size(), 2U);
+  EXPECT_EQ(particles.position[1], particle.position);
+  EXPECT_EQ(particles.hv_vector.y[1], 5);
+  EXPECT_EQ(particles.speed.z[1], 9);
+  EXPECT_EQ(particles.get(1).density, 10);
+  EXPECT_EQ(particles.position[0], Vector3D<double>(0, 0, 0));
+}
@@ -0,0 +1,67 @@
+#include "sim/grid.hpp"
+#include "sim/profiler.hpp"
+#include "utest/lattice.hpp"
+
+#include <fstream>
+#include <gtest/gtest.h>
+#include <sstream>
+#include <string>
+#include <thread>
+
+using namespace std;
+using namespace fluids::sim;
+using fluids::utest::latticeFile;
+
+TEST(ProfilerTest, SummaryStatistics) {
+  Profiler profiler;
+  // NOLINTNEXTLINE(cppcoreguidelines-avoid-magic-numbers,readability-magic-numbers,-warnings-as-errors)
+  for (int step = 0; step < 3; step++) {
+    profiler.beginStep();
+    profiler.time(Phase::collisions, [] { this_thread::sleep_for(chrono::milliseconds(2)); });
+    // NOLINTNEXTLINE(cppcoreguidelines-avoid-magic-numbers,readability-magic-numbers,-warnings-as-errors)
+    profiler.addPairs(10, 4);
+    // NOLINTNEXTLINE(cppcoreguidelines-avoid-magic-numbers,readability-magic-numbers,-warnings-as-errors)
+    profiler.addBlocks(25, 100);
+    profiler.endStep();
+  }
+  ASSERT_EQ(profiler.steps(), 3U);
+  ASSERT_GE(profiler.phaseTime(0, Phase::collisions), 2.0);
+  ASSERT_EQ(profiler.phaseTime(2, Phase::eval_densities), 0.0);
+
+  ostringstream summary;
+  profiler.printSummary(summary);
+  ASSERT_NE(summary.str().find("Profile (3 steps, ms per step)"), string::npos);
+  ASSERT_NE(summary.str().find("collisions"), string::npos);
+  ASSERT_NE(summary.str().find("Pair tests per step: 10, inside smoothing radius: 4 (40.0 %)"),
+            string::npos);
+  ASSERT_NE(summary.str().find("Active blocks per step: 25 of 100 (25.0 %)"), string::npos);
+}
+
+// Con --profile cada fase recorre todos los bloques por separado, con el mismo resultado
+TEST(ProfilerTest, ProfiledSimulationIsIdentical) {
+  // NOLINTNEXTLINE(cppcoreguidelines-avoid-magic-numbers,readability-magic-numbers,-warnings-as-errors)
+  File<double> file = latticeFile(5, 2e-3);
+  Grid<double> plain(file);
+  Grid<double> profiled(file, SimulationOptions{.profile = true});
+  ASSERT_EQ(plain.profiler, nullptr);
+  // NOLINTNEXTLINE(cppcoreguidelines-avoid-magic-numbers,readability-magic-numbers,-warnings-as-errors)
+  for (int step = 0; step < 3; step++) {
+    plain.makeSimulation();
+    profiled.makeSimulation();
+  }
+  for (size_t i = 0; i < plain.file.particles.size(); i++) {
+    ASSERT_EQ(plain.file.particles.position[i], profiled.file.particles.position[i]);
+    ASSERT_EQ(plain.file.particles.speed[i], profiled.file.particles.speed[i]);
+    ASSERT_EQ(plain.file.particles.density[i], profiled.file.particles.density[i]);
+  }
+  ASSERT_EQ(profiled.profiler->steps(), 3U);
+
+  ASSERT_TRUE(profiled.profiler->writeTrace("trace.json"));
+  ifstream trace("trace.json");
+  string const json((istreambuf_iterator<char>(trace)), istreambuf_iterator<char>());
+  trace.close();
+  ASSERT_EQ(json.rfind("{\"displayTimeUnit\": \"ms\", \"traceEvents\": [", 0), 0U);
+  ASSERT_NE(json.find(R"("name": "evalAccelerations")"), string::npos);
+  ASSERT_NE(json.find(R"("name": "step 3")"), string::npos);
+  if (remove("trace.json") != 0) { perror("Error deleting file"); }
+}
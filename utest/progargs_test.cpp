@@ -36,6 +36,226 @@ TEST_F(ProgramArgumentsTest, ParseArgumentsTest) {
   ASSERT_EQ(config.outputFile, "output.txt");
 }
 
+TEST_F(ProgramArgumentsTest, ParseThreadsTest) {
+  int const argc            = 6;
+  vector<string> const argv = {"./fluid", "10", "--threads", "8", "input.txt", "output.txt"};
+  ProgramArguments args(argc, argv);
+
+  Configuration const config = args.parseArguments();
+
+  ASSERT_EQ(config.nts, 10);
+  ASSERT_EQ(config.inputFile, "input.txt");
+  ASSERT_EQ(config.outputFile, "output.txt");
+  ASSERT_EQ(config.options.threads, 8U);
+}
+
+TEST_F(ProgramArgumentsTest, CheckThreadsTest) {
+  ASSERT_EQ(CheckThreads("4"), 0);
+  ASSERT_EQ(CheckThreads("0"), -6);
+  ASSERT_EQ(CheckThreads("many"), -6);
+  ASSERT_EQ(CheckThreads("1024"), 0);
+  ASSERT_EQ(CheckThreads("100000"), -6);
+  ASSERT_EQ(CheckThreads("99999999999"), -6);
+
+  vector<string> const invalidArgs = {"./fluid", "10", "input.txt", "output.txt", "--threads"};
+  ProgramArguments invalidArgsObj(5, invalidArgs);
+  ASSERT_DEATH(invalidArgsObj.correctArguments(), "Error: Missing value for option --threads.\n");
+}
+
+TEST_F(ProgramArgumentsTest, CheckKernelTest) {
+  ASSERT_EQ(CheckKernel("auto"), 0);
+  ASSERT_EQ(CheckKernel("avx2"), 0);
+  ASSERT_EQ(CheckKernel("sse"), -6);
+  ASSERT_EQ(ParseKernel("scalar"), KernelType::scalar);
+  ASSERT_EQ(ParseKernel("avx512"), KernelType::avx512);
+  ASSERT_EQ(ParseKernel("auto"), KernelType::automatic);
+}
+
+TEST_F(ProgramArgumentsTest, BlockOrderTest) {
+  ASSERT_EQ(CheckBlockOrder("linear"), 0);
+  ASSERT_EQ(CheckBlockOrder("hilbert"), 0);
+  ASSERT_EQ(CheckBlockOrder("peano"), -6);
+  ASSERT_EQ(ParseBlockOrder("morton"), BlockOrder::morton);
+  ASSERT_EQ(ParseBlockOrder("hilbert"), BlockOrder::hilbert);
+
+  int const argc            = 6;
+  vector<string> const argv = {"./fluid", "10", "input.txt", "output.txt", "--block-order",
+                               "morton"};
+  ProgramArguments args(argc, argv);
+  ASSERT_EQ(args.parseArguments().options.block_order, BlockOrder::morton);
+}
+
+TEST_F(ProgramArgumentsTest, CheckWriteModeTest) {
+  ASSERT_EQ(CheckWriteMode("buffered"), 0);
+  ASSERT_EQ(CheckWriteMode("direct"), 0);
+  ASSERT_EQ(CheckWriteMode("mmap"), -6);
+  ASSERT_EQ(ParseWriteMode("direct"), WriteMode::direct);
+  ASSERT_EQ(ParseWriteMode("buffered"), WriteMode::buffered);
+
+  int const argc            = 6;
+  vector<string> const argv = {"./fluid", "10", "input.txt", "output.txt", "--write", "direct"};
+  ProgramArguments args(argc, argv);
+  ASSERT_EQ(args.parseArguments().options.write, WriteMode::direct);
+}
+
+TEST_F(ProgramArgumentsTest, SnapshotTest) {
+  ASSERT_EQ(CheckSnapshotEvery("10"), 0);
+  ASSERT_EQ(CheckSnapshotEvery("0"), -6);
+  ASSERT_EQ(CheckSnapshotEvery("often"), -6);
+  ASSERT_EQ(CheckSnapshotEvery("99999999999"), -6);
+  // NOLINTNEXTLINE(cppcoreguidelines-avoid-magic-numbers,readability-magic-numbers,-warnings-as-errors)
+  ASSERT_EQ(ParseStepInterval("2147483647"), 2147483647U);
+
+  int const argc            = 6;
+  vector<string> const argv = {"./fluid", "10", "--snapshot-every", "5", "input.txt", "output.txt"};
+  ProgramArguments args(argc, argv);
+  Configuration const config = args.parseArguments();
+  ASSERT_EQ(config.snapshotEvery, 5U);
+  ASSERT_EQ(config.snapshotFile, "output.txt.trj");
+
+  vector<string> const named = {"./fluid",         "10", "input.txt", "output.txt",
+                                "--snapshot-file", "run.trj"};
+  ProgramArguments namedArgs(argc, named);
+  ASSERT_EQ(namedArgs.parseArguments().snapshotEvery, 0U);
+  ASSERT_EQ(namedArgs.parseArguments().snapshotFile, "run.trj");
+
+  // La trayectoria no sobrescribe ficheros existentes
+  vector<string> const existing = {"./fluid", "10", "input.txt", "output.txt", "--snapshot-every",
+                                   "5",       "--snapshot-file", "input.txt"};
+  ProgramArguments existingArgs(8, existing);
+  ASSERT_DEATH(existingArgs.correctArguments(), "Error: Cannot open input.txt for writing.\n");
+}
+
+TEST_F(ProgramArgumentsTest, CheckpointTest) {
+  ASSERT_EQ(CheckCheckpointEvery("100"), 0);
+  ASSERT_EQ(CheckCheckpointEvery("-1"), -6);
+  ASSERT_EQ(CheckCheckpointEvery("99999999999"), -6);
+  ASSERT_EQ(CheckCompression("none"), 0);
+  ASSERT_EQ(CheckCompression("lz4"), -6);
+  ASSERT_EQ(ParseCompression("none"), Compression::none);
+
+  int const argc            = 6;
+  vector<string> const argv = {"./fluid", "10", "--checkpoint-every", "4", "input.txt", "output.txt"};
+  ProgramArguments args(argc, argv);
+  Configuration const config = args.parseArguments();
+  ASSERT_EQ(config.checkpointEvery, 4U);
+  ASSERT_EQ(config.checkpointFile, "output.txt.chk");
+  ASSERT_EQ(config.checkpointCompression, Compression::none);
+}
+
+TEST_F(ProgramArgumentsTest, ProfileTest) {
+  ASSERT_EQ(CheckProfile("on"), 0);
+  ASSERT_EQ(CheckProfile("off"), 0);
+  ASSERT_EQ(CheckProfile("yes"), -6);
+
+  int const argc            = 6;
+  vector<string> const argv = {"./fluid", "10", "--profile", "on", "input.txt", "output.txt"};
+  ProgramArguments args(argc, argv);
+  ASSERT_TRUE(args.parseArguments().options.profile);
+  ASSERT_TRUE(args.parseArguments().profileTrace.empty());
+
+  vector<string> const trace = {"./fluid", "10", "input.txt", "output.txt", "--profile-trace",
+                                "trace.json"};
+  ProgramArguments traceArgs(argc, trace);
+  ASSERT_TRUE(traceArgs.parseArguments().options.profile);
+  ASSERT_EQ(traceArgs.parseArguments().profileTrace, "trace.json");
+}
+
+TEST_F(ProgramArgumentsTest, FuseTest) {
+  ASSERT_EQ(CheckFuse("on"), 0);
+  ASSERT_EQ(CheckFuse("off"), 0);
+  ASSERT_EQ(CheckFuse("1"), -6);
+
+  int const argc            = 6;
+  vector<string> const argv = {"./fluid", "10", "input.txt", "output.txt", "--fuse", "off"};
+  ProgramArguments args(argc, argv);
+  ASSERT_FALSE(args.parseArguments().options.fused);
+  vector<string> const defaults = {"./fluid", "10", "input.txt", "output.txt"};
+  ProgramArguments defaultArgs(static_cast<int>(defaults.size()), defaults);
+  ASSERT_TRUE(defaultArgs.parseArguments().options.fused);
+}
+
+TEST_F(ProgramArgumentsTest, PairCacheTest) {
+  ASSERT_EQ(CheckPairCache("on"), 0);
+  ASSERT_EQ(CheckPairCache("off"), 0);
+  ASSERT_EQ(CheckPairCache("yes"), -6);
+
+  int const argc            = 6;
+  vector<string> const argv = {"./fluid", "10", "input.txt", "output.txt", "--pair-cache", "on"};
+  ProgramArguments args(argc, argv);
+  ASSERT_TRUE(args.parseArguments().options.pair_cache);
+}
+
+TEST_F(ProgramArgumentsTest, VerletSkinTest) {
+  ASSERT_EQ(CheckVerletSkin("0"), 0);
+  ASSERT_EQ(CheckVerletSkin("0.3"), 0);
+  ASSERT_EQ(CheckVerletSkin("1.5"), -6);
+  ASSERT_EQ(CheckVerletSkin("-0.1"), -6);
+  ASSERT_EQ(CheckVerletSkin("skin"), -6);
+  ASSERT_EQ(CheckVerletSkin("nan"), -6);
+  ASSERT_EQ(CheckVerletSkin("1e999"), -6);
+
+  int const argc            = 6;
+  vector<string> const argv = {"./fluid", "10", "input.txt", "output.txt", "--verlet-skin", "0.3"};
+  ProgramArguments args(argc, argv);
+  // NOLINTNEXTLINE(cppcoreguidelines-avoid-magic-numbers,readability-magic-numbers,-warnings-as-errors)
+  ASSERT_DOUBLE_EQ(args.parseArguments().options.verlet_skin, 0.3);
+}
+
+TEST_F(ProgramArgumentsTest, ScenarioTest) {
+  ofstream scenario("scenario.scn");
+  scenario << "viscosity = 0.8\n";
+  scenario.close();
+  ASSERT_EQ(CheckScenario("scenario.scn"), 0);
+  ASSERT_EQ(CheckScenario("missing.scn"), -3);
+
+  int const argc            = 6;
+  vector<string> const argv = {"./fluid", "10", "input.txt", "output.txt", "--scenario",
+                               "scenario.scn"};
+  ProgramArguments args(argc, argv);
+  Configuration const config = args.parseArguments();
+  // NOLINTNEXTLINE(cppcoreguidelines-avoid-magic-numbers,readability-magic-numbers,-warnings-as-errors)
+  ASSERT_EQ(config.scenario.viscosity, 0.8);
+  ASSERT_EQ(config.scenario.fluid_density, fluid_density);
+
+  ofstream invalid("scenario.scn");
+  invalid << "viscosity = -1\n";
+  invalid.close();
+  ASSERT_DEATH(args.correctArguments(), "Error: scenario.scn: viscosity must be non-negative.\n");
+  if (remove("scenario.scn") != 0) { perror("Error deleting file"); }
+}
+
+TEST_F(ProgramArgumentsTest, TimeStepTest) {
+  ASSERT_EQ(CheckTargetTime("0.5"), 0);
+  ASSERT_EQ(CheckTargetTime("0"), -6);
+  ASSERT_EQ(CheckTargetTime("-1e-3"), -6);
+  ASSERT_EQ(CheckTargetTime("soon"), -6);
+  ASSERT_EQ(CheckTargetTime("1e999"), -6);
+  ASSERT_EQ(CheckAdaptive("0.1"), 0);
+  ASSERT_EQ(CheckAdaptive("1"), 0);
+  ASSERT_EQ(CheckAdaptive("0"), -6);
+  ASSERT_EQ(CheckAdaptive("1.5"), -6);
+  ASSERT_EQ(CheckAdaptive("cfl"), -6);
+  ASSERT_EQ(CheckAdaptive("1e999"), -6);
+
+  // --adaptive tiene prioridad sobre el courant del escenario aunque vaya antes
+  ofstream scenario("scenario.scn");
+  scenario << "courant = 0.4\n";
+  scenario.close();
+  vector<string> const adaptive = {"./fluid", "10",     "input.txt", "output.txt", "--adaptive",
+                                   "0.2",     "--time", "0.05",      "--scenario", "scenario.scn"};
+  Configuration const config = ProgramArguments(10, adaptive).parseArguments();
+  // NOLINTNEXTLINE(cppcoreguidelines-avoid-magic-numbers,readability-magic-numbers,-warnings-as-errors)
+  ASSERT_EQ(config.scenario.courant, 0.2);
+  // NOLINTNEXTLINE(cppcoreguidelines-avoid-magic-numbers,readability-magic-numbers,-warnings-as-errors)
+  ASSERT_EQ(config.targetTime, 0.05);
+  vector<string> const from_scenario = {"./fluid", "10", "input.txt", "output.txt", "--scenario",
+                                        "scenario.scn"};
+  // NOLINTNEXTLINE(cppcoreguidelines-avoid-magic-numbers,readability-magic-numbers,-warnings-as-errors)
+  ASSERT_EQ(ProgramArguments(6, from_scenario).parseArguments().scenario.courant, 0.4);
+  if (remove("scenario.scn") != 0) { perror("Error deleting file"); }
+}
+
 TEST_F(ProgramArgumentsTest, CheckNStepsTest) {
   string const validNts           = "10";
   string const invalidNts         = "abc";
@@ -44,6 +264,12 @@ TEST_F(ProgramArgumentsTest, CheckNStepsTest) {
   ASSERT_EQ(CheckNSteps(validNts), 0);
   ASSERT_EQ(CheckNSteps(invalidNts), -1);
   ASSERT_EQ(CheckNSteps(invalidNegativeNts), -2);
+  ASSERT_EQ(CheckNSteps("99999999999999999999"), -2);
+
+  // Con --time, nts es el maximo de pasos y puede pasar de 65535
+  vector<string> const many = {"./fluid", "70000", "input.txt", "output.txt", "--time", "2"};
+  // NOLINTNEXTLINE(cppcoreguidelines-avoid-magic-numbers,readability-magic-numbers,-warnings-as-errors)
+  ASSERT_EQ(ProgramArguments(6, many).parseArguments().nts, 70000);
 }
 
 TEST_F(ProgramArgumentsTest, ArgumentsTest) {
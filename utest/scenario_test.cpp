@@ -0,0 +1,102 @@
+#include "sim/grid.hpp"
+#include "sim/scenario.hpp"
+
+#include <gtest/gtest.h>
+#include <sstream>
+#include <string>
+
+using namespace std;
+using namespace fluids::sim;
+
+namespace {
+  int parse(string const & text, Scenario & scenario) {
+    istringstream input(text);
+    return parseScenario(input, "test.scn", scenario);
+  }
+
+  File<double> single_particle_file() {
+    File<double> file;
+    // NOLINTNEXTLINE(cppcoreguidelines-avoid-magic-numbers,readability-magic-numbers,-warnings-as-errors)
+    file.particles_per_meter = 204;
+    file.particles.push_back(Particle<double>());
+    return file;
+  }
+}  // namespace
+
+// Sin fichero, los parametros son las constantes de utils.hpp
+TEST(ScenarioTest, DefaultsAreTheConstants) {
+  Scenario scenario;
+  ASSERT_EQ(parse("# Solo un comentario\n\n", scenario), 0);
+  EXPECT_EQ(scenario.fluid_density, fluid_density);
+  EXPECT_EQ(scenario.viscosity, viscosity);
+  EXPECT_EQ(scenario.time_increase, time_increase);
+  EXPECT_EQ(scenario.courant, 0);
+  EXPECT_EQ(scenario.external_acceleration, external_acceleration);
+  EXPECT_EQ(scenario.bmin, bmin);
+  EXPECT_EQ(scenario.bmax, bmax);
+}
+
+TEST(ScenarioTest, ParsesScalarsAndVectors) {
+  Scenario scenario;
+  ASSERT_EQ(parse("viscosity = 0.8  # el doble\n"
+                  "  time_increase=5e-4\n"
+                  "bmax = 0.13 0.1 0.065\n"
+                  "external_acceleration = 0 0 -9.8\n",
+                  scenario),
+            0);
+  // NOLINTNEXTLINE(cppcoreguidelines-avoid-magic-numbers,readability-magic-numbers,-warnings-as-errors)
+  EXPECT_EQ(scenario.viscosity, 0.8);
+  // NOLINTNEXTLINE(cppcoreguidelines-avoid-magic-numbers,readability-magic-numbers,-warnings-as-errors)
+  EXPECT_EQ(scenario.time_increase, 5e-4);
+  // NOLINTNEXTLINE(cppcoreguidelines-avoid-magic-numbers,readability-magic-numbers,-warnings-as-errors)
+  EXPECT_EQ(scenario.bmax, Vector3D<double>(0.13, 0.1, 0.065));
+  // NOLINTNEXTLINE(cppcoreguidelines-avoid-magic-numbers,readability-magic-numbers,-warnings-as-errors)
+  EXPECT_EQ(scenario.external_acceleration, Vector3D<double>(0, 0, -9.8));
+  EXPECT_EQ(scenario.fluid_density, fluid_density);
+}
+
+TEST(ScenarioTest, RejectsInvalidLines) {
+  Scenario scenario;
+  EXPECT_EQ(parse("density = 1000\n", scenario), ERROR_INVALID_SCENARIO);
+  EXPECT_EQ(parse("viscosity\n", scenario), ERROR_INVALID_SCENARIO);
+  EXPECT_EQ(parse("viscosity = high\n", scenario), ERROR_INVALID_SCENARIO);
+  EXPECT_EQ(parse("viscosity = 0.4 0.5\n", scenario), ERROR_INVALID_SCENARIO);
+  EXPECT_EQ(parse("viscosity = nan\n", scenario), ERROR_INVALID_SCENARIO);
+  EXPECT_EQ(parse("bmin = -0.1 -0.1\n", scenario), ERROR_INVALID_SCENARIO);
+  EXPECT_EQ(readScenario("missing.scn", scenario), ERROR_CANNOT_OPEN_INPUT_FILE);
+}
+
+TEST(ScenarioTest, RejectsUnphysicalValues) {
+  Scenario scenario;
+  EXPECT_EQ(parse("time_increase = 0\n", scenario), ERROR_INVALID_SCENARIO);
+  scenario = Scenario();
+  EXPECT_EQ(parse("viscosity = -0.4\n", scenario), ERROR_INVALID_SCENARIO);
+  scenario = Scenario();
+  EXPECT_EQ(parse("bmax = 0.065 -0.08 0.065\n", scenario), ERROR_INVALID_SCENARIO);
+  scenario = Scenario();
+  EXPECT_EQ(parse("courant = 1.5\n", scenario), ERROR_INVALID_SCENARIO);
+}
+
+// Grid toma el recinto y las constantes derivadas del escenario
+TEST(ScenarioTest, GridUsesScenario) {
+  File<double> file = single_particle_file();
+  Grid<double> const reference(file);
+  Scenario scenario;
+  ASSERT_EQ(parse("bmin = -0.13 -0.08 -0.065\n"
+                  "bmax = 0.13 0.1 0.065\n"
+                  "viscosity = 0.8\n"
+                  "time_increase = 5e-4\n",
+                  scenario),
+            0);
+  Grid<double> const grid(file, {}, scenario);
+
+  EXPECT_GT(grid.n_blocks_x, reference.n_blocks_x);
+  // NOLINTNEXTLINE(cppcoreguidelines-avoid-magic-numbers,readability-magic-numbers,-warnings-as-errors)
+  EXPECT_NEAR(grid.block_size.x * grid.n_blocks_x, 0.26, 1e-12);
+  EXPECT_EQ(grid.n_blocks_y, reference.n_blocks_y);
+  EXPECT_EQ(grid.physics.bmin, scenario.bmin);
+  EXPECT_EQ(grid.physics.time_increase, scenario.time_increase);
+  EXPECT_EQ(grid.viscosity_45, 2 * reference.viscosity_45);
+  EXPECT_EQ(grid.time_squared, reference.time_squared / 4);
+  EXPECT_EQ(grid.mass, reference.mass);
+}
@@ -0,0 +1,172 @@
+#include "sim/fluids.h"
+#include "sim/simulation.hpp"
+#include "utest/lattice.hpp"
+
+#include <fstream>
+#include <gtest/gtest.h>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
+
+using namespace std;
+using namespace fluids::sim;
+using fluids::utest::latticeFile;
+
+namespace {
+  // 4 x 4 x 4 particulas con x, y, z seguidos por particula, como en los .fld
+  struct Arrays {
+      vector<double> position, hv_vector, speed;
+  };
+
+  File<double> sample_file() {
+    // NOLINTNEXTLINE(cppcoreguidelines-avoid-magic-numbers,readability-magic-numbers,-warnings-as-errors)
+    return latticeFile(4, 5e-3, Vector3D<double>(-0.01, -0.06, -0.01), 0.1);
+  }
+
+  Arrays sample_arrays() {
+    Particles<double> const particles = sample_file().particles;
+    Arrays arrays;
+    for (size_t i = 0; i < particles.size(); i++) {
+      Vector3D<double> const position = particles.position[i];
+      Vector3D<double> const hv       = particles.hv_vector[i];
+      Vector3D<double> const speed    = particles.speed[i];
+      arrays.position.insert(arrays.position.end(), {position.x, position.y, position.z});
+      arrays.hv_vector.insert(arrays.hv_vector.end(), {hv.x, hv.y, hv.z});
+      arrays.speed.insert(arrays.speed.end(), {speed.x, speed.y, speed.z});
+    }
+    return arrays;
+  }
+}  // namespace
+
+// Con un File movido la simulacion usa sus arrays y las vistas apuntan a ellos
+TEST(SimulationTest, MovesFile) {
+  File<double> file          = sample_file();
+  double const * const x     = file.particles.position.x.data();
+  double const * const speed = file.particles.speed.z.data();
+  Simulation<double> simulation(std::move(file), {.verbose = false});
+  EXPECT_EQ(simulation.positions().x.data(), x);
+  EXPECT_EQ(simulation.velocities().z.data(), speed);
+  EXPECT_EQ(simulation.size(), 64U);
+}
+
+// Desde arrays o desde un File, el mismo resultado que Grid
+TEST(SimulationTest, MatchesGrid) {
+  Arrays const arrays = sample_arrays();
+  File<double> file   = sample_file();
+  Grid<double> grid(file, {.verbose = false});
+  // NOLINTNEXTLINE(cppcoreguidelines-avoid-magic-numbers,readability-magic-numbers,-warnings-as-errors)
+  Simulation<double> simulation(204, arrays.position, arrays.hv_vector, arrays.speed,
+                                {.verbose = false});
+  // NOLINTNEXTLINE(cppcoreguidelines-avoid-magic-numbers,readability-magic-numbers,-warnings-as-errors)
+  for (int step = 0; step < 5; step++) { grid.makeSimulation(); }
+  // NOLINTNEXTLINE(cppcoreguidelines-avoid-magic-numbers,readability-magic-numbers,-warnings-as-errors)
+  simulation.step(5);
+  EXPECT_EQ(simulation.time(), grid.time);
+  ParticleSpans<double> const positions  = simulation.positions();
+  ParticleSpans<double> const velocities = simulation.velocities();
+  span<size_t const> const ids           = simulation.ids();
+  vector<size_t> const slots             = grid.file.particles.slots();
+  ASSERT_EQ(ids.size(), file.particles.size());
+  for (size_t i = 0; i < ids.size(); i++) {
+    size_t const j = slots[ids[i]];
+    EXPECT_EQ(Vector3D<double>(positions.x[i], positions.y[i], positions.z[i]),
+              grid.file.particles.position[j]);
+    EXPECT_EQ(Vector3D<double>(velocities.x[i], velocities.y[i], velocities.z[i]),
+              grid.file.particles.speed[j]);
+  }
+}
+
+// Los errores de la entrada se lanzan como excepciones y no terminan el programa
+TEST(SimulationTest, InvalidArrays) {
+  vector<double> const values = {0, 0, 0, 0};
+  // NOLINTNEXTLINE(cppcoreguidelines-avoid-magic-numbers,readability-magic-numbers,-warnings-as-errors)
+  EXPECT_THROW(Simulation<double>(204, values, values, values), invalid_argument);
+  Arrays const arrays = sample_arrays();
+  Scenario scenario;
+  // NOLINTNEXTLINE(cppcoreguidelines-avoid-magic-numbers,readability-magic-numbers,-warnings-as-errors)
+  scenario.bmax.x = scenario.bmin.x + 0.001;
+  // NOLINTNEXTLINE(cppcoreguidelines-avoid-magic-numbers,readability-magic-numbers,-warnings-as-errors)
+  EXPECT_THROW(
+      Simulation<double>(204, arrays.position, arrays.hv_vector, arrays.speed, {}, scenario),
+      invalid_argument);
+  EXPECT_THROW(Simulation<double>(sample_file(), {}, scenario), invalid_argument);
+}
+
+TEST(SimulationTest, WriteCannotOpen) {
+  Simulation<double> simulation(sample_file(), {.verbose = false});
+  EXPECT_FALSE(simulation.write("/nonexistent/output.fld"));
+}
+
+// La interfaz C da las mismas vistas que Simulation
+TEST(SimulationTest, CInterface) {
+  Arrays const arrays = sample_arrays();
+  // NOLINTNEXTLINE(cppcoreguidelines-avoid-magic-numbers,readability-magic-numbers,-warnings-as-errors)
+  fluids_simulation * const c_simulation = fluids_create(204, 64, arrays.position.data(),
+                                                         arrays.hv_vector.data(),
+                                                         arrays.speed.data(), 1, nullptr);
+  ASSERT_NE(c_simulation, nullptr);
+  // NOLINTNEXTLINE(cppcoreguidelines-avoid-magic-numbers,readability-magic-numbers,-warnings-as-errors)
+  Simulation<double> simulation(204, arrays.position, arrays.hv_vector, arrays.speed,
+                                {.verbose = false});
+  // NOLINTNEXTLINE(cppcoreguidelines-avoid-magic-numbers,readability-magic-numbers,-warnings-as-errors)
+  fluids_step(c_simulation, 3);
+  // NOLINTNEXTLINE(cppcoreguidelines-avoid-magic-numbers,readability-magic-numbers,-warnings-as-errors)
+  simulation.step(3);
+  ASSERT_EQ(fluids_size(c_simulation), simulation.size());
+  EXPECT_EQ(fluids_time(c_simulation), simulation.time());
+  double const * x = nullptr;
+  double const * y = nullptr;
+  double const * z = nullptr;
+  fluids_positions(c_simulation, &x, &y, &z);
+  size_t const * const ids = fluids_ids(c_simulation);
+  for (size_t i = 0; i < simulation.size(); i++) {
+    EXPECT_EQ(ids[i], simulation.ids()[i]);
+    EXPECT_EQ(x[i], simulation.positions().x[i]);
+    EXPECT_EQ(y[i], simulation.positions().y[i]);
+    EXPECT_EQ(z[i], simulation.positions().z[i]);
+  }
+  fluids_velocities(c_simulation, &x, &y, &z);
+  for (size_t i = 0; i < simulation.size(); i++) {
+    EXPECT_EQ(z[i], simulation.velocities().z[i]);
+  }
+  EXPECT_EQ(fluids_write(c_simulation, "/nonexistent/output.fld"), -4);
+  EXPECT_EQ(string(fluids_last_error()), "Cannot open /nonexistent/output.fld for writing");
+  // NOLINTNEXTLINE(cppcoreguidelines-avoid-magic-numbers,readability-magic-numbers,-warnings-as-errors)
+  EXPECT_EQ(fluids_step(c_simulation, 1), 0);
+  EXPECT_EQ(string(fluids_last_error()), "");
+  fluids_destroy(c_simulation);
+}
+
+TEST(SimulationTest, CInterfaceInvalidArguments) {
+  Arrays const arrays = sample_arrays();
+  // NOLINTNEXTLINE(cppcoreguidelines-avoid-magic-numbers,readability-magic-numbers,-warnings-as-errors)
+  EXPECT_EQ(fluids_create(204, 0, arrays.position.data(), arrays.hv_vector.data(),
+                          arrays.speed.data(), 1, nullptr),
+            nullptr);
+  // NOLINTNEXTLINE(cppcoreguidelines-avoid-magic-numbers,readability-magic-numbers,-warnings-as-errors)
+  EXPECT_EQ(fluids_create(204, 64, nullptr, arrays.hv_vector.data(), arrays.speed.data(), 1,
+                          nullptr),
+            nullptr);
+  // NOLINTNEXTLINE(cppcoreguidelines-avoid-magic-numbers,readability-magic-numbers,-warnings-as-errors)
+  EXPECT_EQ(fluids_create(204, 64, arrays.position.data(), arrays.hv_vector.data(),
+                          arrays.speed.data(), 0, nullptr),
+            nullptr);
+  // NOLINTNEXTLINE(cppcoreguidelines-avoid-magic-numbers,readability-magic-numbers,-warnings-as-errors)
+  EXPECT_EQ(fluids_create(204, 64, arrays.position.data(), arrays.hv_vector.data(),
+                          arrays.speed.data(), 1, "missing.scn"),
+            nullptr);
+  EXPECT_EQ(string(fluids_last_error()), "Error: Cannot open missing.scn for reading.");
+
+  // Un recinto mas estrecho que la longitud de suavizado no llega a construir la rejilla
+  ofstream scenario("narrow.scn");
+  scenario << "bmax = -0.064 0.1 0.065\n";
+  scenario.close();
+  // NOLINTNEXTLINE(cppcoreguidelines-avoid-magic-numbers,readability-magic-numbers,-warnings-as-errors)
+  EXPECT_EQ(fluids_create(204, 64, arrays.position.data(), arrays.hv_vector.data(),
+                          arrays.speed.data(), 1, "narrow.scn"),
+            nullptr);
+  EXPECT_EQ(string(fluids_last_error()),
+            "The box must be at least one smoothing length wide on every axis");
+  if (remove("narrow.scn") != 0) { perror("Error deleting file"); }
+}
@@ -0,0 +1,26 @@
+#include "sim/thread_pool.hpp"
+
+#include <atomic>
+#include <gtest/gtest.h>
+#include <vector>
+
+using namespace fluids::sim;
+
+TEST(ThreadPoolTest, RunsEveryIndexOnce) {
+  ThreadPool pool(4);
+  // NOLINTNEXTLINE(cppcoreguidelines-avoid-magic-numbers,readability-magic-numbers,-warnings-as-errors)
+  std::vector<std::atomic<int>> hits(1000);
+  for (int repeat = 0; repeat < 3; repeat++) {
+    pool.parallelFor(hits.size(), [&](size_t i) { hits[i]++; });
+  }
+  for (std::atomic<int> const & hit : hits) { EXPECT_EQ(hit, 3); }
+}
+
+TEST(ThreadPoolTest, ZeroThreadsRunsInline) {
+  ThreadPool pool(0);
+  EXPECT_EQ(pool.size(), 1U);
+  size_t sum = 0;
+  // NOLINTNEXTLINE(cppcoreguidelines-avoid-magic-numbers,readability-magic-numbers,-warnings-as-errors)
+  pool.parallelFor(10, [&](size_t i) { sum += i; });
+  EXPECT_EQ(sum, 45U);
+}
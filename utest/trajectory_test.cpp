@@ -0,0 +1,68 @@
+#include "sim/grid.hpp"
+#include "sim/trajectory.hpp"
+#include "utest/lattice.hpp"
+
+#include <fstream>
+#include <gtest/gtest.h>
+#include <string>
+#include <vector>
+
+using namespace std;
+using namespace fluids::sim;
+using fluids::utest::latticeFile;
+
+// Cada fotograma de la trayectoria es igual al .fld que escribiria writeSimulation en ese paso
+TEST(TrajectoryTest, FramesMatchWriteSimulation) {
+  // NOLINTNEXTLINE(cppcoreguidelines-avoid-magic-numbers,readability-magic-numbers,-warnings-as-errors)
+  File<double> file = latticeFile(3, 4e-3);
+  Grid<double> grid(file);
+  vector<vector<char>> expected;
+  vector<char> frame;
+  {
+    TrajectoryWriter writer("frames.trj");
+    ASSERT_TRUE(writer.good());
+    // NOLINTNEXTLINE(cppcoreguidelines-avoid-magic-numbers,readability-magic-numbers,-warnings-as-errors)
+    for (int step = 1; step <= 6; step++) {
+      grid.makeSimulation();
+      if (step % 2 != 0) { continue; }
+      grid.packSimulation(frame);
+      expected.push_back(frame);
+      ASSERT_TRUE(writer.append(step, frame));
+    }
+    ASSERT_TRUE(writer.close());
+  }
+
+  Trajectory const trajectory("frames.trj");
+  ASSERT_TRUE(trajectory.good());
+  ASSERT_EQ(trajectory.size(), expected.size());
+  for (size_t i = 0; i < trajectory.size(); i++) {
+    ASSERT_EQ(trajectory.step(i), static_cast<int64_t>(2 * (i + 1)));
+    span<char const> const bytes = trajectory.frame(i);
+    ASSERT_EQ(vector<char>(bytes.begin(), bytes.end()), expected[i]);
+  }
+  File<double> const last = parseFile<double>(trajectory.frame(2), "frames.trj");
+  ASSERT_EQ(last.particles.size(), grid.file.particles.size());
+  if (remove("frames.trj") != 0) { perror("Error deleting file"); }
+}
+
+TEST(TrajectoryTest, EmptyTrajectory) {
+  {
+    TrajectoryWriter writer("empty.trj");
+    ASSERT_TRUE(writer.close());
+  }
+  Trajectory const trajectory("empty.trj");
+  ASSERT_TRUE(trajectory.good());
+  ASSERT_EQ(trajectory.size(), 0U);
+  if (remove("empty.trj") != 0) { perror("Error deleting file"); }
+}
+
+// Un .fld o una trayectoria sin indice no son trayectorias validas
+TEST(TrajectoryTest, InvalidFiles) {
+  ofstream output("invalid.trj", ios::binary);
+  output << "FLUIDTRJ";
+  output.close();
+  ASSERT_FALSE(Trajectory("invalid.trj").good());
+  ASSERT_FALSE(Trajectory("missing.trj").good());
+  ASSERT_FALSE(TrajectoryWriter("missing/output.trj").good());
+  if (remove("invalid.trj") != 0) { perror("Error deleting file"); }
+}
@@ -7,10 +7,10 @@ using namespace fluids::sim;
 
 TEST(Vector3DTest, Addition) {
   // NOLINTNEXTLINE(cppcoreguidelines-avoid-magic-numbers,readability-magic-numbers,-warnings-as-errors)
-  Vector3D const vector1(1, 2, 3);
+  Vector3D<double> const vector1(1, 2, 3);
   // NOLINTNEXTLINE(cppcoreguidelines-avoid-magic-numbers,readability-magic-numbers,-warnings-as-errors)
-  Vector3D const vector2(4, 5, 6);
-  Vector3D const result = vector1 + vector2;
+  Vector3D<double> const vector2(4, 5, 6);
+  Vector3D<double> const result = vector1 + vector2;
   EXPECT_EQ(result.x, 5);
   EXPECT_EQ(result.y, 7);
   EXPECT_EQ(result.z, 9);
@@ -18,10 +18,10 @@ TEST(Vector3DTest, Addition) {
 
 TEST(Vector3DTest, Subtraction) {
   // NOLINTNEXTLINE(cppcoreguidelines-avoid-magic-numbers,readability-magic-numbers,-warnings-as-errors)
-  Vector3D const vector1(1, 2, 3);
+  Vector3D<double> const vector1(1, 2, 3);
   // NOLINTNEXTLINE(cppcoreguidelines-avoid-magic-numbers,readability-magic-numbers,-warnings-as-errors)
-  Vector3D const vector2(4, 5, 6);
-  Vector3D const result = vector1 - vector2;
+  Vector3D<double> const vector2(4, 5, 6);
+  Vector3D<double> const result = vector1 - vector2;
   EXPECT_EQ(result.x, -3);
   EXPECT_EQ(result.y, -3);
   EXPECT_EQ(result.z, -3);
@@ -29,8 +29,8 @@ TEST(Vector3DTest, Subtraction) {
 
 TEST(Vector3DTest, ScalarMultiplication) {
   // NOLINTNEXTLINE(cppcoreguidelines-avoid-magic-numbers,readability-magic-numbers,-warnings-as-errors)
-  Vector3D const vector(1, 2, 3);
-  Vector3D const result = vector * 2;
+  Vector3D<double> const vector(1, 2, 3);
+  Vector3D<double> const result = vector * 2;
   EXPECT_EQ(result.x, 2);
   EXPECT_EQ(result.y, 4);
   EXPECT_EQ(result.z, 6);
@@ -38,8 +38,8 @@ TEST(Vector3DTest, ScalarMultiplication) {
 
 TEST(Vector3DTest, ScalarDivision) {
   // NOLINTNEXTLINE(cppcoreguidelines-avoid-magic-numbers,readability-magic-numbers,-warnings-as-errors)
-  Vector3D const vector(2, 4, 6);
-  Vector3D const result = vector / 2;
+  Vector3D<double> const vector(2, 4, 6);
+  Vector3D<double> const result = vector / 2;
   EXPECT_EQ(result.x, 1);
   EXPECT_EQ(result.y, 2);
   EXPECT_EQ(result.z, 3);
@@ -47,17 +47,17 @@ TEST(Vector3DTest, ScalarDivision) {
 
 TEST(Vector3DTest, DotProduct) {
   // NOLINTNEXTLINE(cppcoreguidelines-avoid-magic-numbers,readability-magic-numbers,-warnings-as-errors)
-  Vector3D const vector1(1, 2, 3);
+  Vector3D<double> const vector1(1, 2, 3);
   // NOLINTNEXTLINE(cppcoreguidelines-avoid-magic-numbers,readability-magic-numbers,-warnings-as-errors)
-  Vector3D const vector2(4, 5, 6);
+  Vector3D<double> const vector2(4, 5, 6);
   double const result = vector1.dot(vector2);
   EXPECT_EQ(result, 32);
 }
 
 TEST(Vector3DTest, Normalization) {
   // NOLINTNEXTLINE(cppcoreguidelines-avoid-magic-numbers,readability-magic-numbers,-warnings-as-errors)
-  Vector3D const vector(1, 2, 2);
-  Vector3D const result = vector.normalized();
+  Vector3D<double> const vector(1, 2, 2);
+  Vector3D<double> const result = vector.normalized();
   EXPECT_EQ(result.x, 1.0 / 3);
   EXPECT_EQ(result.y, 2.0 / 3);
   EXPECT_EQ(result.z, 2.0 / 3);
@@ -65,8 +65,8 @@ TEST(Vector3DTest, Normalization) {
 
 TEST(Vector3DTest, Assignment) {
   // NOLINTNEXTLINE(cppcoreguidelines-avoid-magic-numbers,readability-magic-numbers,-warnings-as-errors)
-  Vector3D const vector1(1, 2, 3);
-  Vector3D const vector2 = vector1;
+  Vector3D<double> const vector1(1, 2, 3);
+  Vector3D<double> const vector2 = vector1;
   EXPECT_EQ(vector2.x, 1);
   EXPECT_EQ(vector2.y, 2);
   EXPECT_EQ(vector2.z, 3);
@@ -74,8 +74,8 @@ TEST(Vector3DTest, Assignment) {
 
 TEST(Vector3DTest, UnaryMinus) {
   // NOLINTNEXTLINE(cppcoreguidelines-avoid-magic-numbers,readability-magic-numbers,-warnings-as-errors)
-  Vector3D const vector(1, 2, 3);
-  Vector3D const result = -vector;
+  Vector3D<double> const vector(1, 2, 3);
+  Vector3D<double> const result = -vector;
   EXPECT_EQ(result.x, -1);
   EXPECT_EQ(result.y, -2);
   EXPECT_EQ(result.z, -3);
@@ -83,9 +83,9 @@ TEST(Vector3DTest, UnaryMinus) {
 
 TEST(Vector3DTest, CompoundAddition) {
   // NOLINTNEXTLINE(cppcoreguidelines-avoid-magic-numbers,readability-magic-numbers,-warnings-as-errors)
-  Vector3D vector1(1, 2, 3);
+  Vector3D<double> vector1(1, 2, 3);
   // NOLINTNEXTLINE(cppcoreguidelines-avoid-magic-numbers,readability-magic-numbers,-warnings-as-errors)
-  Vector3D const vector2(4, 5, 6);
+  Vector3D<double> const vector2(4, 5, 6);
   vector1 += vector2;
   EXPECT_EQ(vector1.x, 5);
   EXPECT_EQ(vector1.y, 7);
@@ -94,9 +94,9 @@ TEST(Vector3DTest, CompoundAddition) {
 
 TEST(Vector3DTest, CompoundSubtraction) {
   // NOLINTNEXTLINE(cppcoreguidelines-avoid-magic-numbers,readability-magic-numbers,-warnings-as-errors)
-  Vector3D vector1(1, 2, 3);
+  Vector3D<double> vector1(1, 2, 3);
   // NOLINTNEXTLINE(cppcoreguidelines-avoid-magic-numbers,readability-magic-numbers,-warnings-as-errors)
-  Vector3D const vector2(4, 5, 6);
+  Vector3D<double> const vector2(4, 5, 6);
   vector1 -= vector2;
   EXPECT_EQ(vector1.x, -3);
   EXPECT_EQ(vector1.y, -3);
@@ -105,7 +105,7 @@ TEST(Vector3DTest, CompoundSubtraction) {
 
 TEST(Vector3DTest, CompoundMultiplication) {
   // NOLINTNEXTLINE(cppcoreguidelines-avoid-magic-numbers,readability-magic-numbers,-warnings-as-errors)
-  Vector3D vector(1, 2, 3);
+  Vector3D<double> vector(1, 2, 3);
   vector *= 2;
   EXPECT_EQ(vector.x, 2);
   EXPECT_EQ(vector.y, 4);
@@ -114,7 +114,7 @@ TEST(Vector3DTest, CompoundMultiplication) {
 
 TEST(Vector3DTest, CompoundDivision) {
   // NOLINTNEXTLINE(cppcoreguidelines-avoid-magic-numbers,readability-magic-numbers,-warnings-as-errors)
-  Vector3D vector(2, 4, 6);
+  Vector3D<double> vector(2, 4, 6);
   vector /= 2;
   EXPECT_EQ(vector.x, 1);
   EXPECT_EQ(vector.y, 2);
@@ -123,16 +123,29 @@ TEST(Vector3DTest, CompoundDivision) {
 
 TEST(Vector3DTest, Equality) {
   // NOLINTNEXTLINE(cppcoreguidelines-avoid-magic-numbers,readability-magic-numbers,-warnings-as-errors)
-  Vector3D const vector1(1, 2, 3);
+  Vector3D<double> const vector1(1, 2, 3);
   // NOLINTNEXTLINE(cppcoreguidelines-avoid-magic-numbers,readability-magic-numbers,-warnings-as-errors)
-  Vector3D const vector2(1, 2, 3);
+  Vector3D<double> const vector2(1, 2, 3);
   EXPECT_TRUE(vector1 == vector2);
 }
 
 TEST(Vector3DTest, Inequality) {
   // NOLINTNEXTLINE(cppcoreguidelines-avoid-magic-numbers,readability-magic-numbers,-warnings-as-errors)
-  Vector3D const vector1(1, 2, 3);
+  Vector3D<double> const vector1(1, 2, 3);
   // NOLINTNEXTLINE(cppcoreguidelines-avoid-magic-numbers,readability-magic-numbers,-warnings-as-errors)
-  Vector3D const vector2(4, 5, 6);
+  Vector3D<double> const vector2(4, 5, 6);
   EXPECT_TRUE(vector1 != vector2);
-}
\ No newline at end of file
+}
+
+TEST(Vector3DTest, SinglePrecisionConversion) {
+  // NOLINTNEXTLINE(cppcoreguidelines-avoid-magic-numbers,readability-magic-numbers,-warnings-as-errors)
+  Vector3D<double> const vector(0.1, -9.8, 1e-6);
+  Vector3D<float> const single(vector);
+  // NOLINTNEXTLINE(cppcoreguidelines-avoid-magic-numbers,readability-magic-numbers,-warnings-as-errors)
+  EXPECT_EQ(single.x, 0.1F);
+  // NOLINTNEXTLINE(cppcoreguidelines-avoid-magic-numbers,readability-magic-numbers,-warnings-as-errors)
+  EXPECT_EQ(single.y, -9.8F);
+  // NOLINTNEXTLINE(cppcoreguidelines-avoid-magic-numbers,readability-magic-numbers,-warnings-as-errors)
+  EXPECT_EQ(single.z, 1e-6F);
+  EXPECT_EQ(Vector3D<double>(single).x, static_cast<double>(0.1F));
+}
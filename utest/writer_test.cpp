@@ -0,0 +1,76 @@
+#include "sim/writer.hpp"
+
+#include <fstream>
+#include <gtest/gtest.h>
+#include <iterator>
+#include <string>
+#include <vector>
+
+using namespace std;
+using namespace fluids::sim;
+
+namespace {
+  string read_all(string const & filename) {
+    ifstream input(filename, ios::binary);
+    return {istreambuf_iterator<char>(input), istreambuf_iterator<char>()};
+  }
+
+  // Bytes distintos en cada posicion para detectar desplazamientos
+  vector<char> pattern(size_t size) {
+    vector<char> bytes(size);
+    // NOLINTNEXTLINE(cppcoreguidelines-avoid-magic-numbers,readability-magic-numbers,-warnings-as-errors)
+    for (size_t i = 0; i < size; i++) { bytes[i] = static_cast<char>((i * 31) % 251); }
+    return bytes;
+  }
+}  // namespace
+
+TEST(WriterTest, BufferedAndDirect) {
+  // Tamaño que no es multiplo del alineamiento de O_DIRECT
+  // NOLINTNEXTLINE(cppcoreguidelines-avoid-magic-numbers,readability-magic-numbers,-warnings-as-errors)
+  vector<char> const bytes = pattern(10000);
+  ASSERT_TRUE(writeBytes("buffered.bin", bytes, WriteMode::buffered));
+  ASSERT_TRUE(writeBytes("direct.bin", bytes, WriteMode::direct));
+  string const expected(bytes.begin(), bytes.end());
+  ASSERT_EQ(read_all("buffered.bin"), expected);
+  ASSERT_EQ(read_all("direct.bin"), expected);
+  if (remove("buffered.bin") != 0) { perror("Error deleting file"); }
+  if (remove("direct.bin") != 0) { perror("Error deleting file"); }
+}
+
+TEST(WriterTest, TruncatesExistingFile) {
+  // NOLINTNEXTLINE(cppcoreguidelines-avoid-magic-numbers,readability-magic-numbers,-warnings-as-errors)
+  ASSERT_TRUE(writeBytes("truncate.bin", pattern(5000), WriteMode::buffered));
+  // NOLINTNEXTLINE(cppcoreguidelines-avoid-magic-numbers,readability-magic-numbers,-warnings-as-errors)
+  vector<char> const bytes = pattern(100);
+  ASSERT_TRUE(writeBytes("truncate.bin", bytes, WriteMode::direct));
+  ASSERT_EQ(read_all("truncate.bin"), string(bytes.begin(), bytes.end()));
+  if (remove("truncate.bin") != 0) { perror("Error deleting file"); }
+}
+
+TEST(WriterTest, AsyncWriterSwapsBuffers) {
+  AsyncWriter writer;
+  // NOLINTNEXTLINE(cppcoreguidelines-avoid-magic-numbers,readability-magic-numbers,-warnings-as-errors)
+  vector<char> first = pattern(300);
+  string const expected_first(first.begin(), first.end());
+  writer.start("first.bin", first);
+  ASSERT_TRUE(first.empty());
+  // NOLINTNEXTLINE(cppcoreguidelines-avoid-magic-numbers,readability-magic-numbers,-warnings-as-errors)
+  vector<char> second = pattern(200);
+  string const expected_second(second.begin(), second.end());
+  writer.start("second.bin", second);
+  // start devuelve el buffer de la escritura anterior, ya terminada
+  ASSERT_EQ(string(second.begin(), second.end()), expected_first);
+  ASSERT_TRUE(writer.wait());
+  ASSERT_EQ(read_all("first.bin"), expected_first);
+  ASSERT_EQ(read_all("second.bin"), expected_second);
+  if (remove("first.bin") != 0) { perror("Error deleting file"); }
+  if (remove("second.bin") != 0) { perror("Error deleting file"); }
+}
+
+TEST(WriterTest, AsyncWriterReportsFailure) {
+  AsyncWriter writer;
+  vector<char> bytes = pattern(10);
+  writer.start("missing/output.bin", bytes);
+  ASSERT_FALSE(writer.wait());
+  ASSERT_EQ(writer.failedFile(), "missing/output.bin");
+}